@@ -0,0 +1,307 @@
+#include "aead.hpp"
+#include "bench_latency.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+// dudect style timing leakage test of GIFT-COFB decryption tail, where inputs
+// of two classes are timed in random interleaved order, and Welch's t-test
+// tells whether timing distributions of both classes differ; |t| > 4.5 means
+// timing very likely depends on class, see https://eprint.iacr.org/2016/1123
+//
+// Compile it with
+//
+// make bench/dudect.out
+//
+// Run it with ( all arguments are optional )
+//
+// ./bench/dudect.out --measurements=200000 --ad=16 --ct=64 --cpu=0
+
+// Reads value of command line option of form --name=value, if present
+static size_t
+option(const int argc, char** argv, const char* name, const size_t dflt)
+{
+  const size_t nlen = std::strlen(name);
+
+  for (int i = 1; i < argc; i++) {
+    if (std::strncmp(argv[i], name, nlen) == 0 && argv[i][nlen] == '=') {
+      return std::strtoull(argv[i] + nlen + 1, nullptr, 10);
+    }
+  }
+
+  return dflt;
+}
+
+// |t| above which timing is considered to depend on class
+constexpr double THRESHOLD = 4.5;
+
+// Number of cropping thresholds, as used by dudect
+constexpr size_t CROPS = 100;
+
+// Online mean and variance of one class of measurements ( Welford )
+struct moments_t
+{
+  double n = 0.0;
+  double mean = 0.0;
+  double m2 = 0.0;
+
+  inline void push(const double x)
+  {
+    n += 1.0;
+    const double d = x - mean;
+    mean += d / n;
+    m2 += d * (x - mean);
+  }
+};
+
+// Welch's t statistic of two classes of measurements
+static double
+welch_t(const moments_t& a, const moments_t& b)
+{
+  if (a.n < 2.0 || b.n < 2.0) {
+    return 0.0;
+  }
+
+  const double va = a.m2 / (a.n - 1.0);
+  const double vb = b.m2 / (b.n - 1.0);
+  const double den = std::sqrt(va / a.n + vb / b.n);
+
+  return den == 0.0 ? 0.0 : (a.mean - b.mean) / den;
+}
+
+// Largest |t| over uncropped measurements and measurements cropped at
+// increasingly lower percentiles ( dropping long tail of interrupts, cache
+// misses etc. ), as done by dudect
+static double
+max_t(const std::vector<uint64_t>& ticks, const std::vector<uint8_t>& cls)
+{
+  std::vector<uint64_t> sorted(ticks);
+  std::sort(sorted.begin(), sorted.end());
+
+  double worst = 0.0;
+
+  for (size_t c = 0; c <= CROPS; c++) {
+    uint64_t cut = ~0ul;
+
+    if (c > 0) {
+      const double q = 1.0 - std::pow(0.5, 10.0 * c / CROPS);
+      cut = sorted[static_cast<size_t>(q * (sorted.size() - 1))];
+    }
+
+    moments_t m[2];
+    for (size_t i = 0; i < ticks.size(); i++) {
+      if (ticks[i] <= cut) {
+        m[cls[i]].push(static_cast<double>(ticks[i]));
+      }
+    }
+
+    worst = std::max(worst, std::fabs(welch_t(m[0], m[1])));
+  }
+
+  return worst;
+}
+
+// Picks classes of N measurements at random, lets `prepare` set up inputs of
+// each measurement ( so that no class dependent work happens while timing ),
+// then times `op(i)` for each of them, returning largest |t|
+static double
+measure(const size_t cnt,
+        const std::function<void(const std::vector<uint8_t>&)>& prepare,
+        const std::function<void(size_t)>& op)
+{
+  std::vector<uint8_t> cls(cnt);
+  std::vector<uint64_t> ticks(cnt);
+
+  random_data(cls.data(), cnt);
+  for (auto& c : cls) {
+    c &= 1;
+  }
+
+  prepare(cls);
+
+  // warm up
+  for (size_t i = 0; i < std::min<size_t>(cnt, 1000); i++) {
+    op(i);
+  }
+
+  for (size_t i = 0; i < cnt; i++) {
+    const uint64_t t0 = bench_latency::start();
+    op(i);
+    const uint64_t t1 = bench_latency::stop();
+
+    ticks[i] = t1 - t0;
+  }
+
+  return max_t(ticks, cls);
+}
+
+// Prints one row of report, returning whether test passed
+static bool
+report(const char* name, const double t, const bool expect_leak)
+{
+  const bool leak = t > THRESHOLD;
+  const char* verdict = leak ? (expect_leak ? "differs, as expected" : "LEAK")
+                             : "constant-time";
+
+  std::printf("%-44s %10.2f   %s\n", name, t, verdict);
+  return expect_leak || !leak;
+}
+
+int
+main(int argc, char** argv)
+{
+  const size_t cnt = option(argc, argv, "--measurements", 200000);
+  const size_t dlen = option(argc, argv, "--ad", 16);
+  const size_t ctlen = option(argc, argv, "--ct", 64);
+  const size_t cpu = option(argc, argv, "--cpu", 0);
+
+  bench_latency::pin_to_core(cpu);
+
+  // pool of records, each with its own random cipher text and valid tag
+  constexpr size_t pool = 256;
+
+  uint8_t key[16], nonce[16];
+  random_data(key, sizeof(key));
+  random_data(nonce, sizeof(nonce));
+
+  std::vector<uint8_t> data(dlen), txt(pool * ctlen), enc(pool * ctlen);
+  std::vector<uint8_t> tags(pool * 16), bad(pool * 16), dec(ctlen);
+
+  random_data(data.data(), dlen);
+  random_data(txt.data(), txt.size());
+  random_data(bad.data(), bad.size());
+
+  for (size_t i = 0; i < pool; i++) {
+    gift_cofb::encrypt(key,
+                       nonce,
+                       data.data(),
+                       dlen,
+                       txt.data() + i * ctlen,
+                       enc.data() + i * ctlen,
+                       ctlen,
+                       tags.data() + i * 16);
+  }
+
+  // same valid tags, at other addresses, so that comparing with them doesn't
+  // hit cache lines, from which computed tag is loaded
+  const std::vector<uint8_t> good(tags);
+
+  // pool of copies of first record, so that fixed record is read from as many
+  // addresses as random ones
+  std::vector<uint8_t> fixed_enc(pool * ctlen), fixed_tags(pool * 16);
+  for (size_t i = 0; i < pool; i++) {
+    std::copy_n(enc.begin(), ctlen, fixed_enc.begin() + i * ctlen);
+    std::copy_n(tags.begin(), 16, fixed_tags.begin() + i * 16);
+  }
+
+  std::printf("GIFT-COFB decryption tail, dudect style leakage test, %zu "
+              "measurements, %zu -bytes AD, %zu -bytes text\n\n",
+              cnt,
+              dlen,
+              ctlen);
+  std::printf("%-44s %10s\n", "test ( class 0 vs class 1 )", "max |t|");
+
+  // per measurement inputs, set up before timing
+  std::vector<const uint8_t*> tgs(cnt), recs(cnt);
+
+  // class 0 gets valid tag, class 1 gets random tag
+  auto valid_or_random = [&](const std::vector<uint8_t>& cls) {
+    for (size_t i = 0; i < cnt; i++) {
+      const size_t j = i % pool;
+
+      tgs[i] = (cls[i] ? bad.data() : good.data()) + j * 16;
+      recs[i] = enc.data() + j * ctlen;
+    }
+  };
+
+  bool ok = true;
+
+  // keeps results of timed calls alive
+  volatile uint64_t sink = 0;
+
+  // tag comparison kernel alone: equal vs random tag
+  {
+    const double t = measure(cnt, valid_or_random, [&](const size_t i) {
+      const uint8_t* const tg = tags.data() + (i % pool) * 16;
+      const auto y = gift_cofb_common::load_block(tg);
+
+      sink = sink + gift_cofb_common::tag_mismatch(y, tgs[i]);
+    });
+
+    ok &= report("tag_mismatch: equal vs random tag", t, false);
+  }
+
+  // whole decryption, keeping text: valid vs random tag
+  {
+    const double t = measure(cnt, valid_or_random, [&](const size_t i) {
+      sink = sink + gift_cofb::decrypt<gift_cofb::KEEP>(
+        key, nonce, tgs[i], data.data(), dlen, recs[i], dec.data(), ctlen);
+    });
+
+    ok &= report("decrypt<KEEP>: valid vs random tag", t, false);
+  }
+
+  // whole decryption, zeroising text: tag wrong in first vs last byte
+  {
+    std::vector<uint8_t> first(tags), last(tags);
+    for (size_t i = 0; i < pool; i++) {
+      first[i * 16 + 0] ^= 1;
+      last[i * 16 + 15] ^= 1;
+    }
+
+    auto first_or_last = [&](const std::vector<uint8_t>& cls) {
+      for (size_t i = 0; i < cnt; i++) {
+        const size_t j = i % pool;
+
+        tgs[i] = (cls[i] ? last : first).data() + j * 16;
+        recs[i] = enc.data() + j * ctlen;
+      }
+    };
+
+    const double t = measure(cnt, first_or_last, [&](const size_t i) {
+      sink = sink + gift_cofb::decrypt(
+        key, nonce, tgs[i], data.data(), dlen, recs[i], dec.data(), ctlen);
+    });
+
+    ok &= report("decrypt: tag wrong in first vs last byte", t, false);
+  }
+
+  // whole decryption: fixed vs random record, both valid
+  {
+    auto fixed_or_random = [&](const std::vector<uint8_t>& cls) {
+      for (size_t i = 0; i < cnt; i++) {
+        const size_t j = i % pool;
+
+        tgs[i] = (cls[i] ? tags : fixed_tags).data() + j * 16;
+        recs[i] = (cls[i] ? enc : fixed_enc).data() + j * ctlen;
+      }
+    };
+
+    const double t = measure(cnt, fixed_or_random, [&](const size_t i) {
+      sink = sink + gift_cofb::decrypt(
+        key, nonce, tgs[i], data.data(), dlen, recs[i], dec.data(), ctlen);
+    });
+
+    ok &= report("decrypt: fixed vs random record", t, false);
+  }
+
+  // whole decryption, zeroising text: valid vs random tag, where only public
+  // verification result decides whether text is wiped
+  {
+    const double t = measure(cnt, valid_or_random, [&](const size_t i) {
+      sink = sink + gift_cofb::decrypt(
+        key, nonce, tgs[i], data.data(), dlen, recs[i], dec.data(), ctlen);
+    });
+
+    ok &= report("decrypt: valid vs random tag", t, true);
+  }
+
+  std::printf("\n|t| > %.1f means timing depends on class\n", THRESHOLD);
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,42 @@
+#include "aead.hpp"
+#include <cstddef>
+#include <cstdint>
+
+// GIFT-COFB encrypt/ decrypt, compiled in one build profile ( regular or small,
+// when GIFT_COFB_SMALL is defined ) and exported under profile specific names,
+// so that both profiles can be linked into `bench/profile.cpp`, while `.text`
+// section of each object holds nothing but code of that profile
+//
+// Compiled by `make bench/profile.out`, see `profile.cpp`
+
+#if defined GIFT_COFB_SMALL
+#define FOOTPRINT(name) small_##name
+#else
+#define FOOTPRINT(name) fast_##name
+#endif
+
+extern "C" void
+FOOTPRINT(encrypt)(const uint8_t* const key,
+                   const uint8_t* const nonce,
+                   const uint8_t* const data,
+                   const size_t dlen,
+                   const uint8_t* const txt,
+                   uint8_t* const enc,
+                   const size_t ctlen,
+                   uint8_t* const tag)
+{
+  gift_cofb::encrypt(key, nonce, data, dlen, txt, enc, ctlen, tag);
+}
+
+extern "C" bool
+FOOTPRINT(decrypt)(const uint8_t* const key,
+                   const uint8_t* const nonce,
+                   const uint8_t* const tag,
+                   const uint8_t* const data,
+                   const size_t dlen,
+                   const uint8_t* const enc,
+                   uint8_t* const txt,
+                   const size_t ctlen)
+{
+  return gift_cofb::decrypt(key, nonce, tag, data, dlen, enc, txt, ctlen);
+}
@@ -0,0 +1,179 @@
+#include "aead.hpp"
+#include "bench_latency.hpp"
+#include "utils.hpp"
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+
+// Latency distribution of single GIFT-COFB encrypt/ decrypt call, for small
+// message sizes, both with warm and cold caches
+//
+// Compile it with
+//
+// make bench/latency.out
+//
+// Run it with ( all arguments are optional )
+//
+// ./bench/latency.out --cpu=0 --ad=32 --warm-iters=100000 --cold-iters=2000
+// --evict-mib=64
+
+// Sub-bucket bits of latency histogram i.e. relative error < 2^-5 ≈ 3%
+constexpr size_t S = 5;
+
+// Plain/ cipher text byte lengths, for which latency distribution is reported
+constexpr size_t CTLENS[]{ 0, 16, 32, 64, 128, 256, 512, 1024, 1500 };
+
+// Reads value of command line option of form --name=value, if present
+static size_t
+option(const int argc, char** argv, const char* name, const size_t dflt)
+{
+  const size_t nlen = std::strlen(name);
+
+  for (int i = 1; i < argc; i++) {
+    if (std::strncmp(argv[i], name, nlen) == 0 && argv[i][nlen] == '=') {
+      return std::strtoull(argv[i] + nlen + 1, nullptr, 10);
+    }
+  }
+
+  return dflt;
+}
+
+// Prints one row of latency report
+static void
+report(const char* op,
+       const char* mode,
+       const size_t dlen,
+       const size_t ctlen,
+       const bench_latency::histogram_t<S>& hist,
+       const double tpn)
+{
+  const uint64_t p50 = hist.percentile(50.0);
+  const uint64_t p99 = hist.percentile(99.0);
+  const uint64_t p999 = hist.percentile(99.9);
+
+  std::printf("%-8s %-5s %6zu %6zu %10lu %10lu %10lu %10lu %10.1f %10.1f\n",
+              op,
+              mode,
+              dlen,
+              ctlen,
+              p50,
+              p99,
+              p999,
+              hist.max,
+              static_cast<double>(p99) / tpn,
+              static_cast<double>(hist.max) / tpn);
+}
+
+int
+main(int argc, char** argv)
+{
+  const size_t cpu = option(argc, argv, "--cpu", 0);
+  const size_t dlen = option(argc, argv, "--ad", 32);
+  const size_t warm_iters = option(argc, argv, "--warm-iters", 100000);
+  const size_t cold_iters = option(argc, argv, "--cold-iters", 2000);
+  const size_t evict_mib = option(argc, argv, "--evict-mib", 64);
+
+  if (!bench_latency::pin_to_core(cpu)) {
+    std::cerr << "warning: failed to pin to CPU " << cpu << std::endl;
+  }
+
+  const auto dur = std::chrono::milliseconds(200);
+  const double tpn = bench_latency::ticks_per_ns(dur);
+
+  constexpr size_t kntlen = 16;
+  constexpr size_t max_ctlen = CTLENS[std::size(CTLENS) - 1];
+
+  uint8_t* key = static_cast<uint8_t*>(std::malloc(kntlen));
+  uint8_t* nonce = static_cast<uint8_t*>(std::malloc(kntlen));
+  uint8_t* tag = static_cast<uint8_t*>(std::malloc(kntlen));
+  uint8_t* data = static_cast<uint8_t*>(std::malloc(dlen));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(max_ctlen));
+  uint8_t* enc = static_cast<uint8_t*>(std::malloc(max_ctlen));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(max_ctlen));
+
+  random_data(key, kntlen);
+  random_data(nonce, kntlen);
+  random_data(data, dlen);
+  random_data(txt, max_ctlen);
+
+  bench_latency::histogram_t<S> hist;
+  bench_latency::evictor_t evictor(evict_mib << 20);
+
+  std::printf("GIFT-COFB latency distribution, on CPU %zu, %.3f ticks/ns\n\n",
+              cpu,
+              tpn);
+  std::printf("%-8s %-5s %6s %6s %10s %10s %10s %10s %10s %10s\n",
+              "op",
+              "cache",
+              "ad",
+              "ct",
+              "p50",
+              "p99",
+              "p99.9",
+              "max",
+              "p99(ns)",
+              "max(ns)");
+
+  for (const size_t ctlen : CTLENS) {
+    for (const bool cold : { false, true }) {
+      const char* mode = cold ? "cold" : "warm";
+      const size_t iters = cold ? cold_iters : warm_iters;
+
+      // warm up code, data and CPU frequency, before measuring warm latency
+      for (size_t i = 0; i < (cold ? 0 : iters / 10); i++) {
+        gift_cofb::encrypt(key, nonce, data, dlen, txt, enc, ctlen, tag);
+      }
+
+      hist.reset();
+      for (size_t i = 0; i < iters; i++) {
+        if (cold) {
+          evictor.evict();
+        }
+
+        const uint64_t t0 = bench_latency::start();
+        gift_cofb::encrypt(key, nonce, data, dlen, txt, enc, ctlen, tag);
+        const uint64_t t1 = bench_latency::stop();
+
+        hist.record(t1 - t0);
+      }
+      report("encrypt", mode, dlen, ctlen, hist, tpn);
+
+      hist.reset();
+      for (size_t i = 0; i < iters; i++) {
+        if (cold) {
+          evictor.evict();
+        }
+
+        const uint64_t t0 = bench_latency::start();
+        const bool f =
+          gift_cofb::decrypt(key, nonce, tag, data, dlen, enc, dec, ctlen);
+        const uint64_t t1 = bench_latency::stop();
+
+        assert(f);
+        (void)f;
+
+        hist.record(t1 - t0);
+      }
+      report("decrypt", mode, dlen, ctlen, hist, tpn);
+    }
+
+    for (size_t i = 0; i < ctlen; i++) {
+      assert((txt[i] ^ dec[i]) == 0);
+    }
+  }
+
+  std::printf("\nlatencies are in cycle counter ticks, unless noted\n");
+
+  std::free(key);
+  std::free(nonce);
+  std::free(tag);
+  std::free(data);
+  std::free(txt);
+  std::free(enc);
+  std::free(dec);
+
+  return EXIT_SUCCESS;
+}
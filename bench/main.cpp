@@ -1,5 +1,6 @@
 #include "bench_gift.hpp"
 #include "bench_gift_cofb.hpp"
+#include "bench_random.hpp"
 
 // register gift-128 for benchmarking
 BENCHMARK(bench_gift_cofb::gift_permute<1>);
@@ -8,6 +9,87 @@ BENCHMARK(bench_gift_cofb::gift_permute<3>);
 BENCHMARK(bench_gift_cofb::gift_permute<4>);
 BENCHMARK(bench_gift_cofb::gift_permute<40>);
 
+// register inverse gift-128 for benchmarking
+BENCHMARK(bench_gift_cofb::gift_inverse_permute<1>);
+BENCHMARK(bench_gift_cofb::gift_inverse_permute<40>);
+
+// register gift-128 cbc mode for benchmarking
+BENCHMARK(bench_gift_cofb::cbc_encrypt)->Arg(64);
+BENCHMARK(bench_gift_cofb::cbc_decrypt)->Arg(64);
+BENCHMARK(bench_gift_cofb::cbc_encrypt)->Arg(256);
+BENCHMARK(bench_gift_cofb::cbc_decrypt)->Arg(256);
+
+// register gift-128 building blocks for benchmarking, in latency mode
+// ( dependent chain ) and throughput mode ( independent inputs ), separately
+BENCHMARK(bench_gift_cofb::gift_block_latency<gift::sub_cells>);
+BENCHMARK(bench_gift_cofb::gift_block_throughput<gift::sub_cells>);
+BENCHMARK(bench_gift_cofb::gift_block_latency<gift::inv_sub_cells>);
+BENCHMARK(bench_gift_cofb::gift_block_throughput<gift::inv_sub_cells>);
+BENCHMARK(bench_gift_cofb::gift_block_latency<bench_gift_cofb::add_round_keys>);
+BENCHMARK(
+  bench_gift_cofb::gift_block_throughput<bench_gift_cofb::add_round_keys>);
+BENCHMARK(bench_gift_cofb::gift_block_latency<gift::update_key_state>);
+BENCHMARK(bench_gift_cofb::gift_block_throughput<gift::update_key_state>);
+
+// register each compiled in perm_bits backend for benchmarking
+BENCHMARK(bench_gift_cofb::gift_block_latency<gift::perm_bits_ref>);
+BENCHMARK(bench_gift_cofb::gift_block_throughput<gift::perm_bits_ref>);
+BENCHMARK(bench_gift_cofb::gift_block_latency<gift::perm_bits_scalar>);
+BENCHMARK(bench_gift_cofb::gift_block_throughput<gift::perm_bits_scalar>);
+#if defined __SSE2__
+BENCHMARK(bench_gift_cofb::gift_block_latency<gift::perm_bits_sse2>);
+BENCHMARK(bench_gift_cofb::gift_block_throughput<gift::perm_bits_sse2>);
+#if defined __AVX2__
+BENCHMARK(bench_gift_cofb::gift_block_latency<gift::perm_bits_avx2>);
+BENCHMARK(bench_gift_cofb::gift_block_throughput<gift::perm_bits_avx2>);
+#endif
+#endif
+#if defined __ARM_NEON
+BENCHMARK(bench_gift_cofb::gift_block_latency<gift::perm_bits_neon>);
+BENCHMARK(bench_gift_cofb::gift_block_throughput<gift::perm_bits_neon>);
+#endif
+BENCHMARK(bench_gift_cofb::gift_block_latency<gift::inv_perm_bits>);
+BENCHMARK(bench_gift_cofb::gift_block_throughput<gift::inv_perm_bits>);
+
+// register transposed, multi-lane gift-128 building blocks for benchmarking
+BENCHMARK(bench_gift_cofb::gift_lanes_block<8, gift::sub_cells<8>, true>);
+BENCHMARK(bench_gift_cofb::gift_lanes_block<8, gift::sub_cells<8>, false>);
+BENCHMARK(bench_gift_cofb::gift_lanes_block<8, gift::perm_bits<8>, true>);
+BENCHMARK(bench_gift_cofb::gift_lanes_block<8, gift::perm_bits<8>, false>);
+BENCHMARK(bench_gift_cofb::gift_lanes_block<8, gift::inv_perm_bits<8>, true>);
+BENCHMARK(bench_gift_cofb::gift_lanes_block<8, gift::inv_perm_bits<8>, false>);
+
+// register gift-128 ecb mode, with one shared key vs. distinct keys per lane,
+// along with transposed key schedule itself, for benchmarking
+BENCHMARK(bench_gift_cofb::ecb_keys<false>)->Args({ 1024, 1 });
+BENCHMARK(bench_gift_cofb::ecb_keys<true>)->Args({ 1024, 1 });
+BENCHMARK(bench_gift_cofb::ecb_keys<true>)->Args({ 1024, 256 });
+BENCHMARK(bench_gift_cofb::gift_expand_keys<8>);
+
+// register bulk reduced-round gift-128 evaluation and differential sweep, on
+// one thread, for benchmarking
+BENCHMARK(bench_gift_cofb::reduced_evaluate)->Args({ 4, 4096, 1 });
+BENCHMARK(bench_gift_cofb::reduced_evaluate)->Args({ 40, 4096, 1 });
+BENCHMARK(bench_gift_cofb::reduced_sweep)->Args({ 4, 4096, 1 });
+BENCHMARK(bench_gift_cofb::reduced_sweep)->Args({ 8, 4096, 1 });
+
+// register gift-cofb building blocks for benchmarking, in latency mode
+// ( dependent chain ) and throughput mode ( independent inputs ), separately
+using gift_cofb_common::block_t;
+BENCHMARK(
+  bench_gift_cofb::cofb_block<block_t, gift_cofb_common::feedback, true>);
+BENCHMARK(
+  bench_gift_cofb::cofb_block<block_t, gift_cofb_common::feedback, false>);
+BENCHMARK(bench_gift_cofb::cofb_block<uint64_t, gift_cofb_common::lx2, true>);
+BENCHMARK(bench_gift_cofb::cofb_block<uint64_t, gift_cofb_common::lx2, false>);
+BENCHMARK(bench_gift_cofb::cofb_block<uint64_t, gift_cofb_common::lx3, true>);
+BENCHMARK(bench_gift_cofb::cofb_block<uint64_t, gift_cofb_common::lx3, false>);
+
+// register computation of masking offsets for benchmarking, chaining doublings
+// vs. filling offset ladder
+BENCHMARK(bench_gift_cofb::offsets<false>)->Arg(64)->Arg(1024);
+BENCHMARK(bench_gift_cofb::offsets<true>)->Arg(64)->Arg(1024);
+
 // register gift-cofb aead for benchmarking
 BENCHMARK(bench_gift_cofb::encrypt)->Args({ 32, 64 });
 BENCHMARK(bench_gift_cofb::decrypt)->Args({ 32, 64 });
@@ -24,5 +106,44 @@ BENCHMARK(bench_gift_cofb::decrypt)->Args({ 32, 2048 });
 BENCHMARK(bench_gift_cofb::encrypt)->Args({ 32, 4096 });
 BENCHMARK(bench_gift_cofb::decrypt)->Args({ 32, 4096 });
 
+// register gift-cofb aead, with long associated data/ plain text ( whose
+// masking offsets come from offset ladder ), for benchmarking
+BENCHMARK(bench_gift_cofb::encrypt)->Args({ 16384, 0 });
+BENCHMARK(bench_gift_cofb::decrypt)->Args({ 16384, 0 });
+BENCHMARK(bench_gift_cofb::encrypt)->Args({ 0, 16384 });
+BENCHMARK(bench_gift_cofb::decrypt)->Args({ 0, 16384 });
+
+// register batch gift-cofb aead, with many small records, for benchmarking
+BENCHMARK(bench_gift_cofb::batch<false>)->Args({ 10000, 16, 64 });
+BENCHMARK(bench_gift_cofb::batch<true>)->Args({ 10000, 16, 64 });
+
+// register sealing of small records under counter nonces, with E_K(N) computed
+// on critical path vs. taken from precomputation queue, for benchmarking
+BENCHMARK(bench_gift_cofb::seal_next<false>)->Args({ 16, 16 });
+BENCHMARK(bench_gift_cofb::seal_next<true>)->Args({ 16, 16 });
+BENCHMARK(bench_gift_cofb::seal_next<false>)->Args({ 16, 64 });
+BENCHMARK(bench_gift_cofb::seal_next<true>)->Args({ 16, 64 });
+
+// register incremental gift-cofb aead, fed in small/ large chunks, and its
+// checkpoint/ restore round trip, for benchmarking
+BENCHMARK(bench_gift_cofb::incremental)->Args({ 16384, 64 });
+BENCHMARK(bench_gift_cofb::incremental)->Args({ 16384, 4096 });
+BENCHMARK(bench_gift_cofb::checkpoint);
+
+// register run-time part of power-on self-test, for benchmarking
+BENCHMARK(bench_gift_cofb::power_on);
+
+// register tag comparison kernels, for benchmarking
+BENCHMARK(bench_gift_cofb::tag_mismatch<bench_gift_cofb::tag_mismatch_bytes>);
+BENCHMARK(bench_gift_cofb::tag_mismatch<gift_cofb_common::tag_mismatch_scalar>);
+#if defined __SSE2__
+BENCHMARK(bench_gift_cofb::tag_mismatch<gift_cofb_common::tag_mismatch_sse2>);
+#endif
+
+// register nonce generator and random byte sources, for benchmarking
+BENCHMARK(bench_gift_cofb::random_fill<false>)->Arg(16)->Arg(4096);
+BENCHMARK(bench_gift_cofb::random_fill<true>)->Arg(16)->Arg(4096)->Arg(1 << 20);
+BENCHMARK(bench_gift_cofb::nonce_next)->ThreadRange(1, 4);
+
 // benchmark runner main function
 BENCHMARK_MAIN();
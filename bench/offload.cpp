@@ -0,0 +1,276 @@
+#include "bench_latency.hpp"
+#include "offload.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// Load generator for GIFT-COFB offload daemon, where each of N clients ( think
+// of them as separate processes ) keeps D requests in flight, reporting
+// aggregate throughput, request latency and how well daemon coalesces requests
+// into batches
+//
+// Compile it with
+//
+// make bench/offload.out
+//
+// Run it with ( all arguments are optional ), either against in-process daemon
+// ( --spawn=1, default ) or already running one ( --spawn=0 )
+//
+// ./bench/offload.out --socket=/tmp/gift_cofbd.sock --spawn=1 --clients=4
+// --depth=32 --op=seal|open --ad=16 --size=64 --millis=1000 --max-batch=1024
+
+// Reads value of command line option of form --name=value, if present
+static const char*
+option(const int argc, char** argv, const char* name, const char* dflt)
+{
+  const size_t nlen = std::strlen(name);
+
+  for (int i = 1; i < argc; i++) {
+    if (std::strncmp(argv[i], name, nlen) == 0 && argv[i][nlen] == '=') {
+      return argv[i] + nlen + 1;
+    }
+  }
+
+  return dflt;
+}
+
+// Sub-bucket bits of latency histogram i.e. relative error < 2^-5 ≈ 3%
+constexpr size_t S = 5;
+
+// Nanoseconds elapsed since some fixed point in time
+static uint64_t
+now_ns()
+{
+  using namespace std::chrono;
+  const auto t = steady_clock::now().time_since_epoch();
+  return static_cast<uint64_t>(duration_cast<nanoseconds>(t).count());
+}
+
+// Outcome of one client's run
+struct result_t
+{
+  uint64_t records = 0;
+  bool failed = false;
+  bench_latency::histogram_t<S> hist;
+};
+
+// Runs one client, keeping `depth` -many requests in flight, until asked to
+// stop, then waits for all outstanding responses
+static void
+client(const char* path,
+       const bool opening,
+       const size_t dlen,
+       const size_t ctlen,
+       const size_t depth,
+       const std::atomic<bool>& stop,
+       result_t* const res)
+{
+  using namespace gift_cofb_offload;
+
+  client_t cl;
+  bool connected = false;
+
+  // in-process daemon may not be listening yet
+  for (size_t i = 0; i < 100 && !connected; i++) {
+    connected = cl.connect(path);
+    if (!connected) {
+      close(cl.fd);
+      cl.fd = -1;
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  }
+
+  uint8_t key[16], nonce[16];
+  random_data(key, sizeof(key));
+  random_data(nonce, sizeof(nonce));
+
+  if (!connected || !cl.set_key(0, key)) {
+    res->failed = true;
+    return;
+  }
+
+  std::vector<uint8_t> data(dlen), txt(ctlen), sealed(ctlen + 16);
+  std::vector<uint8_t> out(ctlen + 16);
+
+  random_data(data.data(), dlen);
+  random_data(txt.data(), ctlen);
+
+  gift_cofb::seal(
+    key, nonce, data.data(), dlen, txt.data(), ctlen, sealed.data());
+
+  const op_t op = opening ? OPEN : SEAL;
+  const uint8_t* const in = opening ? sealed.data() : txt.data();
+  const auto ad_len = static_cast<uint32_t>(dlen);
+  const auto len = static_cast<uint32_t>(opening ? ctlen + 16 : ctlen);
+  const auto out_len = static_cast<uint32_t>(opening ? ctlen : ctlen + 16);
+
+  std::vector<uint64_t> sent(depth);
+  uint64_t next_id = 0, inflight = 0;
+
+  // seal requests use unique nonces, while open requests reuse sealed record
+  auto submit = [&]() {
+    if (!opening) {
+      std::memcpy(nonce, &next_id, sizeof(next_id));
+    }
+
+    sent[next_id % depth] = now_ns();
+    const bool ok =
+      cl.submit(op, next_id, 0, nonce, data.data(), ad_len, in, len);
+
+    next_id++;
+    inflight += ok;
+    return ok;
+  };
+
+  while (inflight < depth && submit()) {
+  }
+
+  while (inflight > 0) {
+    response_t resp;
+    if (!cl.receive(&resp, out.data(), out.size())) {
+      res->failed = true;
+      return;
+    }
+
+    inflight--;
+    res->hist.record(now_ns() - sent[resp.id % depth]);
+    res->records++;
+
+    res->failed |= resp.status != OK || resp.len != out_len;
+
+    if (!stop.load(std::memory_order_relaxed)) {
+      submit();
+    }
+  }
+}
+
+int
+main(int argc, char** argv)
+{
+  const char* path = option(argc, argv, "--socket", "/tmp/gift_cofbd.sock");
+  const char* spawn_opt = option(argc, argv, "--spawn", "1");
+  const char* op_opt = option(argc, argv, "--op", "seal");
+
+  const bool spawn = std::strcmp(spawn_opt, "0") != 0;
+  const bool opening = std::strcmp(op_opt, "open") == 0;
+
+  auto num = [&](const char* name, const char* dflt) {
+    return std::strtoull(option(argc, argv, name, dflt), nullptr, 10);
+  };
+
+  const size_t clients = std::max<size_t>(num("--clients", "4"), 1);
+  const size_t depth = std::max<size_t>(num("--depth", "32"), 1);
+  const size_t dlen = num("--ad", "16");
+  const size_t ctlen = num("--size", "64");
+  const size_t millis = num("--millis", "1000");
+  const size_t max_batch = std::max<size_t>(num("--max-batch", "1024"), 1);
+
+  if (dlen + ctlen + 16 > gift_cofb_offload::MAX_LEN) {
+    std::fprintf(stderr, "record too large\n");
+    return EXIT_FAILURE;
+  }
+
+  // client only reads responses once all of its requests are written, so
+  // daemon must be able to queue all of them
+  const size_t resp_len = sizeof(gift_cofb_offload::response_t) + ctlen + 16;
+  if (depth * resp_len > gift_cofb_offload::MAX_QUEUED) {
+    std::fprintf(stderr,
+                 "need depth x response size <= %zu -bytes\n",
+                 gift_cofb_offload::MAX_QUEUED);
+    return EXIT_FAILURE;
+  }
+
+  std::signal(SIGPIPE, SIG_IGN);
+
+  std::atomic<bool> stop_server{ false };
+  gift_cofb_offload::server_stats_t stats;
+  std::thread server;
+
+  if (spawn) {
+    server = std::thread([&]() {
+      gift_cofb_offload::serve(path, stop_server, &stats, max_batch);
+    });
+  }
+
+  std::atomic<bool> stop{ false };
+  std::vector<result_t> results(clients);
+  std::vector<std::thread> threads;
+
+  const uint64_t t0 = now_ns();
+
+  for (size_t i = 0; i < clients; i++) {
+    threads.emplace_back(client,
+                         path,
+                         opening,
+                         dlen,
+                         ctlen,
+                         depth,
+                         std::cref(stop),
+                         &results[i]);
+  }
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(millis));
+  stop.store(true);
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  const double secs = static_cast<double>(now_ns() - t0) * 1e-9;
+
+  if (spawn) {
+    stop_server.store(true);
+    server.join();
+  }
+
+  bench_latency::histogram_t<S> hist;
+  uint64_t records = 0;
+  bool failed = false;
+
+  for (const result_t& r : results) {
+    for (size_t i = 0; i < hist.BUCKETS; i++) {
+      hist.counts[i] += r.hist.counts[i];
+    }
+
+    hist.total += r.hist.total;
+    hist.max = std::max(hist.max, r.hist.max);
+    records += r.records;
+    failed |= r.failed;
+  }
+
+  if (failed) {
+    std::fprintf(stderr, "some requests failed\n");
+    return EXIT_FAILURE;
+  }
+
+  const double rps = static_cast<double>(records) / secs;
+  const double mbps = rps * static_cast<double>(dlen + ctlen) * 1e-6;
+
+  std::printf("GIFT-COFB offload, %s of %zu -bytes AD + %zu -bytes text\n",
+              opening ? "open" : "seal",
+              dlen,
+              ctlen);
+  std::printf("%zu clients x %zu in flight\n\n", clients, depth);
+  std::printf("%-14s %12.0f\n", "records/s", rps);
+  std::printf("%-14s %12.2f\n", "MB/s", mbps);
+  std::printf("%-14s %12.2f\n", "p50 (us)", hist.percentile(50.0) * 1e-3);
+  std::printf("%-14s %12.2f\n", "p99 (us)", hist.percentile(99.0) * 1e-3);
+  std::printf("%-14s %12.2f\n", "max (us)", hist.max * 1e-3);
+
+  if (spawn) {
+    const uint64_t batches = stats.batches.load();
+    const double per_batch =
+      batches == 0 ? 0.0 : static_cast<double>(stats.records.load()) / batches;
+
+    std::printf("%-14s %12.2f\n", "records/batch", per_batch);
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,157 @@
+#include "utils.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Size/ speed trade-off of GIFT-COFB build profiles, i.e. regular profile,
+// which dispatches to fastest PermBits backend and offset ladder, against small
+// profile ( GIFT_COFB_SMALL ), which runs looped PermBits and one shared
+// encrypt/ decrypt core, built for size; reporting `.text` bytes of each
+// profile ( as measured on `bench/footprint.cpp` objects ) and throughput of
+// encrypt and decrypt, for a few message sizes
+//
+// Compile it with
+//
+// make bench/profile.out
+//
+// Run it with ( all arguments are optional; `make profile` passes `.text`
+// sizes, read off object files, which are otherwise reported as 0, while
+// --mib=N sets how many MiB are encrypted, per profile and message size )
+//
+// ./bench/profile.out --text-fast=0 --text-small=0 --mib=4
+
+// GIFT-COFB encrypt/ decrypt, with same signature as in `aead.hpp`
+using encrypt_t = void(const uint8_t*,
+                       const uint8_t*,
+                       const uint8_t*,
+                       size_t,
+                       const uint8_t*,
+                       uint8_t*,
+                       size_t,
+                       uint8_t*);
+using decrypt_t = bool(const uint8_t*,
+                       const uint8_t*,
+                       const uint8_t*,
+                       const uint8_t*,
+                       size_t,
+                       const uint8_t*,
+                       uint8_t*,
+                       size_t);
+
+// Both profiles, each from its own object file, see `footprint.cpp`
+extern "C" encrypt_t fast_encrypt, small_encrypt;
+extern "C" decrypt_t fast_decrypt, small_decrypt;
+
+// Reads value of command line option of form --name=value, if present
+static size_t
+option(const int argc, char** argv, const char* name, const size_t dflt)
+{
+  const size_t nlen = std::strlen(name);
+
+  for (int i = 1; i < argc; i++) {
+    if (std::strncmp(argv[i], name, nlen) == 0 && argv[i][nlen] == '=') {
+      return std::strtoull(argv[i] + nlen + 1, nullptr, 10);
+    }
+  }
+
+  return dflt;
+}
+
+// One build profile, under test
+struct profile_t
+{
+  const char* name;
+  encrypt_t* encrypt;
+  decrypt_t* decrypt;
+  size_t text;
+};
+
+// Encrypts ( and then decrypts ) M -bytes message, many times, returning MB/s
+// of encryption and decryption, along with whether every decryption verified
+static bool
+run(const profile_t& p,
+    const size_t ctlen,
+    const size_t reps,
+    double* const enc_mbps,
+    double* const dec_mbps)
+{
+  using clock = std::chrono::steady_clock;
+
+  // 16 -bytes associated data, as in a typical record header
+  const size_t dlen = 16;
+
+  uint8_t key[16], nonce[16], tag[16], data[dlen];
+  std::vector<uint8_t> txt(ctlen), enc(ctlen), dec(ctlen);
+
+  random_data(key, sizeof(key));
+  random_data(nonce, sizeof(nonce));
+  random_data(data, sizeof(data));
+  random_data(txt.data(), ctlen);
+
+  const auto t0 = clock::now();
+  for (size_t r = 0; r < reps; r++) {
+    p.encrypt(key, nonce, data, dlen, txt.data(), enc.data(), ctlen, tag);
+  }
+  const auto t1 = clock::now();
+
+  bool ok = true;
+  for (size_t r = 0; r < reps; r++) {
+    ok &= p.decrypt(key, nonce, tag, data, dlen, enc.data(), dec.data(), ctlen);
+  }
+  const auto t2 = clock::now();
+
+  using us = std::chrono::duration<double, std::micro>;
+
+  const double bytes = static_cast<double>(ctlen * reps);
+  *enc_mbps = bytes / us(t1 - t0).count();
+  *dec_mbps = bytes / us(t2 - t1).count();
+
+  return ok && std::equal(txt.begin(), txt.end(), dec.begin());
+}
+
+int
+main(int argc, char** argv)
+{
+  const size_t text_fast = option(argc, argv, "--text-fast", 0);
+  const size_t text_small = option(argc, argv, "--text-small", 0);
+  const size_t mib = std::max<size_t>(option(argc, argv, "--mib", 4), 1);
+
+  const profile_t profiles[]{
+    { "fast", fast_encrypt, fast_decrypt, text_fast },
+    { "small", small_encrypt, small_decrypt, text_small },
+  };
+
+  constexpr size_t sizes[]{ 64, 1024, 16384 };
+
+  std::printf("%8s %10s %8s %14s %14s\n",
+              "profile",
+              ".text",
+              "bytes",
+              "encrypt MB/s",
+              "decrypt MB/s");
+
+  for (const profile_t& p : profiles) {
+    for (const size_t ctlen : sizes) {
+      // same amount of work, for each message size
+      const size_t n = (mib << 20) / ctlen;
+
+      double enc_mbps = 0, dec_mbps = 0;
+      if (!run(p, ctlen, n, &enc_mbps, &dec_mbps)) {
+        std::fprintf(stderr, "%s profile failed to decrypt\n", p.name);
+        return EXIT_FAILURE;
+      }
+
+      std::printf("%8s %10zu %8zu %14.2f %14.2f\n",
+                  p.name,
+                  p.text,
+                  ctlen,
+                  enc_mbps,
+                  dec_mbps);
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,201 @@
+#include "record.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Throughput of GIFT-COFB record layer, over UDP on loopback, where sender
+// thread seals batches of B datagrams in one call and sends each batch with one
+// `sendmmsg`, while receiver thread receives batches with `recvmmsg` and opens
+// them in one call, checking them against anti-replay window
+//
+// Compile it with
+//
+// make bench/record.out
+//
+// Run it with ( all arguments are optional )
+//
+// ./bench/record.out --batch=32 --size=256 --millis=1000
+
+// Reads value of command line option of form --name=value, if present
+static size_t
+option(const int argc, char** argv, const char* name, const size_t dflt)
+{
+  const size_t nlen = std::strlen(name);
+
+  for (int i = 1; i < argc; i++) {
+    if (std::strncmp(argv[i], name, nlen) == 0 && argv[i][nlen] == '=') {
+      return std::strtoull(argv[i] + nlen + 1, nullptr, 10);
+    }
+  }
+
+  return dflt;
+}
+
+// Counters of receiving end
+struct received_t
+{
+  uint64_t records = 0;
+  uint64_t accepted = 0;
+  uint64_t syscalls = 0;
+};
+
+// Receives and opens batches, until sender is done and nothing arrives for a
+// while
+static void
+receiver(const int fd,
+         const uint8_t* key,
+         const uint8_t* iv,
+         const size_t batch,
+         const size_t len,
+         const std::atomic<bool>& done,
+         received_t* const res)
+{
+  gift_cofb_record::receiver_t rx(key, iv);
+
+  const size_t rlen = len + gift_cofb_record::OVERHEAD;
+  std::vector<uint8_t> recbuf(batch * rlen), decbuf(batch * len);
+  std::vector<iovec> recs(batch), decs(batch);
+  std::vector<mmsghdr> msgs(batch);
+  std::vector<uint8_t> status(batch);
+
+  for (size_t i = 0; i < batch; i++) {
+    recs[i] = { recbuf.data() + i * rlen, rlen };
+    msgs[i] = {};
+    msgs[i].msg_hdr.msg_iov = &recs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  while (true) {
+    const int n = recvmmsg(fd, msgs.data(), batch, MSG_WAITFORONE, nullptr);
+    if (n <= 0) {
+      if (done.load()) {
+        break;
+      }
+      continue;
+    }
+
+    const size_t cnt = static_cast<size_t>(n);
+    for (size_t i = 0; i < cnt; i++) {
+      recs[i].iov_len = msgs[i].msg_len;
+      decs[i] = { decbuf.data() + i * len, len };
+    }
+
+    res->accepted += rx.open(recs.data(), decs.data(), status.data(), cnt);
+    res->records += cnt;
+    res->syscalls++;
+
+    for (size_t i = 0; i < cnt; i++) {
+      recs[i].iov_len = rlen;
+    }
+  }
+}
+
+int
+main(int argc, char** argv)
+{
+  const size_t batch = std::max<size_t>(option(argc, argv, "--batch", 32), 1);
+  const size_t len = option(argc, argv, "--size", 256);
+  const size_t millis = option(argc, argv, "--millis", 1000);
+
+  uint8_t key[16], iv[16];
+  random_data(key, sizeof(key));
+  random_data(iv, sizeof(iv));
+
+  const int sfd = socket(AF_INET, SOCK_DGRAM, 0);
+  const int rfd = socket(AF_INET, SOCK_DGRAM, 0);
+
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  socklen_t alen = sizeof(addr);
+  const auto sa = reinterpret_cast<sockaddr*>(&addr);
+
+  const int rcvbuf = 1 << 24;
+  const timeval tmo{ 0, 100000 };
+
+  setsockopt(rfd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+  setsockopt(rfd, SOL_SOCKET, SO_RCVTIMEO, &tmo, sizeof(tmo));
+
+  if (bind(rfd, sa, alen) != 0 || getsockname(rfd, sa, &alen) != 0 ||
+      connect(sfd, sa, alen) != 0) {
+    std::fprintf(stderr, "failed to set up loopback sockets\n");
+    return EXIT_FAILURE;
+  }
+
+  std::atomic<bool> done{ false };
+  received_t res;
+
+  std::thread rt(receiver, rfd, key, iv, batch, len, std::cref(done), &res);
+
+  gift_cofb_record::sender_t tx(key, iv);
+
+  const size_t rlen = len + gift_cofb_record::OVERHEAD;
+  std::vector<uint8_t> txtbuf(batch * len), recbuf(batch * rlen);
+  std::vector<iovec> txts(batch), recs(batch);
+  std::vector<mmsghdr> msgs(batch);
+
+  random_data(txtbuf.data(), txtbuf.size());
+
+  for (size_t i = 0; i < batch; i++) {
+    txts[i] = { txtbuf.data() + i * len, len };
+    recs[i] = { recbuf.data() + i * rlen, rlen };
+    msgs[i] = {};
+    msgs[i].msg_hdr.msg_iov = &recs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  using clock = std::chrono::steady_clock;
+  const auto t0 = clock::now();
+  const auto until = t0 + std::chrono::milliseconds(millis);
+
+  uint64_t sent = 0;
+  while (clock::now() < until) {
+    tx.seal(txts.data(), recs.data(), batch);
+
+    const int n = sendmmsg(sfd, msgs.data(), batch, 0);
+    sent += n > 0 ? static_cast<uint64_t>(n) : 0;
+  }
+
+  const double secs = std::chrono::duration<double>(clock::now() - t0).count();
+
+  done.store(true);
+  rt.join();
+
+  close(sfd);
+  close(rfd);
+
+  if (res.accepted != res.records) {
+    std::fprintf(stderr, "some received records were rejected\n");
+    return EXIT_FAILURE;
+  }
+
+  const double rps = static_cast<double>(res.accepted) / secs;
+  const double dropped =
+    sent == 0 ? 0.0 : 100.0 * static_cast<double>(sent - res.records) / sent;
+  const double per_call =
+    res.syscalls == 0 ? 0.0 : static_cast<double>(res.records) / res.syscalls;
+
+  std::printf("GIFT-COFB record layer over UDP loopback, %zu -bytes datagrams,"
+              " batches of %zu\n\n",
+              len,
+              batch);
+  std::printf("%-18s %12.0f\n", "sent records/s", sent / secs);
+  std::printf("%-18s %12.0f\n", "opened records/s", rps);
+  std::printf("%-18s %12.2f\n", "opened MB/s", rps * len * 1e-6);
+  std::printf("%-18s %12.2f\n", "dropped (%)", dropped);
+  std::printf("%-18s %12.2f\n", "records/recvmmsg", per_call);
+
+  return EXIT_SUCCESS;
+}
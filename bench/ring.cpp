@@ -0,0 +1,273 @@
+#include "bench_latency.hpp"
+#include "ring.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// Throughput and latency of GIFT-COFB over shared memory ring, where each of P
+// producers keeps D records in flight, while pool of W workers seals/ opens
+// them in place; every producer maps region on its own ( as another process
+// would, using inherited file descriptors ), so that nothing but offsets is
+// shared between mappings
+//
+// Compile it with
+//
+// make bench/ring.out
+//
+// Run it with ( all arguments are optional )
+//
+// ./bench/ring.out --wait=poll|eventfd --workers=2 --producers=2 --depth=32
+// --op=seal|open --ad=16 --size=64 --slots=1024 --millis=1000
+
+// Reads value of command line option of form --name=value, if present
+static const char*
+option(const int argc, char** argv, const char* name, const char* dflt)
+{
+  const size_t nlen = std::strlen(name);
+
+  for (int i = 1; i < argc; i++) {
+    if (std::strncmp(argv[i], name, nlen) == 0 && argv[i][nlen] == '=') {
+      return argv[i] + nlen + 1;
+    }
+  }
+
+  return dflt;
+}
+
+// Sub-bucket bits of latency histogram i.e. relative error < 2^-5 ≈ 3%
+constexpr size_t S = 5;
+
+// Nanoseconds elapsed since some fixed point in time
+static uint64_t
+now_ns()
+{
+  using namespace std::chrono;
+  const auto t = steady_clock::now().time_since_epoch();
+  return static_cast<uint64_t>(duration_cast<nanoseconds>(t).count());
+}
+
+// Outcome of one producer's run
+struct result_t
+{
+  uint64_t records = 0;
+  bool failed = false;
+  bench_latency::histogram_t<S> hist;
+};
+
+// Runs one producer on its own mapping of region, keeping `depth` -many records
+// in flight on its lane, until asked to stop, then waits for all of them
+static void
+producer(const gift_cofb_ring::ring_t* const owner,
+         const uint32_t lane,
+         const bool opening,
+         const size_t dlen,
+         const size_t ctlen,
+         const size_t depth,
+         const std::atomic<bool>& stop,
+         result_t* const res)
+{
+  using namespace gift_cofb_ring;
+
+  ring_t ring;
+  if (!ring.attach(owner->fd, owner->sub_efd, owner->cmp_efd)) {
+    res->failed = true;
+    return;
+  }
+
+  const size_t tlen = ctlen + gift_cofb::TAG_LEN;
+
+  uint8_t key[16], nonce[16];
+  std::memcpy(key, ring.shm->keys, sizeof(key));
+  random_data(nonce, sizeof(nonce));
+
+  std::vector<uint8_t> rec(dlen + tlen);
+  random_data(rec.data(), dlen + ctlen);
+
+  const uint8_t* const data = rec.data();
+  uint8_t* const txt = rec.data() + dlen;
+
+  if (opening) {
+    gift_cofb::seal(key, nonce, data, dlen, txt, ctlen, txt);
+  }
+
+  std::vector<uint64_t> sent(ring.slot_cnt);
+  uint64_t next = 0, inflight = 0;
+
+  // seal records use unique nonces, while open records reuse sealed one
+  auto submit = [&]() {
+    const uint32_t idx = ring.acquire();
+    if (idx == NONE) {
+      return false;
+    }
+
+    slot_t* const d = ring.desc(idx);
+
+    d->op = opening ? OPEN : SEAL;
+    d->key_idx = 0;
+    d->lane = lane;
+    d->user = next;
+    d->dlen = static_cast<uint32_t>(dlen);
+    d->len = static_cast<uint32_t>(ctlen);
+    std::memcpy(d->nonce, nonce, sizeof(nonce));
+
+    if (!opening) {
+      std::memcpy(d->nonce, &next, sizeof(next));
+    }
+
+    const size_t plen = opening ? dlen + tlen : dlen + ctlen;
+    std::memcpy(ring.payload(idx), rec.data(), plen);
+
+    sent[idx] = now_ns();
+    ring.submit(idx);
+
+    next++;
+    inflight++;
+    return true;
+  };
+
+  while (inflight < depth && submit()) {
+  }
+
+  while (inflight > 0) {
+    const uint32_t idx = ring.wait(lane);
+    if (idx == NONE) {
+      res->failed = true;
+      return;
+    }
+
+    inflight--;
+    res->hist.record(now_ns() - sent[idx]);
+    res->records++;
+    res->failed |= ring.desc(idx)->ok == 0;
+
+    ring.release(idx);
+
+    if (!stop.load(std::memory_order_relaxed)) {
+      submit();
+    }
+  }
+}
+
+int
+main(int argc, char** argv)
+{
+  using namespace gift_cofb_ring;
+
+  const char* wait_opt = option(argc, argv, "--wait", "poll");
+  const char* op_opt = option(argc, argv, "--op", "seal");
+
+  const bool sleeping = std::strcmp(wait_opt, "eventfd") == 0;
+  const bool opening = std::strcmp(op_opt, "open") == 0;
+
+  auto num = [&](const char* name, const char* dflt) {
+    return std::strtoull(option(argc, argv, name, dflt), nullptr, 10);
+  };
+
+  const size_t workers = std::max<size_t>(num("--workers", "2"), 1);
+  const size_t producers = std::max<size_t>(num("--producers", "2"), 1);
+  const size_t depth = std::max<size_t>(num("--depth", "32"), 1);
+  const size_t dlen = num("--ad", "16");
+  const size_t ctlen = num("--size", "64");
+  const size_t slots = std::max<size_t>(num("--slots", "1024"), 1);
+  const size_t millis = num("--millis", "1000");
+
+  if (producers > MAX_LANES || producers * depth > slots) {
+    std::fprintf(stderr,
+                 "need producers <= %zu and producers x depth <= slots\n",
+                 MAX_LANES);
+    return EXIT_FAILURE;
+  }
+
+  ring_t ring;
+  const size_t slot_len = dlen + ctlen + gift_cofb::TAG_LEN;
+
+  const wait_t wait = sleeping ? EVENTFD : BUSY_POLL;
+
+  if (!ring.create(slots, slot_len, producers, wait)) {
+    std::fprintf(stderr, "failed to create shared memory ring\n");
+    return EXIT_FAILURE;
+  }
+
+  uint8_t key[16];
+  random_data(key, sizeof(key));
+  ring.set_key(0, key);
+
+  std::atomic<bool> stop{ false };
+  std::vector<result_t> results(producers);
+  double secs = 0.0;
+
+  {
+    pool_t pool(&ring, workers);
+    std::vector<std::thread> threads;
+
+    const uint64_t t0 = now_ns();
+
+    for (size_t i = 0; i < producers; i++) {
+      threads.emplace_back(producer,
+                           &ring,
+                           static_cast<uint32_t>(i),
+                           opening,
+                           dlen,
+                           ctlen,
+                           depth,
+                           std::cref(stop),
+                           &results[i]);
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(millis));
+    stop.store(true);
+
+    for (auto& t : threads) {
+      t.join();
+    }
+
+    secs = static_cast<double>(now_ns() - t0) * 1e-9;
+  }
+
+  bench_latency::histogram_t<S> hist;
+  uint64_t records = 0;
+  bool failed = false;
+
+  for (const result_t& r : results) {
+    for (size_t i = 0; i < hist.BUCKETS; i++) {
+      hist.counts[i] += r.hist.counts[i];
+    }
+
+    hist.total += r.hist.total;
+    hist.max = std::max(hist.max, r.hist.max);
+    records += r.records;
+    failed |= r.failed;
+  }
+
+  if (failed) {
+    std::fprintf(stderr, "some records failed\n");
+    return EXIT_FAILURE;
+  }
+
+  const double rps = static_cast<double>(records) / secs;
+  const double mbps = rps * static_cast<double>(dlen + ctlen) * 1e-6;
+
+  std::printf("GIFT-COFB shared memory ring, %s of %zu -bytes AD + %zu -bytes "
+              "text, %s wait\n",
+              opening ? "open" : "seal",
+              dlen,
+              ctlen,
+              sleeping ? "eventfd" : "busy-poll");
+  std::printf("%zu producers x %zu in flight, %zu workers\n\n",
+              producers,
+              depth,
+              workers);
+  std::printf("%-14s %12.0f\n", "records/s", rps);
+  std::printf("%-14s %12.2f\n", "MB/s", mbps);
+  std::printf("%-14s %12.2f\n", "p50 (us)", hist.percentile(50.0) * 1e-3);
+  std::printf("%-14s %12.2f\n", "p99 (us)", hist.percentile(99.0) * 1e-3);
+  std::printf("%-14s %12.2f\n", "max (us)", hist.max * 1e-3);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,169 @@
+#include "aead.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Throughput of GIFT-COFB encryption of large messages, in regular mode vs.
+// large message mode ( prefetched plain text, non-temporal cipher text
+// stores ), along with how much of a co-located service's working set survives
+// sealing one message i.e. time to read back a victim buffer, which was cached
+// right before sealing, compared against reading it back without sealing
+// anything
+//
+// Compile it with
+//
+// make bench/stream.out
+//
+// Large message mode threshold and prefetch distance are compile-time knobs
+// ( see `common.hpp` ), say
+//
+// make bench/stream.out DFLAGS=-DGIFT_COFB_PREFETCH_DISTANCE=2048
+//
+// Run it with ( all arguments are optional; --max-kib=1048576 sweeps up to
+// 1 GiB, which takes minutes )
+//
+// ./bench/stream.out --min-kib=64 --max-kib=16384 --victim-kib=1024 --reps=3
+
+// Reads value of command line option of form --name=value, if present
+static size_t
+option(const int argc, char** argv, const char* name, const size_t dflt)
+{
+  const size_t nlen = std::strlen(name);
+
+  for (int i = 1; i < argc; i++) {
+    if (std::strncmp(argv[i], name, nlen) == 0 && argv[i][nlen] == '=') {
+      return std::strtoull(argv[i] + nlen + 1, nullptr, 10);
+    }
+  }
+
+  return dflt;
+}
+
+// Reads one byte of each cache line of victim buffer, returning nanoseconds
+// taken per cache line
+static double
+touch(const uint8_t* const victim, const size_t len)
+{
+  using clock = std::chrono::steady_clock;
+
+  const auto t0 = clock::now();
+
+  for (size_t off = 0; off < len; off += 64) {
+    (void)*static_cast<const volatile uint8_t*>(victim + off);
+  }
+
+  const auto t1 = clock::now();
+
+  const double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+  return ns / static_cast<double>(len >> 6);
+}
+
+// Encrypts message in given mode, returning MB/s, and ns per victim cache line
+// read back right after
+template<const bool streamed>
+static void
+run(const uint8_t* const key,
+    const uint8_t* const nonce,
+    const uint8_t* const txt,
+    uint8_t* const enc,
+    const size_t ctlen,
+    const uint8_t* const victim,
+    const size_t vlen,
+    double* const mbps,
+    double* const ns_per_line)
+{
+  using clock = std::chrono::steady_clock;
+
+  uint8_t tag[16];
+
+  touch(victim, vlen);
+
+  const auto t0 = clock::now();
+  gift_cofb::encrypt_from<false, streamed>(
+    key, nonce, {}, nullptr, 0, txt, enc, ctlen, tag);
+  const auto t1 = clock::now();
+
+  *ns_per_line = touch(victim, vlen);
+
+  const double us = std::chrono::duration<double, std::micro>(t1 - t0).count();
+  *mbps = static_cast<double>(ctlen) / us;
+}
+
+int
+main(int argc, char** argv)
+{
+  const size_t min_kib = option(argc, argv, "--min-kib", 64);
+  const size_t max_kib = option(argc, argv, "--max-kib", 16384);
+  const size_t victim_kib = option(argc, argv, "--victim-kib", 1024);
+  const size_t reps = std::max<size_t>(option(argc, argv, "--reps", 3), 1);
+
+  // both rounded up to whole pages, as required by `aligned_alloc`
+  const size_t max_len = ((max_kib + 3) >> 2) << 12;
+  const size_t vlen = ((victim_kib + 3) >> 2) << 12;
+
+  // page aligned buffers, so that cipher text can be written with
+  // non-temporal stores
+  auto txt = static_cast<uint8_t*>(std::aligned_alloc(4096, max_len));
+  auto enc = static_cast<uint8_t*>(std::aligned_alloc(4096, max_len));
+  auto victim = static_cast<uint8_t*>(std::aligned_alloc(4096, vlen));
+
+  if (txt == nullptr || enc == nullptr || victim == nullptr) {
+    std::fprintf(stderr, "failed to allocate buffers\n");
+    return EXIT_FAILURE;
+  }
+
+  uint8_t key[16], nonce[16];
+  random_data(key, sizeof(key));
+  random_data(nonce, sizeof(nonce));
+  random_data(txt, max_len);
+  random_data(victim, vlen);
+  std::memset(enc, 0, max_len);
+
+  touch(victim, vlen);
+  const double idle = touch(victim, vlen);
+
+  std::printf("threshold %zu -bytes, prefetch distance %zu -bytes\n",
+              gift_cofb_common::STREAM_THRESHOLD,
+              gift_cofb_common::PREFETCH_DISTANCE);
+  std::printf("victim %zu KiB, read back in %.2f ns/line, when idle\n\n",
+              victim_kib,
+              idle);
+  std::printf("%10s %12s %12s %14s %14s\n",
+              "KiB",
+              "MB/s",
+              "MB/s(nt)",
+              "victim ns",
+              "victim ns(nt)");
+
+  for (size_t kib = min_kib; kib <= max_kib; kib <<= 1) {
+    const size_t len = kib << 10;
+
+    // averages over repetitions, alternating between modes
+    double sum[4]{};
+    for (size_t r = 0; r < reps; r++) {
+      double v[4];
+      run<false>(key, nonce, txt, enc, len, victim, vlen, &v[0], &v[2]);
+      run<true>(key, nonce, txt, enc, len, victim, vlen, &v[1], &v[3]);
+
+      for (size_t i = 0; i < 4; i++) {
+        sum[i] += v[i] / static_cast<double>(reps);
+      }
+    }
+
+    std::printf("%10zu %12.2f %12.2f %14.2f %14.2f\n",
+                kib,
+                sum[0],
+                sum[1],
+                sum[2],
+                sum[3]);
+  }
+
+  std::free(txt);
+  std::free(enc);
+  std::free(victim);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,187 @@
+#include "bench_traffic.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+// Aggregate GIFT-COFB seal/ open throughput on realistic traffic mixes ( IMIX,
+// log records or user supplied CSV of `ad_len,pt_len` pairs ), while scaling
+// from 1 to N threads, for capacity planning
+//
+// Compile it with
+//
+// make bench/traffic.out
+//
+// Run it with ( all arguments are optional )
+//
+// ./bench/traffic.out --mix=imix|logs|<path to csv> --records=100000 --keys=16
+// --max-threads=<#-of hardware threads> --millis=1000
+
+// Reads value of command line option of form --name=value, if present
+static const char*
+option(const int argc, char** argv, const char* name, const char* dflt)
+{
+  const size_t nlen = std::strlen(name);
+
+  for (int i = 1; i < argc; i++) {
+    if (std::strncmp(argv[i], name, nlen) == 0 && argv[i][nlen] == '=') {
+      return argv[i] + nlen + 1;
+    }
+  }
+
+  return dflt;
+}
+
+// Result of running workload on some number of threads, for some duration
+struct result_t
+{
+  double secs;
+  uint64_t records;
+  uint64_t bytes;
+};
+
+// Runs workload on T threads, each of them repeatedly sealing ( or opening )
+// its share of records ( i.e. records t, t + T, t + 2T ... ), until asked to
+// stop, after given duration
+static result_t
+run(const bench_traffic::workload_t& wl,
+    const size_t thread_cnt,
+    const bool opening,
+    const std::chrono::milliseconds dur)
+{
+  std::atomic<bool> go{ false };
+  std::atomic<bool> stop{ false };
+  std::vector<uint64_t> records(thread_cnt, 0);
+  std::vector<uint64_t> bytes(thread_cnt, 0);
+  std::vector<std::thread> threads;
+
+  for (size_t t = 0; t < thread_cnt; t++) {
+    threads.emplace_back([&, t]() {
+      std::vector<uint8_t> out(wl.max_ctlen + 16);
+      uint64_t recs = 0, byts = 0;
+
+      while (!go.load(std::memory_order_acquire)) {
+      }
+
+      // stop is checked after every record, as one pass over a large
+      // workload can take longer than whole run
+      const size_t n = wl.records.size();
+      size_t i = t;
+
+      while (i < n && !stop.load(std::memory_order_relaxed)) {
+        if (opening) {
+          const bool f = bench_traffic::open(wl, i, out.data());
+          if (!f) {
+            std::abort();
+          }
+        } else {
+          bench_traffic::seal(wl, i, out.data(), out.data() + wl.max_ctlen);
+        }
+
+        recs++;
+        byts += wl.records[i].dlen + wl.records[i].ctlen;
+
+        i += thread_cnt;
+        i = i < n ? i : t;
+      }
+
+      records[t] = recs;
+      bytes[t] = byts;
+    });
+  }
+
+  const auto t0 = std::chrono::steady_clock::now();
+  go.store(true, std::memory_order_release);
+
+  std::this_thread::sleep_for(dur);
+  stop.store(true, std::memory_order_relaxed);
+
+  for (auto& th : threads) {
+    th.join();
+  }
+
+  const auto t1 = std::chrono::steady_clock::now();
+
+  result_t res{ std::chrono::duration<double>(t1 - t0).count(), 0, 0 };
+  for (size_t t = 0; t < thread_cnt; t++) {
+    res.records += records[t];
+    res.bytes += bytes[t];
+  }
+
+  return res;
+}
+
+int
+main(int argc, char** argv)
+{
+  const std::string mix_name = option(argc, argv, "--mix", "imix");
+  const size_t rec_cnt = std::atoll(option(argc, argv, "--records", "100000"));
+  const size_t key_cnt = std::atoll(option(argc, argv, "--keys", "16"));
+  const size_t millis = std::atoll(option(argc, argv, "--millis", "1000"));
+
+  const size_t hw = std::max(1u, std::thread::hardware_concurrency());
+  const std::string hw_ = std::to_string(hw);
+  const size_t max_threads =
+    std::atoll(option(argc, argv, "--max-threads", hw_.c_str()));
+
+  std::vector<bench_traffic::size_class_t> mix;
+  if (mix_name == "imix") {
+    mix = bench_traffic::IMIX;
+  } else if (mix_name == "logs") {
+    mix = bench_traffic::LOGS;
+  } else {
+    mix = bench_traffic::read_csv(mix_name);
+  }
+
+  if (mix.empty() || rec_cnt == 0 || key_cnt == 0 || max_threads == 0) {
+    std::cerr << "nothing to benchmark, check arguments" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const auto wl = bench_traffic::generate(mix, rec_cnt, key_cnt);
+  const double avg = static_cast<double>(wl.total_bytes) / rec_cnt;
+
+  std::printf("GIFT-COFB traffic mix `%s`, %zu records ( avg %.1f bytes ), "
+              "%zu keys\n\n",
+              mix_name.c_str(),
+              rec_cnt,
+              avg,
+              key_cnt);
+  std::printf("%-5s %8s %14s %10s %10s\n",
+              "op",
+              "threads",
+              "records/s",
+              "GB/s",
+              "scaling");
+
+  std::vector<size_t> counts;
+  for (size_t t = 1; t < max_threads; t <<= 1) {
+    counts.push_back(t);
+  }
+  counts.push_back(max_threads);
+
+  for (const bool opening : { false, true }) {
+    double base = 0.;
+
+    for (const size_t t : counts) {
+      const auto res = run(wl, t, opening, std::chrono::milliseconds(millis));
+
+      const double rps = static_cast<double>(res.records) / res.secs;
+      const double gbps = static_cast<double>(res.bytes) / res.secs / 1e9;
+
+      base = t == 1 ? rps : base;
+
+      std::printf("%-5s %8zu %14.0f %10.4f %9.2fx\n",
+                  opening ? "open" : "seal",
+                  t,
+                  rps,
+                  gbps,
+                  rps / base);
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,79 @@
+#include "offload.hpp"
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// GIFT-COFB offload daemon, serving seal/ open requests of local processes
+// over Unix domain socket, see `offload.hpp`
+//
+// Compile it with
+//
+// make daemon/gift_cofbd.out
+//
+// Run it with ( all arguments are optional )
+//
+// ./daemon/gift_cofbd.out --socket=/tmp/gift_cofbd.sock --max-batch=1024
+
+// Reads value of command line option of form --name=value, if present
+static const char*
+option(const int argc, char** argv, const char* name, const char* dflt)
+{
+  const size_t nlen = std::strlen(name);
+
+  for (int i = 1; i < argc; i++) {
+    if (std::strncmp(argv[i], name, nlen) == 0 && argv[i][nlen] == '=') {
+      return argv[i] + nlen + 1;
+    }
+  }
+
+  return dflt;
+}
+
+// Set by SIGINT/ SIGTERM handler, asking daemon to stop
+static std::atomic<bool> stop{ false };
+
+static void
+on_signal(int)
+{
+  stop.store(true, std::memory_order_relaxed);
+}
+
+int
+main(int argc, char** argv)
+{
+  const char* path = option(argc, argv, "--socket", "/tmp/gift_cofbd.sock");
+  const char* mbs = option(argc, argv, "--max-batch", "1024");
+  const size_t max_batch = std::strtoull(mbs, nullptr, 10);
+
+  if (max_batch == 0) {
+    std::fprintf(stderr, "batch size must be > 0\n");
+    return EXIT_FAILURE;
+  }
+
+  std::signal(SIGINT, on_signal);
+  std::signal(SIGTERM, on_signal);
+  std::signal(SIGPIPE, SIG_IGN);
+
+  std::printf("serving on %s, with batches of at max %zu records\n",
+              path,
+              max_batch);
+  std::fflush(stdout);
+
+  gift_cofb_offload::server_stats_t stats;
+  if (!gift_cofb_offload::serve(path, stop, &stats, max_batch)) {
+    std::perror("failed to listen");
+    return EXIT_FAILURE;
+  }
+
+  const uint64_t batches = stats.batches.load();
+  const uint64_t records = stats.records.load();
+
+  std::printf("served %lu records, in %lu batches ( %.2f records/batch )\n",
+              records,
+              batches,
+              batches == 0 ? 0.0 : static_cast<double>(records) / batches);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,125 @@
+#include "async.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <coroutine>
+#include <cstdlib>
+#include <exception>
+#include <future>
+#include <iostream>
+#include <vector>
+
+// Compile it with
+//
+// g++ -std=c++20 -Wall -O3 -pthread -I ./include example/async.cpp
+
+// Minimal fire-and-forget coroutine type, enough for this example; real event
+// loops bring their own task types, which can await same `async_seal`/
+// `async_open` awaitables
+struct detached_t
+{
+  struct promise_type
+  {
+    detached_t get_return_object() { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+  };
+};
+
+// Seals plain text and opens it back, without blocking caller, signalling
+// verification flag of opened record through promise
+static detached_t
+roundtrip(gift_cofb_async::executor_t& ex,
+          const uint8_t* key,
+          const uint8_t* nonce,
+          const uint8_t* data,
+          const uint8_t* txt,
+          uint8_t* enc,
+          uint8_t* dec,
+          uint8_t* tag,
+          std::promise<bool>* ok)
+{
+  using namespace gift_cofb_async;
+
+  co_await async_seal(ex, { key, nonce, data, 32, txt, enc, 32, tag });
+  const bool f =
+    co_await async_open(ex, { key, nonce, data, 32, enc, dec, 32, tag });
+
+  ok->set_value(f);
+}
+
+int
+main()
+{
+  constexpr size_t cnt = 16;
+
+  uint8_t key[16], nonce[16], data[32];
+  std::vector<uint8_t> txt(cnt * 32), enc(cnt * 32), dec(cnt * 32);
+  std::vector<uint8_t> tags(cnt * 16), ref(32), ref_tag(16);
+
+  random_data(key, sizeof(key));
+  random_data(nonce, sizeof(nonce));
+  random_data(data, sizeof(data));
+  random_data(txt.data(), txt.size());
+
+  // requests submitted within 100 us are coalesced into one batch
+  gift_cofb_async::executor_t ex(std::chrono::microseconds(100));
+
+  // coroutine style: each coroutine suspends on seal and then on open
+  std::vector<std::promise<bool>> oks(cnt);
+  for (size_t i = 0; i < cnt; i++) {
+    roundtrip(ex,
+              key,
+              nonce,
+              data,
+              txt.data() + i * 32,
+              enc.data() + i * 32,
+              dec.data() + i * 32,
+              tags.data() + i * 16,
+              &oks[i]);
+  }
+
+  for (size_t i = 0; i < cnt; i++) {
+    const bool f = oks[i].get_future().get();
+    assert(f);
+    (void)f;
+  }
+
+  // future style: submit all, then wait for all
+  std::vector<std::future<bool>> futs;
+  for (size_t i = 0; i < cnt; i++) {
+    const gift_cofb_async::job_t job{ key,
+                                      nonce,
+                                      data,
+                                      32,
+                                      dec.data() + i * 32,
+                                      enc.data() + i * 32,
+                                      32,
+                                      tags.data() + i * 16 };
+
+    futs.push_back(gift_cofb_async::seal_future(ex, job));
+  }
+  for (auto& f : futs) {
+    f.wait();
+  }
+
+  // cross-check with blocking API
+  for (size_t i = 0; i < cnt; i++) {
+    const uint8_t* const msg = txt.data() + i * 32;
+    gift_cofb::encrypt(
+      key, nonce, data, 32, msg, ref.data(), 32, ref_tag.data());
+
+    assert(std::equal(ref.begin(), ref.end(), enc.begin() + i * 32));
+    assert(std::equal(ref_tag.begin(), ref_tag.end(), tags.begin() + i * 16));
+  }
+
+  const auto [batches, records] = ex.stats();
+
+  std::cout << "GIFT-COFB async API" << std::endl << std::endl;
+  std::cout << records << " records, in " << batches << " batches" << std::endl;
+
+  return EXIT_SUCCESS;
+}
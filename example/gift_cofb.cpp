@@ -1,4 +1,5 @@
 #include "aead.hpp"
+#include "selftest.hpp"
 #include "utils.hpp"
 #include <cassert>
 #include <iostream>
@@ -12,6 +13,11 @@ main()
   uint8_t key[16], nonce[16], tag[16];
   uint8_t data[32], txt[32], enc[32], dec[32];
 
+  // known answer self-test, which is mostly done at compile-time; only its
+  // run-time part, checking dispatched PermBits backend, is left for here
+  const bool passed = gift_cofb_selftest::power_on();
+  assert(passed);
+
   // generate random key, nonce, associated data & plain text
   random_data(key, sizeof(key));
   random_data(nonce, sizeof(nonce));
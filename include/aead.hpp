@@ -1,261 +1,359 @@
 #pragma once
 #include "common.hpp"
 #include "gift.hpp"
+#include "instrument.hpp"
+#include "linkage.hpp"
 
 // GIFT-COFB Authenticated Encryption with Associated Data
 namespace gift_cofb {
 
-// Given 128 -bit secret key, 128 -bit public message nonce, N -bytes associated
-// data ( which is never encrypted ) and M -bytes plain text ( which is
-// encrypted ) | N, M >= 0, this routine computes M -bytes encrypted text and
-// 128 -bit authentication tag, using GIFT-COFB AEAD
+// Shared GIFT-COFB core, which absorbs N -bytes associated data and then
+// encrypts ( or decrypts, when `decrypting` is set ) M -bytes input into
+// output, one block at a time, doubling masking offset per block, starting
+// from 128 -bit nonce or, when it's null, from precomputed Y = E_K(N), and
+// returns final chaining value i.e. authentication tag | N, M >= 0
 //
-// See algorithmic specification in figure 2.3 of
-// https://csrc.nist.gov/CSRC/media/Projects/lightweight-cryptography/documents/finalist-round/updated-spec-doc/gift-cofb-spec-final.pdf
-static void
-encrypt(const uint8_t* const __restrict key,   // 128 -bit key
-        const uint8_t* const __restrict nonce, // 128 -bit nonce
-        const uint8_t* const __restrict data,  // N -bytes associated data
-        const size_t dlen,                     // len(data) | >= 0
-        const uint8_t* const __restrict txt,   // M -bytes plain text
-        uint8_t* const __restrict enc,         // M -bytes encrypted text
-        const size_t ctlen,                    // len(enc) = len(txt) | >= 0
-        uint8_t* const __restrict tag          // 128 -bit authentication tag
+// It's whole of encryption and decryption in small build profile ( see
+// GIFT_COFB_SMALL ), where it's kept out of line, so that only one copy of it
+// exists, while it's also what `encrypt_constexpr` evaluates at compile-time
+[[gnu::noinline]] GIFT_COFB_INLINE constexpr gift_cofb_common::block_t
+shared_core(const uint8_t* const key,           // 128 -bit key
+            const uint8_t* const nonce,         // 128 -bit nonce or null
+            const gift_cofb_common::block_t y0, // E_K(N), if nonce is null
+            const uint8_t* const data,          // N -bytes associated data
+            const size_t dlen,                  // len(data) | >= 0
+            const uint8_t* const in,            // M -bytes input text
+            uint8_t* const out,                 // M -bytes output text
+            const size_t ctlen,                 // len(out) = len(in) | >= 0
+            const bool decrypting               // is input encrypted text ?
 )
 {
-  gift::state_t st;
-  gift::initialize(&st, nonce, key);
-  gift::permute<gift::ROUNDS>(&st);
+  using namespace gift_cofb_common;
 
-  uint32_t tmp[4];
+  uint16_t kst[8];
+  load_key(kst, key);
 
-  uint32_t y[4];
-  std::memcpy(y, st.cipher, sizeof(y));
+  block_t y = y0;
+  if (nonce != nullptr) {
+    y = encrypt_block(load_block(nonce), kst);
+  }
 
-  uint32_t l[2];
-  std::memcpy(l, y, sizeof(l));
+  uint64_t l = y.hi;
 
   {
-    const size_t full_blk_cnt = dlen >> 4;
-    const size_t rm_bytes = dlen & 15;
-
-    constexpr size_t br0[2] = { 0, 1 };
-    const bool flg0 = (dlen == 0) | (rm_bytes > 0);
-
-    const size_t tot_blk_cnt = full_blk_cnt + br0[flg0];
+    // empty associated data is processed as one padded block
+    const size_t tot_blk_cnt = dlen == 0 ? 1 : (dlen + 15) >> 4;
 
     size_t off = 0;
     for (size_t i = 0; i < tot_blk_cnt - 1; i++) {
-      gift_cofb_common::lx2(l);
-
-      std::memcpy(tmp, y, sizeof(tmp));
-      gift_cofb_common::feedback(tmp);
-
-      uint32_t blk[4];
-
-      for (size_t j = 0; j < 4; j++) {
-        const size_t boff = j << 2;
-        blk[j] = (static_cast<uint32_t>(data[off + (boff ^ 0)]) << 24) |
-                 (static_cast<uint32_t>(data[off + (boff ^ 1)]) << 16) |
-                 (static_cast<uint32_t>(data[off + (boff ^ 2)]) << 8) |
-                 (static_cast<uint32_t>(data[off + (boff ^ 3)]) << 0);
-      }
-
+      l = lx2(l);
+      y = absorb(y, l, load_block(data + off), kst);
       off += 16;
-
-      blk[0] ^= tmp[0] ^ l[0];
-      blk[1] ^= tmp[1] ^ l[1];
-      blk[2] ^= tmp[2];
-      blk[3] ^= tmp[3];
-
-      gift::initialize(&st, blk, key);
-      gift::permute<gift::ROUNDS>(&st);
-
-      std::memcpy(y, st.cipher, sizeof(y));
     }
 
-    if (rm_bytes == 0 && dlen > 0) {
-      gift_cofb_common::lx3(l);
+    if (dlen == 0 || (dlen & 15) > 0) {
+      l = lx3(lx3(l));
     } else {
-      gift_cofb_common::lx3(l);
-      gift_cofb_common::lx3(l);
+      l = lx3(l);
     }
 
     if (ctlen == 0) {
-      gift_cofb_common::lx3(l);
-      gift_cofb_common::lx3(l);
+      l = lx3(lx3(l));
     }
 
-    uint32_t padded_blk[4];
-    std::memset(padded_blk, 0, sizeof(padded_blk));
-
     const size_t to_read = dlen - off;
+    const block_t blk = pad(load_partial(data + off, to_read), to_read);
+    y = absorb(y, l, blk, kst);
+  }
 
-    const size_t word_cnt = to_read >> 2;
-    const size_t left_bytes = to_read & 3;
-
-    for (size_t i = 0; i < word_cnt; i++) {
-      const size_t boff = i << 2;
-      padded_blk[i] = (static_cast<uint32_t>(data[off + (boff ^ 0)]) << 24) |
-                      (static_cast<uint32_t>(data[off + (boff ^ 1)]) << 16) |
-                      (static_cast<uint32_t>(data[off + (boff ^ 2)]) << 8) |
-                      (static_cast<uint32_t>(data[off + (boff ^ 3)]) << 0);
-    }
+  if (ctlen > 0) {
+    const size_t tot_blk_cnt = (ctlen + 15) >> 4;
 
-    off += word_cnt << 2;
+    size_t off = 0;
+    for (size_t i = 0; i < tot_blk_cnt - 1; i++) {
+      const block_t blk = load_block(in + off);
+      const block_t res = blk ^ y;
+      store_block(res, out + off);
 
-    uint32_t w = 0b10000000u << ((3ul - left_bytes) << 3);
-    for (size_t i = 0; i < left_bytes; i++) {
-      w |= static_cast<uint32_t>(data[off + i]) << ((3ul - i) << 3);
+      // plain text block is absorbed, in both directions
+      l = lx2(l);
+      y = absorb(y, l, decrypting ? res : blk, kst);
+      off += 16;
     }
 
-    off += left_bytes;
-
-    const uint32_t br1[2] = { 0, w };
-    const uint32_t br2[2] = { 1, 0 };
+    if ((ctlen & 15) == 0) {
+      l = lx3(l);
+    } else {
+      l = lx3(lx3(l));
+    }
 
-    const bool flg1 = static_cast<bool>(word_cnt ^ 4);
+    const size_t to_read = ctlen - off;
+    const block_t blk = load_partial(in + off, to_read);
+    const block_t res = blk ^ y;
+    store_partial(res, out + off, to_read);
+    y = absorb(y, l, pad(decrypting ? res : blk, to_read), kst);
+  }
 
-    padded_blk[word_cnt - br2[flg1]] ^= br1[to_read < 16];
+  return y;
+}
 
-    std::memcpy(tmp, y, sizeof(tmp));
-    gift_cofb_common::feedback(tmp);
+// Encrypts M -bytes plain text and computes 128 -bit authentication tag, using
+// GIFT-COFB AEAD, starting either from 128 -bit nonce, which is encrypted
+// first, to obtain initial chaining value Y = E_K(N), or from already computed
+// Y, when `precomputed` is set, in which case nonce isn't read; see `encrypt`
+//
+// When `streamed` is set, plain text is prefetched PREFETCH_DISTANCE -bytes
+// ahead and full blocks of cipher text are written with non-temporal stores
+// ( given that it's 16 -bytes aligned ), see `STREAM_THRESHOLD`
+template<const bool precomputed, const bool streamed = false>
+GIFT_COFB_API void
+encrypt_from(const uint8_t* const __restrict key,   // 128 -bit key
+             const uint8_t* const __restrict nonce, // 128 -bit nonce
+             const gift_cofb_common::block_t y0,    // E_K(N), if precomputed
+             const uint8_t* const __restrict data,  // N -bytes associated data
+             const size_t dlen,                     // len(data) | >= 0
+             const uint8_t* const txt,              // M -bytes plain text
+             uint8_t* const enc,                    // M -bytes encrypted text
+             const size_t ctlen,             // len(enc) = len(txt) | >= 0
+             uint8_t* const __restrict tag   // 128 -bit authentication tag
+)
+{
+  using namespace gift_cofb_common;
 
-    padded_blk[0] ^= tmp[0] ^ l[0];
-    padded_blk[1] ^= tmp[1] ^ l[1];
-    padded_blk[2] ^= tmp[2];
-    padded_blk[3] ^= tmp[3];
+  GIFT_COFB_PROBE(ENCRYPT_CALLS, dlen, ctlen);
 
-    gift::initialize(&st, padded_blk, key);
-    gift::permute<gift::ROUNDS>(&st);
+  uint16_t kst[8];
+  load_key(kst, key);
 
-    std::memcpy(y, st.cipher, sizeof(y));
+  block_t y = y0;
+  if constexpr (!precomputed) {
+    y = encrypt_block(load_block(nonce), kst);
   }
 
-  if (ctlen > 0) {
-    const size_t full_blk_cnt = ctlen >> 4;
-    const size_t rm_bytes = ctlen & 15;
-
-    constexpr size_t br0[2] = { 0, 1 };
-    const bool flg0 = (ctlen == 0) | (rm_bytes > 0);
-
-    const size_t tot_blk_cnt = full_blk_cnt + br0[flg0];
+  uint64_t l = y.hi;
 
-    size_t off = 0;
-    for (size_t i = 0; i < tot_blk_cnt - 1; i++) {
-      gift_cofb_common::lx2(l);
+  // masking offsets of full blocks, computed ahead of block loop
+  ladder_t ldr;
 
-      uint32_t blk[4];
+  GIFT_COFB_PROBE_PHASE(INIT, !precomputed);
 
-      for (size_t j = 0; j < 4; j++) {
-        const size_t boff = j << 2;
-
-        blk[j] = (static_cast<uint32_t>(txt[off + (boff ^ 0)]) << 24) |
-                 (static_cast<uint32_t>(txt[off + (boff ^ 1)]) << 16) |
-                 (static_cast<uint32_t>(txt[off + (boff ^ 2)]) << 8) |
-                 (static_cast<uint32_t>(txt[off + (boff ^ 3)]) << 0);
+  {
+    // empty associated data is processed as one padded block
+    const size_t tot_blk_cnt = dlen == 0 ? 1 : (dlen + 15) >> 4;
 
-        const uint32_t w = blk[j] ^ y[j];
+    size_t off = 0;
+    for (size_t i = 0; i < tot_blk_cnt - 1; i += LADDER) {
+      const size_t cnt = std::min(LADDER, tot_blk_cnt - 1 - i);
+      fill_ladder(&ldr, l, cnt);
 
-        enc[off + (boff ^ 0)] = static_cast<uint8_t>(w >> 24);
-        enc[off + (boff ^ 1)] = static_cast<uint8_t>(w >> 16);
-        enc[off + (boff ^ 2)] = static_cast<uint8_t>(w >> 8);
-        enc[off + (boff ^ 3)] = static_cast<uint8_t>(w >> 0);
+      for (size_t j = 0; j < cnt; j++) {
+        y = absorb(y, ldr.rungs[j], load_block(data + off), kst);
+        off += 16;
       }
 
-      off += 16;
-
-      std::memcpy(tmp, y, sizeof(tmp));
-      gift_cofb_common::feedback(tmp);
-
-      blk[0] ^= tmp[0] ^ l[0];
-      blk[1] ^= tmp[1] ^ l[1];
-      blk[2] ^= tmp[2];
-      blk[3] ^= tmp[3];
-
-      gift::initialize(&st, blk, key);
-      gift::permute<gift::ROUNDS>(&st);
-
-      std::memcpy(y, st.cipher, sizeof(y));
+      l = ldr.rungs[cnt - 1];
     }
 
-    if (rm_bytes == 0) {
-      gift_cofb_common::lx3(l);
+    if (dlen == 0 || (dlen & 15) > 0) {
+      l = lx3(lx3(l));
     } else {
-      gift_cofb_common::lx3(l);
-      gift_cofb_common::lx3(l);
+      l = lx3(l);
     }
 
-    uint32_t padded_blk[4];
-    std::memset(padded_blk, 0, sizeof(padded_blk));
+    if (ctlen == 0) {
+      l = lx3(lx3(l));
+    }
 
-    const size_t to_read = ctlen - off;
+    const size_t to_read = dlen - off;
+    const block_t blk = pad(load_partial(data + off, to_read), to_read);
+    y = absorb(y, l, blk, kst);
 
-    const size_t word_cnt = to_read >> 2;
-    const size_t left_bytes = to_read & 3;
+    GIFT_COFB_PROBE_PHASE(AD, tot_blk_cnt);
+  }
 
-    for (size_t i = 0; i < word_cnt; i++) {
-      const size_t boff = i << 2;
+  if (ctlen > 0) {
+    const size_t tot_blk_cnt = (ctlen + 15) >> 4;
 
-      padded_blk[i] = (static_cast<uint32_t>(txt[off + (boff ^ 0)]) << 24) |
-                      (static_cast<uint32_t>(txt[off + (boff ^ 1)]) << 16) |
-                      (static_cast<uint32_t>(txt[off + (boff ^ 2)]) << 8) |
-                      (static_cast<uint32_t>(txt[off + (boff ^ 3)]) << 0);
-    }
+    // non-temporal stores need 16 -bytes aligned destination
+    const bool nt = streamed && (reinterpret_cast<uintptr_t>(enc) & 15) == 0;
 
-    off += word_cnt << 2;
+    size_t off = 0;
+    for (size_t i = 0; i < tot_blk_cnt - 1; i += LADDER) {
+      const size_t cnt = std::min(LADDER, tot_blk_cnt - 1 - i);
+      fill_ladder(&ldr, l, cnt);
+
+      for (size_t j = 0; j < cnt; j++) {
+        if constexpr (streamed) {
+          if ((off & 63) == 0) {
+            prefetch(txt + off + PREFETCH_DISTANCE);
+          }
+        }
+
+        const block_t blk = load_block(txt + off);
+        if (nt) {
+          store_block_nt(blk ^ y, enc + off);
+        } else {
+          store_block(blk ^ y, enc + off);
+        }
+        y = absorb(y, ldr.rungs[j], blk, kst);
+
+        off += 16;
+      }
 
-    uint32_t w = 0b10000000u << ((3ul - left_bytes) << 3);
-    for (size_t i = 0; i < left_bytes; i++) {
-      w |= static_cast<uint32_t>(txt[off + i]) << ((3ul - i) << 3);
+      l = ldr.rungs[cnt - 1];
     }
 
-    off -= word_cnt << 2;
+    if (nt) {
+      stream_fence();
+    }
 
-    const uint32_t br1[2] = { 0, w };
-    const uint32_t br2[2] = { 1, 0 };
+    GIFT_COFB_PROBE_PHASE(MSG, tot_blk_cnt - 1);
 
-    const bool flg1 = static_cast<bool>(word_cnt ^ 4);
+    if ((ctlen & 15) == 0) {
+      l = lx3(l);
+    } else {
+      l = lx3(lx3(l));
+    }
 
-    padded_blk[word_cnt - br2[flg1]] ^= br1[to_read < 16];
+    const size_t to_read = ctlen - off;
+    const block_t blk = load_partial(txt + off, to_read);
+    store_partial(blk ^ y, enc + off, to_read);
+    y = absorb(y, l, pad(blk, to_read), kst);
 
-    uint32_t ciphered_blk[4];
-    for (size_t i = 0; i < 4; i++) {
-      ciphered_blk[i] = padded_blk[i] ^ y[i];
-    }
+    GIFT_COFB_PROBE_PHASE(TAIL, 1);
+  }
 
-    for (size_t i = 0; i < to_read; i++) {
-      const size_t woff = i >> 2;
-      const size_t boff = i & 3;
-      const size_t soff = (3 - boff) << 3;
+  store_block(y, tag);
 
-      enc[off + i] = static_cast<uint8_t>(ciphered_blk[woff] >> soff);
-    }
+  GIFT_COFB_PROBE_PHASE(TAG, 0);
+}
 
-    std::memcpy(tmp, y, sizeof(tmp));
-    gift_cofb_common::feedback(tmp);
+#if defined GIFT_COFB_COMPILED && !defined GIFT_COFB_SMALL
 
-    padded_blk[0] ^= tmp[0] ^ l[0];
-    padded_blk[1] ^= tmp[1] ^ l[1];
-    padded_blk[2] ^= tmp[2];
-    padded_blk[3] ^= tmp[3];
+// Every variant of `encrypt_from`, which is instantiated only in compiled
+// library, see `linkage.hpp`; unused in small build profile
+#define GIFT_COFB_ENCRYPT_FROM(precomputed, streamed)                          \
+  GIFT_COFB_EXTERN template void encrypt_from<precomputed, streamed>(          \
+    const uint8_t*,                                                            \
+    const uint8_t*,                                                            \
+    const gift_cofb_common::block_t,                                           \
+    const uint8_t*,                                                            \
+    const size_t,                                                              \
+    const uint8_t*,                                                            \
+    uint8_t*,                                                                  \
+    const size_t,                                                              \
+    uint8_t*)
 
-    gift::initialize(&st, padded_blk, key);
-    gift::permute<gift::ROUNDS>(&st);
+GIFT_COFB_ENCRYPT_FROM(false, false);
+GIFT_COFB_ENCRYPT_FROM(false, true);
+GIFT_COFB_ENCRYPT_FROM(true, false);
+GIFT_COFB_ENCRYPT_FROM(true, true);
 
-    std::memcpy(y, st.cipher, sizeof(y));
-  }
+#undef GIFT_COFB_ENCRYPT_FROM
 
-  for (size_t i = 0; i < 4; i++) {
-    const size_t boff = i << 2;
+#endif
 
-    tag[boff ^ 0] = static_cast<uint8_t>(y[i] >> 24);
-    tag[boff ^ 1] = static_cast<uint8_t>(y[i] >> 16);
-    tag[boff ^ 2] = static_cast<uint8_t>(y[i] >> 8);
-    tag[boff ^ 3] = static_cast<uint8_t>(y[i] >> 0);
+// Given 128 -bit secret key, 128 -bit public message nonce, N -bytes associated
+// data ( which is never encrypted ) and M -bytes plain text ( which is
+// encrypted ) | N, M >= 0, this routine computes M -bytes encrypted text and
+// 128 -bit authentication tag, using GIFT-COFB AEAD
+//
+// Plain text and encrypted text can be the same buffer ( i.e. in-place
+// encryption ), as every block is read before it's overwritten, but they must
+// not partially overlap
+//
+// Plain text of at least STREAM_THRESHOLD -bytes ( see `common.hpp` ) is
+// encrypted in large message mode, which writes cipher text around caches
+//
+// See algorithmic specification in figure 2.3 of
+// https://csrc.nist.gov/CSRC/media/Projects/lightweight-cryptography/documents/finalist-round/updated-spec-doc/gift-cofb-spec-final.pdf
+GIFT_COFB_INLINE void
+encrypt(const uint8_t* const __restrict key,   // 128 -bit key
+        const uint8_t* const __restrict nonce, // 128 -bit nonce
+        const uint8_t* const __restrict data,  // N -bytes associated data
+        const size_t dlen,                     // len(data) | >= 0
+        const uint8_t* const txt,              // M -bytes plain text
+        uint8_t* const enc,                    // M -bytes encrypted text
+        const size_t ctlen,                    // len(enc) = len(txt) | >= 0
+        uint8_t* const __restrict tag          // 128 -bit authentication tag
+)
+{
+#if defined GIFT_COFB_SMALL
+  GIFT_COFB_PROBE(ENCRYPT_CALLS, dlen, ctlen);
+
+  const gift_cofb_common::block_t y =
+    shared_core(key, nonce, {}, data, dlen, txt, enc, ctlen, false);
+  gift_cofb_common::store_block(y, tag);
+#else
+  if (ctlen >= gift_cofb_common::STREAM_THRESHOLD) [[unlikely]] {
+    encrypt_from<false, true>(key, nonce, {}, data, dlen, txt, enc, ctlen, tag);
+  } else {
+    encrypt_from<false>(key, nonce, {}, data, dlen, txt, enc, ctlen, tag);
   }
+#endif
 }
 
+// Same as `encrypt`, but instead of nonce, it takes initial chaining value
+// Y = E_K(N), computed ahead of time ( say by `gift_cofb_precompute` ), so that
+// one full GIFT-128 encryption is off critical path of this call
+GIFT_COFB_INLINE void
+encrypt_precomputed(
+  const uint8_t* const __restrict key,   // 128 -bit key
+  const gift_cofb_common::block_t y0,    // E_K(N), for 128 -bit nonce N
+  const uint8_t* const __restrict data,  // N -bytes associated data
+  const size_t dlen,                     // len(data) | >= 0
+  const uint8_t* const txt,              // M -bytes plain text
+  uint8_t* const enc,                    // M -bytes encrypted text
+  const size_t ctlen,                    // len(enc) = len(txt) | >= 0
+  uint8_t* const __restrict tag          // 128 -bit authentication tag
+)
+{
+#if defined GIFT_COFB_SMALL
+  GIFT_COFB_PROBE(ENCRYPT_CALLS, dlen, ctlen);
+
+  const gift_cofb_common::block_t y =
+    shared_core(key, nullptr, y0, data, dlen, txt, enc, ctlen, false);
+  gift_cofb_common::store_block(y, tag);
+#else
+  if (ctlen >= gift_cofb_common::STREAM_THRESHOLD) [[unlikely]] {
+    encrypt_from<true, true>(
+      key, nullptr, y0, data, dlen, txt, enc, ctlen, tag);
+  } else {
+    encrypt_from<true>(key, nullptr, y0, data, dlen, txt, enc, ctlen, tag);
+  }
+#endif
+}
+
+// Same as `encrypt`, but written so that it can also be evaluated at
+// compile-time ( say inside a `static_assert`, checking Known Answer Tests,
+// see `selftest.hpp` ), where GIFT-128 runs on scalar PermBits
+//
+// Blocks are absorbed one at a time, by `shared_core`, without offset ladder,
+// instrumentation probes or large message mode, so at run-time it's slower than
+// `encrypt`, while producing same output
+GIFT_COFB_INLINE constexpr void
+encrypt_constexpr(const uint8_t* const key,   // 128 -bit key
+                  const uint8_t* const nonce, // 128 -bit nonce
+                  const uint8_t* const data,  // N -bytes associated data
+                  const size_t dlen,          // len(data) | >= 0
+                  const uint8_t* const txt,   // M -bytes plain text
+                  uint8_t* const enc,         // M -bytes encrypted text
+                  const size_t ctlen,         // len(enc) = len(txt) | >= 0
+                  uint8_t* const tag          // 128 -bit authentication tag
+)
+{
+  const gift_cofb_common::block_t y =
+    shared_core(key, nonce, {}, data, dlen, txt, enc, ctlen, false);
+  gift_cofb_common::store_block(y, tag);
+}
+
+// What happens to decrypted text, when authentication tag doesn't verify
+enum release_t
+{
+  ZEROISE, // decrypted text is zeroed, so that it can't be consumed by mistake
+  KEEP     // decrypted text is left as is, caller must discard it
+};
+
 // Given 128 -bit secret key, 128 -bit public message nonce, 128 -bit
 // authentication tag, N -bytes associated data ( which was never encrypted )
 // and M -bytes encrypted text | N, M >= 0, this routine computes M -bytes
@@ -264,285 +362,274 @@ encrypt(const uint8_t* const __restrict key,   // 128 -bit key
 // Before consuming decrypted bytes, ensure presence of truth value in
 // verification flag.
 //
+// Encrypted text and decrypted text can be the same buffer ( i.e. in-place
+// decryption ), but they must not partially overlap
+//
+// Tags are compared in constant-time, while decrypted text is zeroed ( with
+// default release policy ) only when verification fails i.e. only the
+// verification flag, which is returned anyway, decides whether it's touched
+//
 // See algorithmic specification in figure 2.3 of
 // https://csrc.nist.gov/CSRC/media/Projects/lightweight-cryptography/documents/finalist-round/updated-spec-doc/gift-cofb-spec-final.pdf
-static bool
+template<const release_t release = ZEROISE>
+GIFT_COFB_API bool
 decrypt(const uint8_t* const __restrict key,   // 128 -bit key
         const uint8_t* const __restrict nonce, // 128 -bit nonce
         const uint8_t* const __restrict tag,   // 128 -bit authentication tag
         const uint8_t* const __restrict data,  // N -bytes associated data
         const size_t dlen,                     // len(data) | >= 0
-        const uint8_t* const __restrict enc,   // M -bytes encrypted text
-        uint8_t* const __restrict txt,         // M -bytes decrypted text
+        const uint8_t* const enc,              // M -bytes encrypted text
+        uint8_t* const txt,                    // M -bytes decrypted text
         const size_t ctlen                     // len(enc) = len(txt) | >= 0
 )
 {
-  gift::state_t st;
-  gift::initialize(&st, nonce, key);
-  gift::permute<gift::ROUNDS>(&st);
+  using namespace gift_cofb_common;
 
-  uint32_t tmp[4];
+  GIFT_COFB_PROBE(DECRYPT_CALLS, dlen, ctlen);
 
-  uint32_t y[4];
-  std::memcpy(y, st.cipher, sizeof(y));
+#if defined GIFT_COFB_SMALL
+  const block_t y =
+    shared_core(key, nonce, {}, data, dlen, enc, txt, ctlen, true);
+#else
+  uint16_t kst[8];
+  load_key(kst, key);
 
-  uint32_t l[2];
-  std::memcpy(l, y, sizeof(l));
+  block_t y = encrypt_block(load_block(nonce), kst);
+  uint64_t l = y.hi;
 
-  {
-    const size_t full_blk_cnt = dlen >> 4;
-    const size_t rm_bytes = dlen & 15;
+  // masking offsets of full blocks, computed ahead of block loop
+  ladder_t ldr;
 
-    constexpr size_t br0[2] = { 0, 1 };
-    const bool flg0 = (dlen == 0) | (rm_bytes > 0);
+  GIFT_COFB_PROBE_PHASE(INIT, 1);
 
-    const size_t tot_blk_cnt = full_blk_cnt + br0[flg0];
+  {
+    // empty associated data is processed as one padded block
+    const size_t tot_blk_cnt = dlen == 0 ? 1 : (dlen + 15) >> 4;
 
     size_t off = 0;
-    for (size_t i = 0; i < tot_blk_cnt - 1; i++) {
-      gift_cofb_common::lx2(l);
-
-      std::memcpy(tmp, y, sizeof(tmp));
-      gift_cofb_common::feedback(tmp);
+    for (size_t i = 0; i < tot_blk_cnt - 1; i += LADDER) {
+      const size_t cnt = std::min(LADDER, tot_blk_cnt - 1 - i);
+      fill_ladder(&ldr, l, cnt);
 
-      uint32_t blk[4];
-
-      for (size_t j = 0; j < 4; j++) {
-        const size_t boff = j << 2;
-        blk[j] = (static_cast<uint32_t>(data[off + (boff ^ 0)]) << 24) |
-                 (static_cast<uint32_t>(data[off + (boff ^ 1)]) << 16) |
-                 (static_cast<uint32_t>(data[off + (boff ^ 2)]) << 8) |
-                 (static_cast<uint32_t>(data[off + (boff ^ 3)]) << 0);
+      for (size_t j = 0; j < cnt; j++) {
+        y = absorb(y, ldr.rungs[j], load_block(data + off), kst);
+        off += 16;
       }
 
-      off += 16;
-
-      blk[0] ^= tmp[0] ^ l[0];
-      blk[1] ^= tmp[1] ^ l[1];
-      blk[2] ^= tmp[2];
-      blk[3] ^= tmp[3];
-
-      gift::initialize(&st, blk, key);
-      gift::permute<gift::ROUNDS>(&st);
-
-      std::memcpy(y, st.cipher, sizeof(y));
+      l = ldr.rungs[cnt - 1];
     }
 
-    if (rm_bytes == 0 && dlen > 0) {
-      gift_cofb_common::lx3(l);
+    if (dlen == 0 || (dlen & 15) > 0) {
+      l = lx3(lx3(l));
     } else {
-      gift_cofb_common::lx3(l);
-      gift_cofb_common::lx3(l);
+      l = lx3(l);
     }
 
     if (ctlen == 0) {
-      gift_cofb_common::lx3(l);
-      gift_cofb_common::lx3(l);
+      l = lx3(lx3(l));
     }
 
-    uint32_t padded_blk[4];
-    std::memset(padded_blk, 0, sizeof(padded_blk));
-
     const size_t to_read = dlen - off;
+    const block_t blk = pad(load_partial(data + off, to_read), to_read);
+    y = absorb(y, l, blk, kst);
 
-    const size_t word_cnt = to_read >> 2;
-    const size_t left_bytes = to_read & 3;
-
-    for (size_t i = 0; i < word_cnt; i++) {
-      const size_t boff = i << 2;
-      padded_blk[i] = (static_cast<uint32_t>(data[off + (boff ^ 0)]) << 24) |
-                      (static_cast<uint32_t>(data[off + (boff ^ 1)]) << 16) |
-                      (static_cast<uint32_t>(data[off + (boff ^ 2)]) << 8) |
-                      (static_cast<uint32_t>(data[off + (boff ^ 3)]) << 0);
-    }
-
-    off += word_cnt << 2;
-
-    uint32_t w = 0b10000000u << ((3ul - left_bytes) << 3);
-    for (size_t i = 0; i < left_bytes; i++) {
-      w |= static_cast<uint32_t>(data[off + i]) << ((3ul - i) << 3);
-    }
-
-    off += left_bytes;
-
-    const uint32_t br1[2] = { 0, w };
-    const uint32_t br2[2] = { 1, 0 };
-
-    const bool flg1 = static_cast<bool>(word_cnt ^ 4);
-
-    padded_blk[word_cnt - br2[flg1]] ^= br1[to_read < 16];
-
-    std::memcpy(tmp, y, sizeof(tmp));
-    gift_cofb_common::feedback(tmp);
-
-    padded_blk[0] ^= tmp[0] ^ l[0];
-    padded_blk[1] ^= tmp[1] ^ l[1];
-    padded_blk[2] ^= tmp[2];
-    padded_blk[3] ^= tmp[3];
-
-    gift::initialize(&st, padded_blk, key);
-    gift::permute<gift::ROUNDS>(&st);
-
-    std::memcpy(y, st.cipher, sizeof(y));
+    GIFT_COFB_PROBE_PHASE(AD, tot_blk_cnt);
   }
 
   if (ctlen > 0) {
-    const size_t full_blk_cnt = ctlen >> 4;
-    const size_t rm_bytes = ctlen & 15;
-
-    constexpr size_t br0[2] = { 0, 1 };
-    const bool flg0 = (ctlen == 0) | (rm_bytes > 0);
-
-    const size_t tot_blk_cnt = full_blk_cnt + br0[flg0];
+    const size_t tot_blk_cnt = (ctlen + 15) >> 4;
 
     size_t off = 0;
-    for (size_t i = 0; i < tot_blk_cnt - 1; i++) {
-      gift_cofb_common::lx2(l);
+    for (size_t i = 0; i < tot_blk_cnt - 1; i += LADDER) {
+      const size_t cnt = std::min(LADDER, tot_blk_cnt - 1 - i);
+      fill_ladder(&ldr, l, cnt);
 
-      uint32_t eblk[4];
-      uint32_t dblk[4];
+      for (size_t j = 0; j < cnt; j++) {
+        const block_t blk = load_block(enc + off) ^ y;
+        store_block(blk, txt + off);
+        y = absorb(y, ldr.rungs[j], blk, kst);
 
-      for (size_t j = 0; j < 4; j++) {
-        const size_t boff = j << 2;
-
-        eblk[j] = (static_cast<uint32_t>(enc[off + (boff ^ 0)]) << 24) |
-                  (static_cast<uint32_t>(enc[off + (boff ^ 1)]) << 16) |
-                  (static_cast<uint32_t>(enc[off + (boff ^ 2)]) << 8) |
-                  (static_cast<uint32_t>(enc[off + (boff ^ 3)]) << 0);
-
-        dblk[j] = eblk[j] ^ y[j];
-
-        txt[off + (boff ^ 0)] = static_cast<uint8_t>(dblk[j] >> 24);
-        txt[off + (boff ^ 1)] = static_cast<uint8_t>(dblk[j] >> 16);
-        txt[off + (boff ^ 2)] = static_cast<uint8_t>(dblk[j] >> 8);
-        txt[off + (boff ^ 3)] = static_cast<uint8_t>(dblk[j] >> 0);
+        off += 16;
       }
 
-      off += 16;
-
-      std::memcpy(tmp, y, sizeof(tmp));
-      gift_cofb_common::feedback(tmp);
-
-      dblk[0] ^= tmp[0] ^ l[0];
-      dblk[1] ^= tmp[1] ^ l[1];
-      dblk[2] ^= tmp[2];
-      dblk[3] ^= tmp[3];
-
-      gift::initialize(&st, dblk, key);
-      gift::permute<gift::ROUNDS>(&st);
-
-      std::memcpy(y, st.cipher, sizeof(y));
+      l = ldr.rungs[cnt - 1];
     }
 
-    if (rm_bytes == 0) {
-      gift_cofb_common::lx3(l);
+    GIFT_COFB_PROBE_PHASE(MSG, tot_blk_cnt - 1);
+
+    if ((ctlen & 15) == 0) {
+      l = lx3(l);
     } else {
-      gift_cofb_common::lx3(l);
-      gift_cofb_common::lx3(l);
+      l = lx3(lx3(l));
     }
 
-    uint32_t epadded_blk[4];
-    uint32_t dpadded_blk[4];
-
-    std::memset(epadded_blk, 0, sizeof(epadded_blk));
-    std::memset(dpadded_blk, 0, sizeof(dpadded_blk));
-
+    // Line 25 of decryption algorithm in figure 2.3 of GIFT-COFB specification
+    // i.e. last, possibly partial, decrypted block is truncated and padded
+    // before it's absorbed
     const size_t to_read = ctlen - off;
+    const block_t blk = load_partial(enc + off, to_read) ^ y;
+    store_partial(blk, txt + off, to_read);
+    y = absorb(y, l, pad(blk, to_read), kst);
 
-    const size_t word_cnt = to_read >> 2;
-    const size_t left_bytes = to_read & 3;
-
-    for (size_t i = 0; i < word_cnt; i++) {
-      const size_t boff = i << 2;
-
-      epadded_blk[i] = (static_cast<uint32_t>(enc[off + (boff ^ 0)]) << 24) |
-                       (static_cast<uint32_t>(enc[off + (boff ^ 1)]) << 16) |
-                       (static_cast<uint32_t>(enc[off + (boff ^ 2)]) << 8) |
-                       (static_cast<uint32_t>(enc[off + (boff ^ 3)]) << 0);
-    }
+    GIFT_COFB_PROBE_PHASE(TAIL, 1);
+  }
+#endif
 
-    off += word_cnt << 2;
+  const bool flg = tag_mismatch(y, tag) != 0;
 
-    uint32_t w = 0b10000000u << ((3ul - left_bytes) << 3);
-    for (size_t i = 0; i < left_bytes; i++) {
-      w |= static_cast<uint32_t>(enc[off + i]) << ((3ul - i) << 3);
+  if constexpr (release == ZEROISE) {
+    if (flg) [[unlikely]] {
+      std::memset(txt, 0, ctlen);
     }
+  }
 
-    off -= word_cnt << 2;
-
-    const uint32_t br1[2] = { 0, w };
-    const uint32_t br2[2] = { 1, 0 };
-
-    const bool flg1 = static_cast<bool>(word_cnt ^ 4);
-
-    epadded_blk[word_cnt - br2[flg1]] ^= br1[to_read < 16];
-
-    for (size_t i = 0; i < 4; i++) {
-      dpadded_blk[i] = epadded_blk[i] ^ y[i];
-    }
+  GIFT_COFB_PROBE_VERIFY(flg);
+  GIFT_COFB_PROBE_PHASE(TAG, 0);
 
-    for (size_t i = 0; i < to_read; i++) {
-      const size_t woff = i >> 2;
-      const size_t boff = i & 3;
-      const size_t soff = (3 - boff) << 3;
+  return !flg;
+}
 
-      txt[off + i] = static_cast<uint8_t>(dpadded_blk[woff] >> soff);
-    }
+#if defined GIFT_COFB_COMPILED
 
-    // Line 25 of decryption algorithm in figure 2.3 of GIFT-COFB specification
-    // https://csrc.nist.gov/CSRC/media/Projects/lightweight-cryptography/documents/finalist-round/updated-spec-doc/gift-cofb-spec-final.pdf
-    //
-    // Implements truncation ( skipped, because not required ) and padding logic
+// Both variants of `decrypt`, which are instantiated only in compiled library,
+// see `linkage.hpp`
+#define GIFT_COFB_DECRYPT(release)                                             \
+  GIFT_COFB_EXTERN template bool decrypt<release>(const uint8_t*,              \
+                                                  const uint8_t*,              \
+                                                  const uint8_t*,              \
+                                                  const uint8_t*,              \
+                                                  const size_t,                \
+                                                  const uint8_t*,              \
+                                                  uint8_t*,                    \
+                                                  const size_t)
 
-    std::memset(dpadded_blk + word_cnt, 0, (4 - word_cnt) << 2);
-    off += word_cnt << 2;
+GIFT_COFB_DECRYPT(ZEROISE);
+GIFT_COFB_DECRYPT(KEEP);
 
-    uint32_t w_ = 0b10000000u << ((3ul - left_bytes) << 3);
-    for (size_t i = 0; i < left_bytes; i++) {
-      w_ |= static_cast<uint32_t>(txt[off + i]) << ((3ul - i) << 3);
-    }
+#undef GIFT_COFB_DECRYPT
 
-    off -= word_cnt << 2;
+#endif
 
-    const uint32_t br3[2] = { 0, w_ };
+// Byte length of authentication tag, which is appended to encrypted text, in
+// attached tag format
+constexpr size_t TAG_LEN = 16;
 
-    dpadded_blk[word_cnt - br2[flg1]] ^= br3[to_read < 16];
+// Byte length of header, which is prepended to encrypted text || tag, in length
+// prefixed attached tag format, holding byte length of encrypted text || tag as
+// 32 -bit big-endian unsigned integer
+constexpr size_t HEADER_LEN = 4;
 
-    // --- truncation/ padding ends ---
+// Given 128 -bit secret key, 128 -bit public message nonce, N -bytes associated
+// data and M -bytes plain text | N, M >= 0, this routine encrypts plain text,
+// writing M -bytes encrypted text, immediately followed by 128 -bit
+// authentication tag, into single ( M + 16 ) -bytes output buffer, so that it
+// can be put on wire as it's
+//
+// Plain text may live at beginning of output buffer ( i.e. in-place )
+GIFT_COFB_INLINE void
+seal(const uint8_t* const __restrict key,   // 128 -bit key
+     const uint8_t* const __restrict nonce, // 128 -bit nonce
+     const uint8_t* const __restrict data,  // N -bytes associated data
+     const size_t dlen,                     // len(data) | >= 0
+     const uint8_t* const txt,              // M -bytes plain text
+     const size_t ctlen,                    // len(txt) | >= 0
+     uint8_t* const out                     // (M + 16) -bytes enc || tag
+)
+{
+  encrypt(key, nonce, data, dlen, txt, out, ctlen, out + ctlen);
+}
 
-    std::memcpy(tmp, y, sizeof(tmp));
-    gift_cofb_common::feedback(tmp);
+// Given 128 -bit secret key, 128 -bit public message nonce, N -bytes associated
+// data and ( M + 16 ) -bytes encrypted text || authentication tag | N, M >= 0,
+// this routine decrypts encrypted text into M -bytes output buffer, returning
+// boolean verification flag; input shorter than 16 -bytes fails verification
+//
+// Decrypted text may be written over encrypted text ( i.e. in-place ), in which
+// case only first M -bytes of input buffer are overwritten
+GIFT_COFB_INLINE bool
+open(const uint8_t* const __restrict key,   // 128 -bit key
+     const uint8_t* const __restrict nonce, // 128 -bit nonce
+     const uint8_t* const __restrict data,  // N -bytes associated data
+     const size_t dlen,                     // len(data) | >= 0
+     const uint8_t* const in,               // (M + 16) -bytes enc || tag
+     const size_t inlen,                    // len(in) = M + 16
+     uint8_t* const txt                     // M -bytes decrypted text
+)
+{
+  if (inlen < TAG_LEN) {
+    return false;
+  }
 
-    dpadded_blk[0] ^= tmp[0] ^ l[0];
-    dpadded_blk[1] ^= tmp[1] ^ l[1];
-    dpadded_blk[2] ^= tmp[2];
-    dpadded_blk[3] ^= tmp[3];
+  const size_t ctlen = inlen - TAG_LEN;
+  return decrypt(key, nonce, in + ctlen, data, dlen, in, txt, ctlen);
+}
 
-    gift::initialize(&st, dpadded_blk, key);
-    gift::permute<gift::ROUNDS>(&st);
+// Same as `seal`, but output is prefixed with 4 -bytes header, holding byte
+// length of rest of the frame ( = M + 16 ), so that frames can be written back
+// to back on stream, returning total byte length of frame ( = M + 20 ) or 0 if
+// M + 16 doesn't fit in 32 -bit header
+//
+// Plain text may live right after header, in output buffer ( i.e. in-place )
+GIFT_COFB_INLINE size_t
+seal_framed(const uint8_t* const __restrict key,   // 128 -bit key
+            const uint8_t* const __restrict nonce, // 128 -bit nonce
+            const uint8_t* const __restrict data,  // N -bytes associated data
+            const size_t dlen,                     // len(data) | >= 0
+            const uint8_t* const txt,              // M -bytes plain text
+            const size_t ctlen,                    // len(txt) | >= 0
+            uint8_t* const out // (M + 20) -bytes header || enc || tag
+)
+{
+  const size_t body_len = ctlen + TAG_LEN;
+  if (body_len > UINT32_MAX) {
+    return 0;
+  }
 
-    std::memcpy(y, st.cipher, sizeof(y));
+  for (size_t i = 0; i < HEADER_LEN; i++) {
+    out[i] = static_cast<uint8_t>(body_len >> ((HEADER_LEN - 1 - i) << 3));
   }
 
-  uint8_t tag_[16];
+  seal(key, nonce, data, dlen, txt, ctlen, out + HEADER_LEN);
+  return HEADER_LEN + body_len;
+}
 
-  for (size_t i = 0; i < 4; i++) {
-    const size_t boff = i << 2;
+// Same as `open`, but input is a frame produced by `seal_framed`, whose header
+// must agree with byte length of input; on success, writes byte length of
+// decrypted text ( = M ) and returns true, otherwise frame is rejected without
+// being decrypted ( if header is malformed ) or decrypted text is zeroed
+//
+// Decrypted text may be written right after header, in input buffer ( i.e.
+// in-place )
+GIFT_COFB_INLINE bool
+open_framed(const uint8_t* const __restrict key,   // 128 -bit key
+            const uint8_t* const __restrict nonce, // 128 -bit nonce
+            const uint8_t* const __restrict data,  // N -bytes associated data
+            const size_t dlen,                     // len(data) | >= 0
+            const uint8_t* const in, // (M + 20) -bytes header || enc || tag
+            const size_t inlen,      // len(in) = M + 20
+            uint8_t* const txt,      // M -bytes decrypted text
+            size_t* const ctlen      // M, on success
+)
+{
+  *ctlen = 0;
 
-    tag_[boff ^ 0] = static_cast<uint8_t>(y[i] >> 24);
-    tag_[boff ^ 1] = static_cast<uint8_t>(y[i] >> 16);
-    tag_[boff ^ 2] = static_cast<uint8_t>(y[i] >> 8);
-    tag_[boff ^ 3] = static_cast<uint8_t>(y[i] >> 0);
+  if (inlen < HEADER_LEN + TAG_LEN) {
+    return false;
   }
 
-  bool flg = false;
+  size_t body_len = 0;
+  for (size_t i = 0; i < HEADER_LEN; i++) {
+    body_len = (body_len << 8) | static_cast<size_t>(in[i]);
+  }
 
-  for (size_t i = 0; i < 16; i++) {
-    flg |= static_cast<bool>(tag[i] ^ tag_[i]);
+  if (body_len != inlen - HEADER_LEN) {
+    return false;
   }
 
-  std::memset(txt, 0, flg * ctlen);
-  return !flg;
+  const bool flg = open(key, nonce, data, dlen, in + HEADER_LEN, body_len, txt);
+  *ctlen = flg ? body_len - TAG_LEN : 0;
+
+  return flg;
 }
 
 }
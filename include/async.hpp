@@ -0,0 +1,330 @@
+#pragma once
+#include "aead.hpp"
+#include "batch.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Asynchronous GIFT-COFB API, where seal/ open requests are handed to an
+// executor, whose worker threads coalesce requests submitted within a short
+// time window into batches ( run through batch API ), completing each request
+// by resuming awaiting coroutine, fulfilling future or invoking callback
+namespace gift_cofb_async {
+
+// One record to be sealed/ opened, whose buffers must stay alive until request
+// completes; for sealing, `tag` is written, while for opening, it's read
+struct job_t
+{
+  const uint8_t* key;   // 128 -bit secret key
+  const uint8_t* nonce; // 128 -bit nonce
+  const uint8_t* data;  // N -bytes associated data
+  size_t dlen;
+  const uint8_t* in; // M -bytes plain/ cipher text
+  uint8_t* out;      // M -bytes cipher/ plain text, can be same as `in`
+  size_t ctlen;
+  uint8_t* tag; // 128 -bit authentication tag
+};
+
+// Submitted request, whose `done` callback is invoked on executor's worker
+// thread, once `ok` is set; callers embed it in their own state ( awaiter,
+// future holder or anything else ), so that executor never allocates per
+// request
+struct request_t
+{
+  job_t job;
+  bool opening = false;
+  bool ok = false;
+  void (*done)(request_t*) = nullptr;
+};
+
+// Executor, whose worker threads wait for at max `window` after first request
+// of batch arrives ( or until `max_batch` -many requests are pending ), then
+// take all pending requests ( at max `max_batch` of them ) and seal/ open them
+// as one batch
+//
+// Zero window doesn't wait at all, but still coalesces requests which are
+// already pending, when a worker becomes free
+struct executor_t
+{
+  using clock = std::chrono::steady_clock;
+
+  explicit executor_t(const std::chrono::microseconds window,
+                      const size_t max_batch = 1024,
+                      const size_t workers = 1)
+    : window(window)
+    , max_batch(max_batch == 0 ? 1 : max_batch)
+  {
+    for (size_t i = 0; i < workers; i++) {
+      threads.emplace_back([this]() { work(); });
+    }
+  }
+
+  executor_t(const executor_t&) = delete;
+  executor_t& operator=(const executor_t&) = delete;
+
+  // Completes all pending requests, before joining worker threads
+  ~executor_t()
+  {
+    {
+      std::lock_guard<std::mutex> lk(mtx);
+      stopping = true;
+    }
+
+    cv.notify_all();
+    for (auto& t : threads) {
+      t.join();
+    }
+  }
+
+  // Submits request, which must stay alive until its `done` callback returns
+  inline void submit(request_t* const req)
+  {
+    bool wake = false;
+
+    {
+      std::lock_guard<std::mutex> lk(mtx);
+
+      if (pending.empty()) {
+        first_at = clock::now();
+      }
+      pending.push_back(req);
+
+      wake = pending.size() == 1 || pending.size() >= max_batch;
+    }
+
+    if (wake) {
+      cv.notify_one();
+    }
+  }
+
+  // Number of batches run so far, along with number of requests in them
+  inline std::pair<uint64_t, uint64_t> stats()
+  {
+    std::lock_guard<std::mutex> lk(mtx);
+    return { batches, records };
+  }
+
+private:
+  const std::chrono::microseconds window;
+  const size_t max_batch;
+
+  std::mutex mtx;
+  std::condition_variable cv;
+  std::vector<request_t*> pending;
+  clock::time_point first_at;
+  bool stopping = false;
+  uint64_t batches = 0;
+  uint64_t records = 0;
+
+  std::vector<std::thread> threads;
+
+  // Worker loop, taking batches of pending requests, until executor is stopped
+  // and nothing is pending
+  inline void work()
+  {
+    // job descriptors take < 128 -bytes per record, besides padding of arrays
+    const size_t desc_len = max_batch * 128 + 16 * gift_cofb_batch::ALIGN;
+    gift_cofb_batch::arena_t arena(2 * desc_len);
+    gift_cofb_batch::jobs_t seals, opens;
+
+    const bool made = gift_cofb_batch::make_jobs(&arena, max_batch, &seals) &
+                      gift_cofb_batch::make_jobs(&arena, max_batch, &opens);
+
+    std::vector<uint8_t> keys(max_batch << 4);
+    std::vector<request_t*> batch;
+
+    std::unique_lock<std::mutex> lk(mtx);
+
+    while (true) {
+      cv.wait(lk, [&]() { return stopping || !pending.empty(); });
+      if (pending.empty()) {
+        break;
+      }
+
+      cv.wait_until(lk, first_at + window, [&]() {
+        return stopping || pending.size() >= max_batch;
+      });
+
+      // someone else may have taken pending requests, while waiting
+      if (pending.empty()) {
+        continue;
+      }
+
+      const size_t cnt = std::min(pending.size(), max_batch);
+
+      batch.assign(pending.begin(), pending.begin() + cnt);
+      pending.erase(pending.begin(), pending.begin() + cnt);
+
+      batches++;
+      records += cnt;
+
+      lk.unlock();
+
+      if (made) {
+        run(batch, keys.data(), &seals, &opens);
+      } else {
+        run_serial(batch);
+      }
+
+      for (request_t* const req : batch) {
+        req->done(req);
+      }
+
+      lk.lock();
+    }
+  }
+
+  // Seals/ opens batch of requests through batch API, copying secret keys into
+  // one array, referred to by index from job descriptors
+  inline static void run(const std::vector<request_t*>& batch,
+                         uint8_t* const keys,
+                         gift_cofb_batch::jobs_t* const seals,
+                         gift_cofb_batch::jobs_t* const opens)
+  {
+    seals->cnt = 0;
+    opens->cnt = 0;
+
+    for (size_t i = 0; i < batch.size(); i++) {
+      const job_t& j = batch[i]->job;
+      const uint32_t kidx = static_cast<uint32_t>(i);
+
+      std::memcpy(keys + (i << 4), j.key, 16);
+
+      if (batch[i]->opening) {
+        gift_cofb_batch::push(
+          opens, kidx, j.nonce, j.data, j.dlen, j.in, j.out, j.ctlen, j.tag);
+      } else {
+        gift_cofb_batch::push(
+          seals, kidx, j.nonce, j.data, j.dlen, j.in, j.out, j.ctlen, nullptr);
+      }
+    }
+
+    gift_cofb_batch::encrypt(keys, seals);
+    gift_cofb_batch::decrypt(keys, opens);
+
+    size_t si = 0, oi = 0;
+    for (request_t* const req : batch) {
+      if (req->opening) {
+        req->ok = opens->ok[oi++];
+      } else {
+        std::memcpy(req->job.tag, seals->tags + (si << 4), 16);
+        req->ok = seals->ok[si++];
+      }
+    }
+  }
+
+  // Seals/ opens batch of requests one after another, used only when arena
+  // couldn't be allocated
+  inline static void run_serial(const std::vector<request_t*>& batch)
+  {
+    for (request_t* const req : batch) {
+      const job_t& j = req->job;
+
+      if (req->opening) {
+        req->ok = gift_cofb::decrypt(
+          j.key, j.nonce, j.tag, j.data, j.dlen, j.in, j.out, j.ctlen);
+      } else {
+        gift_cofb::encrypt(
+          j.key, j.nonce, j.data, j.dlen, j.in, j.out, j.ctlen, j.tag);
+        req->ok = true;
+      }
+    }
+  }
+};
+
+// Awaitable seal/ open request, which submits itself to executor when awaited
+// and resumes awaiting coroutine, on executor's worker thread, once done,
+// producing verification flag ( always true for sealing )
+struct awaitable_t : request_t
+{
+  executor_t* ex;
+  std::coroutine_handle<> caller;
+
+  awaitable_t(executor_t* const e, const job_t& j, const bool opening)
+    : ex(e)
+  {
+    this->job = j;
+    this->opening = opening;
+    this->done = [](request_t* const r) {
+      static_cast<awaitable_t*>(r)->caller.resume();
+    };
+  }
+
+  inline bool await_ready() const noexcept { return false; }
+
+  inline void await_suspend(std::coroutine_handle<> h)
+  {
+    caller = h;
+    ex->submit(this);
+  }
+
+  inline bool await_resume() const noexcept { return this->ok; }
+};
+
+// Seals record asynchronously i.e. `co_await async_seal(ex, job)`
+inline static awaitable_t
+async_seal(executor_t& ex, const job_t& job)
+{
+  return awaitable_t(&ex, job, false);
+}
+
+// Opens record asynchronously i.e. `bool ok = co_await async_open(ex, job)`
+inline static awaitable_t
+async_open(executor_t& ex, const job_t& job)
+{
+  return awaitable_t(&ex, job, true);
+}
+
+// Request, owning promise of its verification flag, which frees itself once
+// done
+struct promised_t : request_t
+{
+  std::promise<bool> promise;
+};
+
+// Submits seal/ open request, returning future of its verification flag
+inline static std::future<bool>
+submit_future(executor_t& ex, const job_t& job, const bool opening)
+{
+  promised_t* const req = new promised_t;
+
+  req->job = job;
+  req->opening = opening;
+  req->done = [](request_t* const r) {
+    promised_t* const p = static_cast<promised_t*>(r);
+
+    p->promise.set_value(p->ok);
+    delete p;
+  };
+
+  std::future<bool> fut = req->promise.get_future();
+  ex.submit(req);
+
+  return fut;
+}
+
+// Seals record asynchronously, returning future, which becomes ready once
+// cipher text and tag are written
+inline static std::future<bool>
+seal_future(executor_t& ex, const job_t& job)
+{
+  return submit_future(ex, job, false);
+}
+
+// Opens record asynchronously, returning future of its verification flag
+inline static std::future<bool>
+open_future(executor_t& ex, const job_t& job)
+{
+  return submit_future(ex, job, true);
+}
+
+}
@@ -0,0 +1,270 @@
+#pragma once
+#include "aead.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#if defined __linux__
+#include <sys/mman.h>
+#endif
+
+// Batch GIFT-COFB API, where many ( small ) records are described by structure
+// of arrays job descriptors, whose arrays and input/ output slabs are carved
+// out of one reusable arena, so that no heap allocation happens per record
+namespace gift_cofb_batch {
+
+// Alignment of every allocation made from arena i.e. one cache line
+constexpr size_t ALIGN = 64;
+
+// Huge page size, to which arena backed by huge pages is rounded up
+constexpr size_t HUGE_PAGE = 1ul << 21;
+
+// Rounds N up to next multiple of power of 2 alignment A
+inline static constexpr size_t
+round_up(const size_t n, const size_t a)
+{
+  return (n + (a - 1)) & ~(a - 1);
+}
+
+// Bump allocator over one contiguous memory region, which hands out cache-line
+// aligned slabs and is reset, between batches, in O(1), by rewinding its offset
+//
+// On Linux, arena can be requested to be backed by huge pages, reducing TLB
+// pressure of large batches; explicit huge pages are tried first, falling back
+// to transparent huge pages and then to regular pages, so `huge` is only a hint
+struct arena_t
+{
+  uint8_t* base = nullptr;
+  size_t cap = 0;
+  size_t used = 0;
+  bool mapped = false;
+
+  explicit arena_t(const size_t bytes, const bool huge = false)
+  {
+    const size_t align = huge ? HUGE_PAGE : ALIGN;
+
+    // length which would wrap around, when rounded up, leaves arena empty
+    if (bytes > SIZE_MAX - (align - 1)) {
+      return;
+    }
+
+    cap = round_up(bytes, align);
+
+#if defined __linux__
+    constexpr int prot = PROT_READ | PROT_WRITE;
+    constexpr int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+
+    void* ptr = MAP_FAILED;
+    if (huge) {
+      ptr = mmap(nullptr, cap, prot, flags | MAP_HUGETLB, -1, 0);
+    }
+    if (ptr == MAP_FAILED) {
+      ptr = mmap(nullptr, cap, prot, flags, -1, 0);
+
+      if (huge && ptr != MAP_FAILED) {
+        madvise(ptr, cap, MADV_HUGEPAGE);
+      }
+    }
+
+    if (ptr != MAP_FAILED) {
+      base = static_cast<uint8_t*>(ptr);
+      mapped = true;
+      return;
+    }
+#endif
+
+    base = static_cast<uint8_t*>(std::aligned_alloc(ALIGN, cap));
+    cap = base == nullptr ? 0 : cap;
+  }
+
+  arena_t(const arena_t&) = delete;
+  arena_t& operator=(const arena_t&) = delete;
+
+  ~arena_t()
+  {
+#if defined __linux__
+    if (mapped) {
+      munmap(base, cap);
+      return;
+    }
+#endif
+
+    std::free(base);
+  }
+
+  // Hands out N -bytes slab, aligned to cache line, returning null pointer if
+  // arena doesn't have enough space left | N >= 0
+  //
+  // Length is checked before it's rounded up, so that huge ones can't wrap
+  // around to a small slab
+  inline uint8_t* alloc(const size_t len)
+  {
+    if (len > cap - used) {
+      return nullptr;
+    }
+
+    const size_t need = round_up(len, ALIGN);
+
+    if (need > cap - used) {
+      return nullptr;
+    }
+
+    uint8_t* const ptr = base + used;
+    used += need;
+
+    return ptr;
+  }
+
+  // Hands out slab for N -many objects of type T, returning null pointer if
+  // arena doesn't have enough space left or N x sizeof(T) overflows | N >= 0
+  template<typename T>
+  inline T* alloc_n(const size_t cnt)
+  {
+    if (cnt > SIZE_MAX / sizeof(T)) {
+      return nullptr;
+    }
+
+    return reinterpret_cast<T*>(alloc(cnt * sizeof(T)));
+  }
+
+  // Releases all slabs at once, so that arena can be reused for next batch
+  inline void reset() { used = 0; }
+};
+
+// Structure of arrays job descriptors, where i -th element of each array
+// describes i -th record of batch; secret keys are not copied per record, but
+// referred to by index into caller's array of keys
+//
+// For encryption, `in` points to plain text, `out` to cipher text and `tags`
+// are written; for decryption, `in` points to cipher text, `out` to decrypted
+// text, `tags` are read and `ok` holds verification flags
+struct jobs_t
+{
+  size_t cnt = 0;
+  size_t cap = 0;
+
+  uint32_t* key_idx = nullptr; // index of 128 -bit secret key
+  uint8_t* nonces = nullptr;   // cap x 128 -bit nonce
+  const uint8_t** data = nullptr;
+  size_t* dlen = nullptr;
+  const uint8_t** in = nullptr;
+  uint8_t** out = nullptr;
+  size_t* ctlen = nullptr;
+  uint8_t* tags = nullptr; // cap x 128 -bit authentication tag
+  bool* ok = nullptr;
+};
+
+// Carves arrays of job descriptors, for at max N records, out of arena,
+// returning false if arena doesn't have enough space left | N > 0
+inline static bool
+make_jobs(arena_t* const arena, const size_t cap, jobs_t* const jobs)
+{
+  jobs->cnt = 0;
+  jobs->cap = cap;
+
+  // byte length of nonce/ tag arrays, saturated so that huge N can't wrap
+  // around to a short slab
+  const size_t blk_len = cap > SIZE_MAX / 16 ? SIZE_MAX : cap << 4;
+
+  jobs->key_idx = arena->alloc_n<uint32_t>(cap);
+  jobs->nonces = arena->alloc_n<uint8_t>(blk_len);
+  jobs->data = arena->alloc_n<const uint8_t*>(cap);
+  jobs->dlen = arena->alloc_n<size_t>(cap);
+  jobs->in = arena->alloc_n<const uint8_t*>(cap);
+  jobs->out = arena->alloc_n<uint8_t*>(cap);
+  jobs->ctlen = arena->alloc_n<size_t>(cap);
+  jobs->tags = arena->alloc_n<uint8_t>(blk_len);
+  jobs->ok = arena->alloc_n<bool>(cap);
+
+  return (jobs->key_idx != nullptr) & (jobs->nonces != nullptr) &
+         (jobs->data != nullptr) & (jobs->dlen != nullptr) &
+         (jobs->in != nullptr) & (jobs->out != nullptr) &
+         (jobs->ctlen != nullptr) & (jobs->tags != nullptr) &
+         (jobs->ok != nullptr);
+}
+
+// Appends one record to batch, copying its nonce ( and tag, if given i.e. for
+// decryption ) into job descriptors, returning its index in batch or `cap`, if
+// batch is already full
+inline static size_t
+push(jobs_t* const __restrict jobs,
+     const uint32_t key_idx,
+     const uint8_t* const __restrict nonce, // 128 -bit nonce
+     const uint8_t* const __restrict data,  // N -bytes associated data
+     const size_t dlen,                     // len(data) | >= 0
+     const uint8_t* const __restrict in,    // M -bytes plain/ cipher text
+     uint8_t* const __restrict out,         // M -bytes cipher/ plain text
+     const size_t ctlen,                    // len(in) = len(out) | >= 0
+     const uint8_t* const __restrict tag    // 128 -bit tag, can be null
+)
+{
+  if (jobs->cnt == jobs->cap) {
+    return jobs->cap;
+  }
+
+  const size_t i = jobs->cnt++;
+
+  jobs->key_idx[i] = key_idx;
+  std::memcpy(jobs->nonces + (i << 4), nonce, 16);
+  jobs->data[i] = data;
+  jobs->dlen[i] = dlen;
+  jobs->in[i] = in;
+  jobs->out[i] = out;
+  jobs->ctlen[i] = ctlen;
+  jobs->ok[i] = false;
+
+  if (tag != nullptr) {
+    std::memcpy(jobs->tags + (i << 4), tag, 16);
+  }
+
+  return i;
+}
+
+// Encrypts every record of batch, writing cipher text to `out` slots and
+// authentication tags to `tags` array of job descriptors
+inline static void
+encrypt(const uint8_t* const __restrict keys, // K x 128 -bit secret keys
+        jobs_t* const __restrict jobs)
+{
+  for (size_t i = 0; i < jobs->cnt; i++) {
+    gift_cofb::encrypt(keys + (static_cast<size_t>(jobs->key_idx[i]) << 4),
+                       jobs->nonces + (i << 4),
+                       jobs->data[i],
+                       jobs->dlen[i],
+                       jobs->in[i],
+                       jobs->out[i],
+                       jobs->ctlen[i],
+                       jobs->tags + (i << 4));
+
+    jobs->ok[i] = true;
+  }
+}
+
+// Decrypts every record of batch, writing decrypted text to `out` slots and
+// verification flags to `ok` array of job descriptors, returning number of
+// records which failed verification
+inline static size_t
+decrypt(const uint8_t* const __restrict keys, // K x 128 -bit secret keys
+        jobs_t* const __restrict jobs)
+{
+  size_t failed = 0;
+
+  for (size_t i = 0; i < jobs->cnt; i++) {
+    jobs->ok[i] =
+      gift_cofb::decrypt(keys + (static_cast<size_t>(jobs->key_idx[i]) << 4),
+                         jobs->nonces + (i << 4),
+                         jobs->tags + (i << 4),
+                         jobs->data[i],
+                         jobs->dlen[i],
+                         jobs->in[i],
+                         jobs->out[i],
+                         jobs->ctlen[i]);
+
+    failed += !jobs->ok[i];
+  }
+
+  return failed;
+}
+
+}
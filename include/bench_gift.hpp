@@ -1,7 +1,10 @@
 #pragma once
-#include "gift.hpp"
+#include "bench_perf.hpp"
+#include "modes.hpp"
+#include "reduced.hpp"
 #include "utils.hpp"
 #include <benchmark/benchmark.h>
+#include <vector>
 
 // Benchmark GIFT-COFB Authenticated Encryption on CPU
 namespace bench_gift_cofb {
@@ -23,6 +26,8 @@ gift_permute(benchmark::State& state)
   gift::state_t st;
   gift::initialize(&st, txt, key);
 
+  bench_perf::scope_t perf(state);
+
   for (auto _ : state) {
     gift::permute<R>(&st);
 
@@ -36,4 +41,381 @@ gift_permute(benchmark::State& state)
   std::free(key);
 }
 
+// Benchmark inverse GIFT-128 permutation ( R -rounds ) on CPU, using
+// precomputed round keys, by generating 128 -bit random cipher text and secret
+// key | R <= 40
+template<const size_t R>
+static void
+gift_inverse_permute(benchmark::State& state)
+{
+  constexpr size_t N = 16;
+
+  uint8_t* enc = static_cast<uint8_t*>(std::malloc(N));
+  uint8_t* key = static_cast<uint8_t*>(std::malloc(N));
+
+  random_data(enc, N);
+  random_data(key, N);
+
+  gift::state_t st;
+  gift::initialize(&st, enc, key);
+
+  gift::round_keys_t rk;
+  gift::expand_key(&rk, key);
+
+  bench_perf::scope_t perf(state);
+
+  for (auto _ : state) {
+    gift::inverse_permute<R>(&st, &rk);
+
+    benchmark::DoNotOptimize(st);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(N * state.iterations()));
+
+  std::free(enc);
+  std::free(key);
+}
+
+// Benchmark GIFT-128 CBC mode encryption on CPU, with variable number of
+// 128 -bit plain text blocks
+static void
+cbc_encrypt(benchmark::State& state)
+{
+  constexpr size_t N = 16;
+
+  const size_t blk_cnt = state.range(0);
+  const size_t len = blk_cnt * N;
+
+  uint8_t* key = static_cast<uint8_t*>(std::malloc(N));
+  uint8_t* iv = static_cast<uint8_t*>(std::malloc(N));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(len));
+  uint8_t* enc = static_cast<uint8_t*>(std::malloc(len));
+
+  random_data(key, N);
+  random_data(iv, N);
+  random_data(txt, len);
+
+  bench_perf::scope_t perf(state);
+
+  for (auto _ : state) {
+    gift_modes::cbc_encrypt(key, iv, txt, enc, blk_cnt);
+
+    benchmark::DoNotOptimize(enc);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(len * state.iterations()));
+
+  std::free(key);
+  std::free(iv);
+  std::free(txt);
+  std::free(enc);
+}
+
+// Benchmark GIFT-128 CBC mode decryption on CPU, with variable number of
+// 128 -bit cipher text blocks, which are decrypted in parallel
+static void
+cbc_decrypt(benchmark::State& state)
+{
+  constexpr size_t N = 16;
+
+  const size_t blk_cnt = state.range(0);
+  const size_t len = blk_cnt * N;
+
+  uint8_t* key = static_cast<uint8_t*>(std::malloc(N));
+  uint8_t* iv = static_cast<uint8_t*>(std::malloc(N));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(len));
+  uint8_t* enc = static_cast<uint8_t*>(std::malloc(len));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(len));
+
+  random_data(key, N);
+  random_data(iv, N);
+  random_data(txt, len);
+
+  gift_modes::cbc_encrypt(key, iv, txt, enc, blk_cnt);
+
+  bench_perf::scope_t perf(state);
+
+  for (auto _ : state) {
+    gift_modes::cbc_decrypt(key, iv, enc, dec, blk_cnt);
+
+    benchmark::DoNotOptimize(dec);
+    benchmark::ClobberMemory();
+  }
+
+  for (size_t i = 0; i < len; i++) {
+    assert((txt[i] ^ dec[i]) == 0);
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(len * state.iterations()));
+
+  std::free(key);
+  std::free(iv);
+  std::free(txt);
+  std::free(enc);
+  std::free(dec);
+}
+
+// Number of times a building block is applied in each iteration of micro
+// benchmarks below, so that cost of benchmark loop itself is amortized
+constexpr size_t APPLICATIONS = 16;
+
+// Number of independent inputs, a building block is applied on, in each
+// iteration of throughput mode micro benchmarks
+constexpr size_t INDEPENDENT = 8;
+
+// Adds round keys of some fixed round, so that it can be benchmarked same as
+// other building blocks, mutating only GIFT-128 state
+inline static void
+add_round_keys(gift::state_t* const st)
+{
+  gift::add_round_keys(st, gift::ROUNDS >> 1);
+}
+
+// Benchmark a building block of GIFT-128 ( mutating cipher/ key state ) in
+// latency mode i.e. each application consumes output of previous one, forming
+// a dependency chain, so that reported rate is inverse of its latency
+template<void (*op)(gift::state_t* const)>
+static void
+gift_block_latency(benchmark::State& state)
+{
+  constexpr size_t N = 16;
+
+  uint8_t txt[N], key[N];
+  random_data(txt, N);
+  random_data(key, N);
+
+  gift::state_t st;
+  gift::initialize(&st, txt, key);
+
+  bench_perf::scope_t perf(state);
+
+  for (auto _ : state) {
+    for (size_t i = 0; i < APPLICATIONS; i++) {
+      op(&st);
+    }
+
+    benchmark::DoNotOptimize(st);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(
+    static_cast<int64_t>(APPLICATIONS * state.iterations()));
+}
+
+// Benchmark a building block of GIFT-128 ( mutating cipher/ key state ) in
+// throughput mode i.e. it's applied on INDEPENDENT -many states, which have no
+// dependency among them, so that reported rate is its reciprocal throughput
+template<void (*op)(gift::state_t* const)>
+static void
+gift_block_throughput(benchmark::State& state)
+{
+  constexpr size_t N = 16;
+
+  uint8_t txt[N], key[N];
+  gift::state_t st[INDEPENDENT];
+
+  for (size_t i = 0; i < INDEPENDENT; i++) {
+    random_data(txt, N);
+    random_data(key, N);
+
+    gift::initialize(&st[i], txt, key);
+  }
+
+  bench_perf::scope_t perf(state);
+
+  for (auto _ : state) {
+    for (size_t i = 0; i < APPLICATIONS / INDEPENDENT; i++) {
+      for (size_t j = 0; j < INDEPENDENT; j++) {
+        op(&st[j]);
+      }
+    }
+
+    benchmark::DoNotOptimize(st);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(
+    static_cast<int64_t>(APPLICATIONS * state.iterations()));
+}
+
+// Benchmark a building block of GIFT-128, which works on N -many cipher states
+// kept in transposed form ( see `gift::lanes_t` ), reporting number of cipher
+// states processed per second; in latency mode each application consumes output
+// of previous one, while in throughput mode INDEPENDENT -many lane groups are
+// processed
+template<const size_t N, void (*op)(gift::lanes_t<N>* const), const bool chain>
+static void
+gift_lanes_block(benchmark::State& state)
+{
+  constexpr size_t groups = chain ? 1 : INDEPENDENT;
+  constexpr size_t rounds = APPLICATIONS / groups;
+
+  gift::lanes_t<N> st[groups];
+  random_data(reinterpret_cast<uint8_t*>(st), sizeof(st));
+
+  bench_perf::scope_t perf(state);
+
+  for (auto _ : state) {
+    for (size_t i = 0; i < rounds; i++) {
+      for (size_t j = 0; j < groups; j++) {
+        op(&st[j]);
+      }
+    }
+
+    benchmark::DoNotOptimize(st);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(
+    static_cast<int64_t>(APPLICATIONS * N * state.iterations()));
+}
+
+// Benchmark GIFT-128 ECB mode encryption of N -many 128 -bit blocks, LANES at a
+// time, either all of them under one secret key ( whose round keys are
+// expanded once per call ) or each under one of K distinct secret keys ( whose
+// round keys are expanded per lane group, in transposed form ), so that cost
+// of mixing keys in one batch is measured | N, K = state.range(0),
+// state.range(1)
+template<const bool distinct>
+static void
+ecb_keys(benchmark::State& state)
+{
+  constexpr size_t N = 16;
+
+  const size_t blk_cnt = static_cast<size_t>(state.range(0));
+  const size_t key_cnt = static_cast<size_t>(state.range(1));
+  const size_t len = blk_cnt * N;
+
+  std::vector<uint8_t> keys(key_cnt * N);
+  std::vector<uint32_t> key_idx(blk_cnt);
+  std::vector<uint8_t> txt(len);
+  std::vector<uint8_t> enc(len);
+
+  random_data(keys.data(), keys.size());
+  random_data(txt.data(), txt.size());
+
+  for (size_t i = 0; i < blk_cnt; i++) {
+    key_idx[i] = static_cast<uint32_t>(i % key_cnt);
+  }
+
+  bench_perf::scope_t perf(state);
+
+  for (auto _ : state) {
+    if constexpr (distinct) {
+      gift_modes::ecb_encrypt_keys(
+        keys.data(), key_idx.data(), txt.data(), enc.data(), blk_cnt);
+    } else {
+      gift_modes::ecb_encrypt(keys.data(), txt.data(), enc.data(), blk_cnt);
+    }
+
+    benchmark::DoNotOptimize(enc.data());
+    benchmark::ClobberMemory();
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(len * state.iterations()));
+  state.SetItemsProcessed(static_cast<int64_t>(blk_cnt * state.iterations()));
+}
+
+// Benchmark GIFT-128 key schedule of N -many lanes, each with its own secret
+// key, expanded at once in transposed form, reporting keys expanded per second
+template<const size_t N>
+static void
+gift_expand_keys(benchmark::State& state)
+{
+  uint8_t keys[N][16];
+  const uint8_t* ptrs[N];
+
+  random_data(&keys[0][0], sizeof(keys));
+  for (size_t i = 0; i < N; i++) {
+    ptrs[i] = keys[i];
+  }
+
+  gift::lane_keys_t<N> rk;
+
+  bench_perf::scope_t perf(state);
+
+  for (auto _ : state) {
+    gift::expand_keys(&rk, ptrs);
+
+    benchmark::DoNotOptimize(rk);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(static_cast<int64_t>(N * state.iterations()));
+}
+
+// Benchmark bulk evaluation of R rounds of reduced-round GIFT-128, on N -many
+// 128 -bit blocks, all under one secret key, on T threads | R, N, T =
+// state.range(0), state.range(1), state.range(2)
+static void
+reduced_evaluate(benchmark::State& state)
+{
+  const size_t rounds = static_cast<size_t>(state.range(0));
+  const size_t blk_cnt = static_cast<size_t>(state.range(1));
+  const size_t threads = static_cast<size_t>(state.range(2));
+  const size_t len = blk_cnt * 16;
+
+  uint8_t key[16];
+  std::vector<uint8_t> txt(len);
+  std::vector<uint8_t> enc(len);
+
+  random_data(key, sizeof(key));
+  random_data(txt.data(), txt.size());
+
+  gift::round_keys_t rk;
+  gift::expand_key(&rk, key);
+
+  bench_perf::scope_t perf(state);
+
+  for (auto _ : state) {
+    gift_reduced::evaluate(
+      &rk, 0, rounds, txt.data(), enc.data(), blk_cnt, threads);
+
+    benchmark::DoNotOptimize(enc.data());
+    benchmark::ClobberMemory();
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(len * state.iterations()));
+  state.SetItemsProcessed(static_cast<int64_t>(blk_cnt * state.iterations()));
+}
+
+// Benchmark differential sweep over N -many plain text pairs, through R rounds
+// of reduced-round GIFT-128, with one active input nibble and an 8 -bit
+// histogram of output differences, on T threads, reporting pairs per second |
+// R, N, T = state.range(0), state.range(1), state.range(2)
+static void
+reduced_sweep(benchmark::State& state)
+{
+  uint8_t key[16];
+  random_data(key, sizeof(key));
+
+  gift::round_keys_t rk;
+  gift::expand_key(&rk, key);
+
+  gift_reduced::sweep_t sw{};
+  sw.rk = &rk;
+  sw.cnt = static_cast<size_t>(state.range(0));
+  sw.din[3] = 0x00000006u;
+  sw.hist_mask[0] = 0x0000000fu;
+  sw.hist_mask[3] = 0x0000000fu;
+  sw.pairs = static_cast<uint64_t>(state.range(1));
+
+  const size_t threads = static_cast<size_t>(state.range(2));
+  std::vector<uint64_t> hist(gift_reduced::bins(sw));
+
+  bench_perf::scope_t perf(state);
+
+  for (auto _ : state) {
+    gift_reduced::sweep(sw, hist.data(), threads);
+    sw.first += sw.pairs;
+
+    benchmark::DoNotOptimize(hist.data());
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(static_cast<int64_t>(sw.pairs * state.iterations()));
+}
+
 }
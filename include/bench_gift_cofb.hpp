@@ -1,7 +1,13 @@
 #pragma once
 #include "aead.hpp"
+#include "batch.hpp"
+#include "bench_perf.hpp"
+#include "incremental.hpp"
+#include "precompute.hpp"
+#include "selftest.hpp"
 #include "utils.hpp"
 #include <benchmark/benchmark.h>
+#include <vector>
 
 // Benchmark GIFT-COFB Authenticated Encryption on CPU
 namespace bench_gift_cofb {
@@ -16,13 +22,18 @@ encrypt(benchmark::State& state)
   const size_t dlen = state.range(0);
   const size_t ctlen = state.range(1);
 
-  uint8_t* key = static_cast<uint8_t*>(std::malloc(kntlen));
-  uint8_t* nonce = static_cast<uint8_t*>(std::malloc(kntlen));
-  uint8_t* tag = static_cast<uint8_t*>(std::malloc(kntlen));
-  uint8_t* data = static_cast<uint8_t*>(std::malloc(dlen));
-  uint8_t* txt = static_cast<uint8_t*>(std::malloc(ctlen));
-  uint8_t* enc = static_cast<uint8_t*>(std::malloc(ctlen));
-  uint8_t* dec = static_cast<uint8_t*>(std::malloc(ctlen));
+  // all buffers are carved out of one arena, each starting on its own cache
+  // line
+  constexpr size_t align = gift_cofb_batch::ALIGN;
+  gift_cofb_batch::arena_t arena(3 * kntlen + dlen + 3 * ctlen + 7 * align);
+
+  uint8_t* key = arena.alloc(kntlen);
+  uint8_t* nonce = arena.alloc(kntlen);
+  uint8_t* tag = arena.alloc(kntlen);
+  uint8_t* data = arena.alloc(dlen);
+  uint8_t* txt = arena.alloc(ctlen);
+  uint8_t* enc = arena.alloc(ctlen);
+  uint8_t* dec = arena.alloc(ctlen);
 
   random_data(key, kntlen);
   random_data(nonce, kntlen);
@@ -33,6 +44,8 @@ encrypt(benchmark::State& state)
   std::memset(enc, 0, ctlen);
   std::memset(dec, 0, ctlen);
 
+  bench_perf::scope_t perf(state);
+
   for (auto _ : state) {
     gift_cofb::encrypt(key, nonce, data, dlen, txt, enc, ctlen, tag);
 
@@ -53,14 +66,6 @@ encrypt(benchmark::State& state)
   const size_t total_data = per_itr_data * state.iterations();
 
   state.SetBytesProcessed(static_cast<int64_t>(total_data));
-
-  std::free(key);
-  std::free(nonce);
-  std::free(tag);
-  std::free(data);
-  std::free(txt);
-  std::free(enc);
-  std::free(dec);
 }
 
 // Benchmarks GIFT-COFB verified decryption routine on CPU, with variable
@@ -73,13 +78,18 @@ decrypt(benchmark::State& state)
   const size_t dlen = state.range(0);
   const size_t ctlen = state.range(1);
 
-  uint8_t* key = static_cast<uint8_t*>(std::malloc(kntlen));
-  uint8_t* nonce = static_cast<uint8_t*>(std::malloc(kntlen));
-  uint8_t* tag = static_cast<uint8_t*>(std::malloc(kntlen));
-  uint8_t* data = static_cast<uint8_t*>(std::malloc(dlen));
-  uint8_t* txt = static_cast<uint8_t*>(std::malloc(ctlen));
-  uint8_t* enc = static_cast<uint8_t*>(std::malloc(ctlen));
-  uint8_t* dec = static_cast<uint8_t*>(std::malloc(ctlen));
+  // all buffers are carved out of one arena, each starting on its own cache
+  // line
+  constexpr size_t align = gift_cofb_batch::ALIGN;
+  gift_cofb_batch::arena_t arena(3 * kntlen + dlen + 3 * ctlen + 7 * align);
+
+  uint8_t* key = arena.alloc(kntlen);
+  uint8_t* nonce = arena.alloc(kntlen);
+  uint8_t* tag = arena.alloc(kntlen);
+  uint8_t* data = arena.alloc(dlen);
+  uint8_t* txt = arena.alloc(ctlen);
+  uint8_t* enc = arena.alloc(ctlen);
+  uint8_t* dec = arena.alloc(ctlen);
 
   random_data(key, kntlen);
   random_data(nonce, kntlen);
@@ -92,6 +102,8 @@ decrypt(benchmark::State& state)
 
   gift_cofb::encrypt(key, nonce, data, dlen, txt, enc, ctlen, tag);
 
+  bench_perf::scope_t perf(state);
+
   for (auto _ : state) {
     bool f = false;
     f = gift_cofb::decrypt(key, nonce, tag, data, dlen, enc, dec, ctlen);
@@ -109,14 +121,386 @@ decrypt(benchmark::State& state)
   const size_t total_data = per_itr_data * state.iterations();
 
   state.SetBytesProcessed(static_cast<int64_t>(total_data));
+}
+
+// Benchmark a building block of GIFT-COFB ( mapping a 64 -bit offset or a
+// 128 -bit block to a new one ) in latency mode i.e. each application consumes
+// output of previous one, when `chain` is set; otherwise in throughput mode
+// i.e. it's applied on 8 independent inputs, which have no dependency among
+// them
+template<typename T, T (*op)(const T), const bool chain>
+static void
+cofb_block(benchmark::State& state)
+{
+  constexpr size_t applications = 16;
+  constexpr size_t inputs = chain ? 1 : 8;
+  constexpr size_t rounds = applications / inputs;
+
+  T vals[inputs];
+  random_data(reinterpret_cast<uint8_t*>(vals), sizeof(vals));
+
+  bench_perf::scope_t perf(state);
+
+  for (auto _ : state) {
+    for (size_t i = 0; i < rounds; i++) {
+      for (size_t j = 0; j < inputs; j++) {
+        vals[j] = op(vals[j]);
+      }
+    }
+
+    benchmark::DoNotOptimize(vals);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(
+    static_cast<int64_t>(applications * state.iterations()));
+}
+
+// Benchmarks computation of N consecutive masking offsets L·2^1 ... L·2^N,
+// either by chaining doublings or by filling offset ladder, LADDER -many rungs
+// at a time | N = state.range(0)
+template<const bool ladder>
+static void
+offsets(benchmark::State& state)
+{
+  const size_t cnt = static_cast<size_t>(state.range(0));
+
+  uint64_t l;
+  random_data(reinterpret_cast<uint8_t*>(&l), sizeof(l));
+
+  gift_cofb_common::ladder_t ldr;
+  uint64_t acc = 0;
+
+  bench_perf::scope_t perf(state);
+
+  for (auto _ : state) {
+    uint64_t x = l;
+
+    if constexpr (ladder) {
+      for (size_t i = 0; i < cnt; i += gift_cofb_common::LADDER) {
+        const size_t n = std::min(gift_cofb_common::LADDER, cnt - i);
+        gift_cofb_common::fill_ladder(&ldr, x, n);
+
+        for (size_t j = 0; j < n; j++) {
+          acc ^= ldr.rungs[j];
+        }
+
+        x = ldr.rungs[n - 1];
+      }
+    } else {
+      for (size_t i = 0; i < cnt; i++) {
+        x = gift_cofb_common::lx2(x);
+        acc ^= x;
+      }
+    }
+
+    benchmark::DoNotOptimize(acc);
+  }
+
+  state.SetItemsProcessed(static_cast<int64_t>(cnt * state.iterations()));
+}
+
+// Tag comparison, as it used to be done i.e. byte-wise, after spilling computed
+// tag to memory, returning all-ones 64 -bit mask if tags differ
+inline static uint64_t
+tag_mismatch_bytes(const gift_cofb_common::block_t y, const uint8_t* const tag)
+{
+  uint8_t tag_[16];
+  gift_cofb_common::store_block(y, tag_);
+
+  bool flg = false;
+  for (size_t i = 0; i < 16; i++) {
+    flg |= static_cast<bool>(tag[i] ^ tag_[i]);
+  }
+
+  return 0ul - static_cast<uint64_t>(flg);
+}
+
+// Benchmarks comparison of 128 -bit tag, computed in registers, with received
+// one, using given comparison kernel
+template<uint64_t (*op)(const gift_cofb_common::block_t, const uint8_t* const)>
+static void
+tag_mismatch(benchmark::State& state)
+{
+  uint8_t tag[16];
+  random_data(tag, sizeof(tag));
+
+  gift_cofb_common::block_t y = gift_cofb_common::load_block(tag);
+  uint64_t acc = 0;
+
+  bench_perf::scope_t perf(state);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(y);
+    benchmark::DoNotOptimize(tag);
+
+    acc += op(y, tag);
+    benchmark::DoNotOptimize(acc);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Benchmarks batch GIFT-COFB authenticated encryption ( or verified decryption,
+// when `decrypt` is set ) of N records, each with M -bytes associated data and
+// P -bytes plain text, all encrypted under 16 different keys, where job
+// descriptors and output slabs are carved out of one arena, which is reset
+// before each batch | N, M, P = state.range(0), state.range(1), state.range(2)
+template<const bool decrypt>
+static void
+batch(benchmark::State& state)
+{
+  constexpr size_t kntlen = 16;
+  constexpr size_t key_cnt = 16;
+
+  const size_t rec_cnt = static_cast<size_t>(state.range(0));
+  const size_t dlen = static_cast<size_t>(state.range(1));
+  const size_t ctlen = static_cast<size_t>(state.range(2));
+
+  std::vector<uint8_t> keys(key_cnt * kntlen);
+  std::vector<uint8_t> nonces(rec_cnt * kntlen);
+  std::vector<uint8_t> data(rec_cnt * dlen);
+  std::vector<uint8_t> txt(rec_cnt * ctlen);
+  std::vector<uint8_t> enc(rec_cnt * ctlen);
+  std::vector<uint8_t> tags(rec_cnt * kntlen);
+
+  random_data(keys.data(), keys.size());
+  random_data(nonces.data(), nonces.size());
+  random_data(data.data(), data.size());
+  random_data(txt.data(), txt.size());
+
+  for (size_t i = 0; i < rec_cnt; i++) {
+    gift_cofb::encrypt(keys.data() + (i % key_cnt) * kntlen,
+                       nonces.data() + i * kntlen,
+                       data.data() + i * dlen,
+                       dlen,
+                       txt.data() + i * ctlen,
+                       enc.data() + i * ctlen,
+                       ctlen,
+                       tags.data() + i * kntlen);
+  }
+
+  // job descriptors ( at max 128 bytes per record ) + output slabs
+  constexpr size_t align = gift_cofb_batch::ALIGN;
+  const size_t slab_len = gift_cofb_batch::round_up(ctlen, align);
+  gift_cofb_batch::arena_t arena(rec_cnt * (128 + slab_len) + 16 * align, true);
+
+  size_t failed = 0;
+
+  bench_perf::scope_t perf(state);
+
+  for (auto _ : state) {
+    arena.reset();
+
+    gift_cofb_batch::jobs_t jobs;
+    gift_cofb_batch::make_jobs(&arena, rec_cnt, &jobs);
+
+    for (size_t i = 0; i < rec_cnt; i++) {
+      const uint8_t* const in = (decrypt ? enc.data() : txt.data()) + i * ctlen;
+      const uint8_t* const tag = decrypt ? tags.data() + i * kntlen : nullptr;
+
+      gift_cofb_batch::push(&jobs,
+                            static_cast<uint32_t>(i % key_cnt),
+                            nonces.data() + i * kntlen,
+                            data.data() + i * dlen,
+                            dlen,
+                            in,
+                            arena.alloc(ctlen),
+                            ctlen,
+                            tag);
+    }
+
+    if constexpr (decrypt) {
+      failed += gift_cofb_batch::decrypt(keys.data(), &jobs);
+    } else {
+      gift_cofb_batch::encrypt(keys.data(), &jobs);
+    }
+
+    benchmark::DoNotOptimize(jobs);
+    benchmark::ClobberMemory();
+  }
+
+  assert(failed == 0);
+  (void)failed;
+
+  const size_t per_itr_data = rec_cnt * (dlen + ctlen);
+  const size_t total_data = per_itr_data * state.iterations();
+
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+  state.SetItemsProcessed(static_cast<int64_t>(rec_cnt * state.iterations()));
+}
+
+// Benchmarks sealing of one record, with M -bytes associated data and P -bytes
+// plain text, under next nonce of a counter, either computing E_K(N) on
+// critical path or taking it from precomputation queue, which is refilled
+// outside of timed region, as a background producer would | M, P =
+// state.range(0), state.range(1)
+template<const bool precomputed>
+static void
+seal_next(benchmark::State& state)
+{
+  constexpr size_t kntlen = 16;
+
+  const size_t dlen = static_cast<size_t>(state.range(0));
+  const size_t ctlen = static_cast<size_t>(state.range(1));
+
+  std::vector<uint8_t> key(kntlen);
+  std::vector<uint8_t> nonce(kntlen);
+  std::vector<uint8_t> tag(kntlen);
+  std::vector<uint8_t> data(dlen);
+  std::vector<uint8_t> txt(ctlen);
+  std::vector<uint8_t> enc(ctlen);
+
+  random_data(key.data(), key.size());
+  random_data(data.data(), data.size());
+  random_data(txt.data(), txt.size());
+
+  gift_cofb_random::source_t src;
+  gift_cofb_random::generator_t gen(&src);
+  gift_cofb_precompute::queue_t q(key.data(), &src);
+
+  bench_perf::scope_t perf(state);
+
+  for (auto _ : state) {
+    if constexpr (precomputed) {
+      if (q.ready() == 0) {
+        state.PauseTiming();
+        q.refill();
+        state.ResumeTiming();
+      }
+
+      gift_cofb_precompute::seal(&q,
+                                 data.data(),
+                                 dlen,
+                                 txt.data(),
+                                 enc.data(),
+                                 ctlen,
+                                 tag.data(),
+                                 nonce.data());
+    } else {
+      gen.next(nonce.data());
+      gift_cofb::encrypt(key.data(),
+                         nonce.data(),
+                         data.data(),
+                         dlen,
+                         txt.data(),
+                         enc.data(),
+                         ctlen,
+                         tag.data());
+    }
+
+    benchmark::DoNotOptimize(enc.data());
+    benchmark::DoNotOptimize(tag.data());
+    benchmark::ClobberMemory();
+  }
+
+  const size_t per_itr_data = dlen + ctlen;
+  const size_t total_data = per_itr_data * state.iterations();
+
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+// Benchmarks incremental GIFT-COFB encryption of M -bytes plain text, fed in
+// C -bytes chunks, along with 32 -bytes associated data
+static void
+incremental(benchmark::State& state)
+{
+  namespace inc = gift_cofb_incremental;
+
+  const size_t ctlen = state.range(0);
+  const size_t chunk = state.range(1);
+
+  uint8_t key[16], nonce[16], data[32], tag[16];
+  std::vector<uint8_t> txt(ctlen), enc(ctlen);
+
+  random_data(key, sizeof(key));
+  random_data(nonce, sizeof(nonce));
+  random_data(data, sizeof(data));
+  random_data(txt.data(), ctlen);
+
+  bench_perf::scope_t perf(state);
+
+  for (auto _ : state) {
+    inc::context_t ctx;
+    inc::init(&ctx, key, nonce);
+    inc::update_data(&ctx, data, sizeof(data));
+
+    for (size_t off = 0; off < ctlen; off += chunk) {
+      const size_t n = std::min(chunk, ctlen - off);
+      inc::update(&ctx, txt.data() + off, enc.data() + off, n);
+    }
+    inc::finish(&ctx, tag);
+
+    benchmark::DoNotOptimize(enc.data());
+    benchmark::DoNotOptimize(tag);
+    benchmark::ClobberMemory();
+  }
+
+  uint8_t ref[16];
+  std::vector<uint8_t> out(ctlen);
+  gift_cofb::encrypt(
+    key, nonce, data, sizeof(data), txt.data(), out.data(), ctlen, ref);
+
+  assert(std::memcmp(ref, tag, sizeof(tag)) == 0);
+  assert(std::equal(out.begin(), out.end(), enc.begin()));
+
+  const size_t per_itr_data = sizeof(data) + ctlen;
+  const size_t total_data = per_itr_data * state.iterations();
+
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+}
+
+// Benchmarks exporting incremental GIFT-COFB context as checkpoint and
+// importing it back, as done when a long job is handed over to another worker
+static void
+checkpoint(benchmark::State& state)
+{
+  namespace inc = gift_cofb_incremental;
+
+  uint8_t key[16], nonce[16], txt[40], enc[40];
+  uint8_t blob[inc::CHECKPOINT_LEN];
+
+  random_data(key, sizeof(key));
+  random_data(nonce, sizeof(nonce));
+  random_data(txt, sizeof(txt));
+
+  // mid-block context, holding back a partial block
+  inc::context_t ctx;
+  inc::init(&ctx, key, nonce);
+  inc::update(&ctx, txt, enc, sizeof(txt));
+
+  bench_perf::scope_t perf(state);
+
+  bool ok = true;
+  for (auto _ : state) {
+    ok &= inc::checkpoint(&ctx, blob);
+    ok &= inc::restore(&ctx, key, blob);
+
+    benchmark::DoNotOptimize(ok);
+    benchmark::DoNotOptimize(&ctx);
+    benchmark::ClobberMemory();
+  }
+
+  assert(ok);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+// Benchmarks run-time part of power-on self-test i.e. what's left to be done at
+// process start, once Known Answer Tests are checked at compile-time
+static void
+power_on(benchmark::State& state)
+{
+  bench_perf::scope_t perf(state);
+
+  for (auto _ : state) {
+    bool ok = gift_cofb_selftest::power_on();
+
+    benchmark::DoNotOptimize(ok);
+    benchmark::ClobberMemory();
+  }
 
-  std::free(key);
-  std::free(nonce);
-  std::free(tag);
-  std::free(data);
-  std::free(txt);
-  std::free(enc);
-  std::free(dec);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
 }
 
 }
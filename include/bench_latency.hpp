@@ -0,0 +1,193 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined __x86_64__
+#include <x86intrin.h>
+#endif
+
+#if defined __linux__
+#include <sched.h>
+#endif
+
+// Utilities for measuring latency distribution of individual GIFT-COFB
+// encrypt/ decrypt calls, instead of mean time reported by google-benchmark
+namespace bench_latency {
+
+// Reads cycle counter ( or its closest equivalent ), making sure that it's not
+// reordered with instructions issued before it, so that it can mark beginning
+// of timed region
+inline static uint64_t
+start()
+{
+#if defined __x86_64__
+  _mm_lfence();
+  const uint64_t t = __rdtsc();
+  _mm_lfence();
+  return t;
+#elif defined __aarch64__
+  uint64_t t;
+  asm volatile("isb\n\tmrs %0, cntvct_el0" : "=r"(t) : : "memory");
+  return t;
+#else
+  using namespace std::chrono;
+  const auto t = steady_clock::now().time_since_epoch();
+  return static_cast<uint64_t>(duration_cast<nanoseconds>(t).count());
+#endif
+}
+
+// Reads cycle counter, only after all instructions issued before it have
+// completed ( rdtscp ), so that it can mark end of timed region
+inline static uint64_t
+stop()
+{
+#if defined __x86_64__
+  uint32_t aux;
+  const uint64_t t = __rdtscp(&aux);
+  _mm_lfence();
+  return t;
+#elif defined __aarch64__
+  uint64_t t;
+  asm volatile("isb\n\tmrs %0, cntvct_el0\n\tisb" : "=r"(t) : : "memory");
+  return t;
+#else
+  return start();
+#endif
+}
+
+// Measures how many ticks of cycle counter elapse per nanosecond, by sampling
+// it against steady clock for given duration
+inline static double
+ticks_per_ns(const std::chrono::milliseconds dur)
+{
+  using namespace std::chrono;
+
+  const auto t0 = steady_clock::now();
+  const uint64_t c0 = start();
+
+  while (steady_clock::now() - t0 < dur) {
+  }
+
+  const auto t1 = steady_clock::now();
+  const uint64_t c1 = stop();
+
+  const double ns = duration<double, std::nano>(t1 - t0).count();
+  return static_cast<double>(c1 - c0) / ns;
+}
+
+// Pins calling thread to given CPU core, returning false if it's not possible
+inline static bool
+pin_to_core(const size_t cpu)
+{
+#if defined __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+  return false;
+#endif
+}
+
+// HDR-histogram style, log-linear histogram of 64 -bit values, where each
+// power-of-2 range is split into 2^S equal sub-buckets, so that any recorded
+// value is known with relative error < 2^-S, while memory usage stays small
+template<const size_t S>
+struct histogram_t
+{
+  static constexpr size_t SUB = 1ul << S;
+  static constexpr size_t BUCKETS = (64 - S + 1) * SUB;
+
+  std::vector<uint64_t> counts = std::vector<uint64_t>(BUCKETS, 0);
+  uint64_t total = 0;
+  uint64_t max = 0;
+
+  // Bucket index of given value
+  static inline size_t index(const uint64_t v)
+  {
+    const size_t msb = std::bit_width(v | 1) - 1;
+
+    if (msb < S) {
+      return static_cast<size_t>(v);
+    }
+
+    const size_t shift = msb - S;
+    return ((shift + 1) << S) + static_cast<size_t>((v >> shift) - SUB);
+  }
+
+  // Smallest value, which falls in bucket of given index
+  static inline uint64_t lowest(const size_t idx)
+  {
+    if (idx < SUB) {
+      return idx;
+    }
+
+    const size_t shift = (idx >> S) - 1;
+    return (static_cast<uint64_t>(SUB) + (idx & (SUB - 1))) << shift;
+  }
+
+  inline void record(const uint64_t v)
+  {
+    counts[index(v)]++;
+    total++;
+    max = std::max(max, v);
+  }
+
+  inline void reset()
+  {
+    std::fill(counts.begin(), counts.end(), 0);
+    total = 0;
+    max = 0;
+  }
+
+  // Value at given percentile | 0 <= q <= 100, reported as lower end of bucket
+  // in which it falls
+  inline uint64_t percentile(const double q) const
+  {
+    if (total == 0) {
+      return 0;
+    }
+
+    const double rank = (q / 100.0) * static_cast<double>(total);
+    const uint64_t want = std::max<uint64_t>(1, static_cast<uint64_t>(rank));
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; i++) {
+      seen += counts[i];
+
+      if (seen >= want) {
+        return lowest(i);
+      }
+    }
+
+    return max;
+  }
+};
+
+// Evicts caches ( both data and instruction caches, as it's much larger than
+// last level cache ) by writing to and reading from a large buffer, so that
+// next timed call starts cold
+struct evictor_t
+{
+  std::vector<uint64_t> buf;
+
+  explicit evictor_t(const size_t bytes)
+    : buf(bytes / sizeof(uint64_t), 0)
+  {
+  }
+
+  inline void evict()
+  {
+    // touch one word per cache line
+    for (size_t i = 0; i < buf.size(); i += 8) {
+      buf[i] += 1;
+    }
+  }
+};
+
+}
@@ -0,0 +1,212 @@
+#pragma once
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined GIFT_COFB_PERF && defined __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Optional hardware performance counters ( instructions, cycles, L1D/ LLC
+// misses and branch misses ), read with `perf_event_open` around timed loop of
+// each benchmark and attached to it as google-benchmark user counters ( so that
+// they also land in JSON output ), when GIFT_COFB_PERF is defined on Linux;
+// otherwise `scope_t` does nothing
+//
+// Events which can't be opened ( say inside a VM or container, without PMU
+// access, or with restrictive `perf_event_paranoid` ) are skipped, silently,
+// along with counters derived from them
+namespace bench_perf {
+
+// Counted events, in order of their file descriptors in event group
+enum counter_t : size_t
+{
+  CYCLES = 0,
+  INSTRUCTIONS,
+  L1D_MISSES,
+  LLC_MISSES,
+  BRANCH_MISSES,
+  COUNTERS
+};
+
+// Name of user counter, under which each event is reported per iteration
+constexpr const char* NAMES[COUNTERS]{
+  "cycles", "instructions", "L1D-misses", "LLC-misses", "branch-misses"
+};
+
+#if defined GIFT_COFB_PERF && defined __linux__
+
+// Type and config of a perf event, as understood by `perf_event_open`
+struct event_t
+{
+  uint32_t type;
+  uint64_t config;
+};
+
+// Config of a read miss event, on given hardware cache
+inline static constexpr uint64_t
+read_misses(const uint64_t cache)
+{
+  return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+constexpr event_t EVENTS[COUNTERS]{
+  { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+  { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+  { PERF_TYPE_HW_CACHE, read_misses(PERF_COUNT_HW_CACHE_L1D) },
+  { PERF_TYPE_HW_CACHE, read_misses(PERF_COUNT_HW_CACHE_LL) },
+  { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+};
+
+// Opens event, counting user space of calling thread, as member of group led
+// by given file descriptor ( or as disabled group leader, if it's negative ),
+// returning its file descriptor or -1
+inline static int
+open_event(const event_t& ev, const int leader)
+{
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+
+  attr.size = sizeof(attr);
+  attr.type = ev.type;
+  attr.config = ev.config;
+  attr.disabled = leader < 0;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format =
+    PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+  const long fd = syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+  return static_cast<int>(fd);
+}
+
+// Group of N events, enabled/ disabled together, where first one which could
+// be opened leads the group
+template<const size_t N>
+struct group_t
+{
+  int fds[N];
+  int leader = -1;
+  uint64_t values[N]{};
+
+  explicit group_t(const event_t* const events)
+  {
+    for (size_t i = 0; i < N; i++) {
+      fds[i] = open_event(events[i], leader);
+
+      if (fds[i] >= 0 && leader < 0) {
+        leader = fds[i];
+      }
+    }
+  }
+
+  group_t(const group_t&) = delete;
+  group_t& operator=(const group_t&) = delete;
+
+  ~group_t()
+  {
+    for (size_t i = 0; i < N; i++) {
+      if (fds[i] >= 0) {
+        close(fds[i]);
+      }
+    }
+  }
+
+  // Whether i -th event is being counted
+  inline bool valid(const size_t i) const { return fds[i] >= 0; }
+
+  // Resets and enables all counters
+  inline void start()
+  {
+    if (leader >= 0) {
+      ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+      ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+  }
+
+  // Disables all counters and reads them, scaling each by fraction of time it
+  // was actually counting, in case events were multiplexed
+  inline void stop()
+  {
+    if (leader < 0) {
+      return;
+    }
+
+    ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    for (size_t i = 0; i < N; i++) {
+      uint64_t buf[3]{}; // value, time enabled, time running
+
+      if (fds[i] < 0 || read(fds[i], buf, sizeof(buf)) != sizeof(buf)) {
+        values[i] = 0;
+        continue;
+      }
+
+      const double scale = buf[2] == 0 ? 0.0
+                                       : static_cast<double>(buf[1]) /
+                                           static_cast<double>(buf[2]);
+      values[i] = static_cast<uint64_t>(static_cast<double>(buf[0]) * scale);
+    }
+  }
+};
+
+// Counts events over its lifetime ( i.e. constructed right before timed loop
+// of benchmark, destroyed when benchmark function returns ) and attaches them
+// to benchmark state, as per iteration averages, along with instructions per
+// cycle; work done after timed loop ( say one verification call ) is counted
+// too, but it's negligible against thousands of iterations
+struct scope_t
+{
+  benchmark::State& state;
+  group_t<COUNTERS> group;
+
+  explicit scope_t(benchmark::State& s)
+    : state(s)
+    , group(EVENTS)
+  {
+    group.start();
+  }
+
+  scope_t(const scope_t&) = delete;
+  scope_t& operator=(const scope_t&) = delete;
+
+  ~scope_t()
+  {
+    group.stop();
+
+    using benchmark::Counter;
+
+    for (size_t i = 0; i < COUNTERS; i++) {
+      if (group.valid(i)) {
+        const double v = static_cast<double>(group.values[i]);
+        state.counters[NAMES[i]] = Counter(v, Counter::kAvgIterations);
+      }
+    }
+
+    if (group.valid(CYCLES) && group.valid(INSTRUCTIONS) &&
+        group.values[CYCLES] > 0) {
+      const double ipc = static_cast<double>(group.values[INSTRUCTIONS]) /
+                         static_cast<double>(group.values[CYCLES]);
+
+      // per thread counters are summed up, when benchmark runs on many threads
+      state.counters["IPC"] = Counter(ipc, Counter::kAvgThreads);
+    }
+  }
+};
+
+#else
+
+// Performance counters are compiled out, nothing is attached to benchmark
+struct scope_t
+{
+  explicit scope_t(benchmark::State&) {}
+};
+
+#endif
+
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include "bench_perf.hpp"
+#include "random.hpp"
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+
+// Benchmark nonce and random byte sources
+namespace bench_gift_cofb {
+
+// Benchmarks filling N random bytes, either by seeding a fresh Mersenne Twister
+// from `std::random_device` and drawing one byte at a time ( as `random_data`
+// used to do ), or from buffered pool of operating system provided random bytes
+// | N = state.range(0)
+template<const bool pooled>
+static void
+random_fill(benchmark::State& state)
+{
+  const size_t len = state.range(0);
+  std::vector<uint8_t> buf(len);
+
+  bench_perf::scope_t perf(state);
+
+  for (auto _ : state) {
+    if constexpr (pooled) {
+      gift_cofb_random::fill(buf.data(), len);
+    } else {
+      std::random_device rd;
+      std::mt19937_64 gen(rd());
+      std::uniform_int_distribution<uint8_t> dis;
+
+      for (size_t i = 0; i < len; i++) {
+        buf[i] = dis(gen);
+      }
+    }
+
+    benchmark::DoNotOptimize(buf.data());
+    benchmark::ClobberMemory();
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(len * state.iterations()));
+}
+
+// Shared nonce space of `nonce_next` benchmark, whose threads lease counters
+// out of it
+static gift_cofb_random::source_t nonce_src;
+
+// Benchmarks generating one 128 -bit nonce, using per-thread generator, which
+// leases counters out of one nonce space, shared by all benchmark threads
+static void
+nonce_next(benchmark::State& state)
+{
+  gift_cofb_random::generator_t gen(&nonce_src);
+  uint8_t nonce[16];
+
+  bench_perf::scope_t perf(state);
+
+  for (auto _ : state) {
+    const bool f = gen.next(nonce);
+
+    benchmark::DoNotOptimize(f);
+    benchmark::DoNotOptimize(nonce);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+}
@@ -0,0 +1,208 @@
+#pragma once
+#include "aead.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Workload driven GIFT-COFB benchmark, replaying distributions of associated
+// data and plain text lengths, as seen in real traffic, instead of one fixed
+// size at a time
+namespace bench_traffic {
+
+// One ( associated data length, plain text length ) pair, along with its
+// relative weight in traffic mix
+struct size_class_t
+{
+  size_t dlen;
+  size_t ctlen;
+  size_t weight;
+};
+
+// Simple IMIX packet mix i.e. 40, 576 and 1500 -bytes packets, in ratio
+// 7 : 4 : 1, where each packet carries 8 -bytes of associated data ( say
+// sequence number and header fields )
+static const std::vector<size_class_t> IMIX{
+  { 8, 40, 7 },
+  { 8, 576, 4 },
+  { 8, 1500, 1 },
+};
+
+// Log record mix, dominated by short single line records, with a long tail of
+// multi-line ones ( say stack traces ), where each record carries 16 -bytes of
+// associated data ( say timestamp and source identifier )
+static const std::vector<size_class_t> LOGS{
+  { 16, 64, 20 },  { 16, 128, 35 }, { 16, 256, 25 },
+  { 16, 512, 12 }, { 16, 1024, 6 }, { 16, 4096, 2 },
+};
+
+// Reads traffic mix from CSV file, where each line holds one record's
+// `ad_len,pt_len` pair, each of weight 1; empty lines, lines starting with `#`
+// and lines which don't start with a digit ( say header ) are skipped
+static std::vector<size_class_t>
+read_csv(const std::string& path)
+{
+  std::vector<size_class_t> mix;
+  std::ifstream fd(path);
+
+  std::string line;
+  while (std::getline(fd, line)) {
+    if (line.empty() || !std::isdigit(static_cast<unsigned char>(line[0]))) {
+      continue;
+    }
+
+    std::replace(line.begin(), line.end(), ',', ' ');
+    std::istringstream ss(line);
+
+    size_t dlen = 0, ctlen = 0;
+    if (ss >> dlen >> ctlen) {
+      mix.push_back({ dlen, ctlen, 1 });
+    }
+  }
+
+  return mix;
+}
+
+// One GIFT-COFB record of workload, referring to its secret key, nonce,
+// associated data and plain text, placed in shared pools
+struct record_t
+{
+  size_t key_off;
+  size_t nonce_off;
+  size_t dlen;
+  size_t data_off;
+  size_t ctlen;
+  size_t txt_off;
+  size_t enc_off; // offset of cipher text, in pool of encrypted records
+};
+
+// Pre-generated workload, so that random number generation is not measured,
+// while sealing/ opening records
+struct workload_t
+{
+  std::vector<record_t> records;
+  std::vector<uint8_t> keys;
+  std::vector<uint8_t> nonces;
+  std::vector<uint8_t> pool; // associated data and plain text bytes
+  std::vector<uint8_t> encs; // cipher text of each record
+  std::vector<uint8_t> tags; // authentication tag of each record
+  size_t max_ctlen = 0;
+  size_t total_bytes = 0; // associated data + plain text bytes
+};
+
+// Samples given number of records from traffic mix ( using fixed seed, so that
+// runs are comparable ), generating secret keys ( out of a pool of given
+// size ), unique nonces and random input bytes up front; then encrypts every
+// record, so that same workload can also be used for benchmarking decryption
+static workload_t
+generate(const std::vector<size_class_t>& mix,
+         const size_t rec_cnt,
+         const size_t key_cnt)
+{
+  constexpr size_t kntlen = 16;
+  constexpr size_t pool_len = 1ul << 20;
+
+  workload_t wl;
+
+  std::vector<size_t> weights;
+  size_t max_len = 0;
+
+  for (const auto& sc : mix) {
+    weights.push_back(sc.weight);
+    max_len = std::max(max_len, std::max(sc.dlen, sc.ctlen));
+  }
+
+  std::mt19937_64 gen(0x6966742d636f6662ul);
+  std::discrete_distribution<size_t> pick(weights.begin(), weights.end());
+
+  wl.keys.resize(key_cnt * kntlen);
+  wl.nonces.resize(rec_cnt * kntlen);
+  wl.pool.resize(pool_len + max_len);
+  wl.tags.resize(rec_cnt * kntlen);
+
+  random_data(wl.keys.data(), wl.keys.size());
+  random_data(wl.nonces.data(), wl.nonces.size());
+  random_data(wl.pool.data(), wl.pool.size());
+
+  std::uniform_int_distribution<size_t> key_dis(0, key_cnt - 1);
+  std::uniform_int_distribution<size_t> off_dis(0, pool_len - 1);
+
+  size_t enc_off = 0;
+  for (size_t i = 0; i < rec_cnt; i++) {
+    const auto& sc = mix[pick(gen)];
+
+    wl.records.push_back({ key_dis(gen) * kntlen,
+                           i * kntlen,
+                           sc.dlen,
+                           off_dis(gen),
+                           sc.ctlen,
+                           off_dis(gen),
+                           enc_off });
+
+    enc_off += sc.ctlen;
+    wl.max_ctlen = std::max(wl.max_ctlen, sc.ctlen);
+    wl.total_bytes += sc.dlen + sc.ctlen;
+  }
+
+  wl.encs.resize(enc_off);
+
+  for (size_t i = 0; i < rec_cnt; i++) {
+    const record_t& r = wl.records[i];
+
+    gift_cofb::encrypt(wl.keys.data() + r.key_off,
+                       wl.nonces.data() + r.nonce_off,
+                       wl.pool.data() + r.data_off,
+                       r.dlen,
+                       wl.pool.data() + r.txt_off,
+                       wl.encs.data() + r.enc_off,
+                       r.ctlen,
+                       wl.tags.data() + i * kntlen);
+  }
+
+  return wl;
+}
+
+// Seals i -th record of workload, writing cipher text and tag to scratch
+// buffers of calling thread
+inline static void
+seal(const workload_t& wl,
+     const size_t i,
+     uint8_t* const enc,
+     uint8_t* const tag)
+{
+  const record_t& r = wl.records[i];
+
+  gift_cofb::encrypt(wl.keys.data() + r.key_off,
+                     wl.nonces.data() + r.nonce_off,
+                     wl.pool.data() + r.data_off,
+                     r.dlen,
+                     wl.pool.data() + r.txt_off,
+                     enc,
+                     r.ctlen,
+                     tag);
+}
+
+// Opens i -th record of workload, writing decrypted text to scratch buffer of
+// calling thread, returning verification status
+inline static bool
+open(const workload_t& wl, const size_t i, uint8_t* const dec)
+{
+  const record_t& r = wl.records[i];
+
+  return gift_cofb::decrypt(wl.keys.data() + r.key_off,
+                            wl.nonces.data() + r.nonce_off,
+                            wl.tags.data() + i * 16,
+                            wl.pool.data() + r.data_off,
+                            r.dlen,
+                            wl.encs.data() + r.enc_off,
+                            dec,
+                            r.ctlen);
+}
+
+}
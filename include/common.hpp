@@ -1,57 +1,261 @@
 #pragma once
+#include "gift.hpp"
+#include "linkage.hpp"
+#include <algorithm>
 #include <bit>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <type_traits>
 
 // GIFT-COFB common functions, used in both encrypt & decrypt
 namespace gift_cofb_common {
 
-// GIFT-COFB feedback function, which takes 128 -bit input and produces 128 -bit
-// output, as defined in section 2.5 of specification
-// https://csrc.nist.gov/CSRC/media/Projects/lightweight-cryptography/documents/finalist-round/updated-spec-doc/gift-cofb-spec-final.pdf
-inline static void
-feedback(uint32_t* const y)
+// 128 -bit block ( chaining value Y, input/ output block of GIFT-128 or one
+// block of associated data/ plain text/ cipher text ), kept as two 64 -bit
+// halves, so that it lives in general purpose registers across blocks, instead
+// of being copied in and out of arrays
+//
+// Bytes [0, 8) of block are held in `hi` and bytes [8, 16) in `lo`, both
+// interpreted in big-endian byte order i.e. `hi` = Y[1] and `lo` = Y[2], when
+// 128 -bit Y = Y[1] || Y[2], following notation of specification
+struct block_t
 {
-  const uint64_t y1_0 = static_cast<uint64_t>(y[0]);
-  const uint64_t y1_1 = static_cast<uint64_t>(y[1]);
+  uint64_t hi;
+  uint64_t lo;
+};
 
-  const uint64_t y1 = (y1_0 << 32) | y1_1;
-  const uint64_t y1_prime = std::rotl(y1, 1);
+// XORs two 128 -bit blocks
+GIFT_COFB_INLINE constexpr block_t
+operator^(const block_t a, const block_t b)
+{
+  return { a.hi ^ b.hi, a.lo ^ b.lo };
+}
 
-  std::memcpy(y + 0, y + 2, 8);
+// Loads 64 -bit word from 8 bytes, interpreting them in big-endian byte order
+GIFT_COFB_INLINE constexpr uint64_t
+load_be64(const uint8_t* const bytes)
+{
+  uint64_t w = 0;
+  for (size_t i = 0; i < 8; i++) {
+    w = (w << 8) | static_cast<uint64_t>(bytes[i]);
+  }
 
-  y[2] = static_cast<uint32_t>(y1_prime >> 32);
-  y[3] = static_cast<uint32_t>(y1_prime >> 0);
+  return w;
 }
 
-// Multiplying a 64 -bit element of field 2^64 ( with irreducible polynomial
-// f(x) = x^64 + x^4 + x^3 + x + 1 ) by primitive element 0b10 ( = α = 2 s),
-// as defined in section 2.1.2 of specification
+// Stores 64 -bit word into 8 bytes, in big-endian byte order
+GIFT_COFB_INLINE constexpr void
+store_be64(const uint64_t w, uint8_t* const bytes)
+{
+  for (size_t i = 0; i < 8; i++) {
+    bytes[i] = static_cast<uint8_t>(w >> ((7 - i) << 3));
+  }
+}
+
+// Loads 128 -bit block from 16 bytes
+GIFT_COFB_INLINE constexpr block_t
+load_block(const uint8_t* const bytes)
+{
+  return { load_be64(bytes), load_be64(bytes + 8) };
+}
+
+// Stores 128 -bit block into 16 bytes
+GIFT_COFB_INLINE constexpr void
+store_block(const block_t blk, uint8_t* const bytes)
+{
+  store_be64(blk.hi, bytes);
+  store_be64(blk.lo, bytes + 8);
+}
+
+// Plain text length, from which on, encryption switches to large message mode
+// i.e. plain text is prefetched ahead and cipher text is written with
+// non-temporal stores, bypassing caches, so that streaming a message much
+// larger than last level cache doesn't evict everyone else's working set
+#if !defined GIFT_COFB_STREAM_THRESHOLD
+#define GIFT_COFB_STREAM_THRESHOLD (1ul << 22)
+#endif
+
+// How many bytes ahead of block being encrypted, plain text is prefetched, in
+// large message mode
+#if !defined GIFT_COFB_PREFETCH_DISTANCE
+#define GIFT_COFB_PREFETCH_DISTANCE 1024
+#endif
+
+constexpr size_t STREAM_THRESHOLD = GIFT_COFB_STREAM_THRESHOLD;
+constexpr size_t PREFETCH_DISTANCE = GIFT_COFB_PREFETCH_DISTANCE;
+
+// Hints CPU to bring cache line holding given address into cache, for reading,
+// without it being kept around after use; it never faults, so prefetching past
+// end of buffer is harmless
+GIFT_COFB_INLINE void
+prefetch(const uint8_t* const bytes)
+{
+#if defined __GNUC__
+  __builtin_prefetch(bytes, 0, 0);
+#else
+  (void)bytes;
+#endif
+}
+
+// Stores 128 -bit block into 16 bytes, which must be 16 -bytes aligned, with a
+// non-temporal store, where available, bypassing caches; call `stream_fence`
+// after last of them
+GIFT_COFB_INLINE void
+store_block_nt(const block_t blk, uint8_t* const bytes)
+{
+#if defined __SSE2__
+  // x86_64 is little-endian, so byte swapped halves land in big-endian order
+  const int64_t hi = static_cast<int64_t>(__builtin_bswap64(blk.hi));
+  const int64_t lo = static_cast<int64_t>(__builtin_bswap64(blk.lo));
+
+  _mm_stream_si128(reinterpret_cast<__m128i*>(bytes), _mm_set_epi64x(lo, hi));
+#else
+  store_block(blk, bytes);
+#endif
+}
+
+// Orders non-temporal stores before all following stores, so that cipher text
+// is visible to anyone, who sees authentication tag ( or a flag set later )
+GIFT_COFB_INLINE void
+stream_fence()
+{
+#if defined __SSE2__
+  _mm_sfence();
+#endif
+}
+
+// Loads first N -bytes of 128 -bit block, while remaining ones are zeroed
+// | 0 <= N <= 16
+GIFT_COFB_INLINE constexpr block_t
+load_partial(const uint8_t* const bytes, const size_t len)
+{
+  uint8_t tmp[16]{};
+  if (std::is_constant_evaluated()) {
+    std::copy_n(bytes, len, tmp);
+  } else if (len > 0) {
+    std::memcpy(tmp, bytes, len);
+  }
+
+  return load_block(tmp);
+}
+
+// Stores first N -bytes of 128 -bit block | 0 <= N <= 16
+GIFT_COFB_INLINE constexpr void
+store_partial(const block_t blk, uint8_t* const bytes, const size_t len)
+{
+  uint8_t tmp[16];
+  store_block(blk, tmp);
+
+  if (std::is_constant_evaluated()) {
+    std::copy_n(tmp, len, bytes);
+  } else if (len > 0) {
+    std::memcpy(bytes, tmp, len);
+  }
+}
+
+// Truncates 128 -bit block to its first N -bytes and pads it with 10* ( when
+// N < 16 ), as defined in section 2.1.3 of specification | 0 <= N <= 16
 // https://csrc.nist.gov/CSRC/media/Projects/lightweight-cryptography/documents/finalist-round/updated-spec-doc/gift-cofb-spec-final.pdf
-inline static void
-lx2(uint32_t* const l)
+GIFT_COFB_INLINE constexpr block_t
+pad(const block_t blk, const size_t len)
+{
+  if (len == 16) {
+    return blk;
+  }
+
+  const size_t hbits = std::min<size_t>(len, 8) << 3;
+  const size_t lbits = (len - (hbits >> 3)) << 3;
+
+  const uint64_t hmsk = hbits == 64 ? ~0ul : ~(~0ul >> hbits);
+  const uint64_t lmsk = ~(~0ul >> lbits);
+
+  block_t res{ blk.hi & hmsk, blk.lo & lmsk };
+
+  if (len < 8) {
+    res.hi |= 0x80ul << (56 - hbits);
+  } else {
+    res.lo |= 0x80ul << (56 - lbits);
+  }
+
+  return res;
+}
+
+// Compares 128 -bit tag, computed in registers, with 16 -bytes received tag,
+// as two 64 -bit words, without any data-dependent branch or early exit,
+// returning all-ones 64 -bit mask if they differ, otherwise zero
+GIFT_COFB_INLINE uint64_t
+tag_mismatch_scalar(const block_t y, const uint8_t* const tag)
+{
+  const block_t t = load_block(tag);
+  const uint64_t d = (y.hi ^ t.hi) | (y.lo ^ t.lo);
+
+  return 0ul - ((d | (0ul - d)) >> 63);
+}
+
+#if defined __SSE2__
+
+// Compares 128 -bit tag, computed in registers, with 16 -bytes received tag,
+// as one 128 -bit vector, without any data-dependent branch or early exit,
+// returning all-ones 64 -bit mask if they differ, otherwise zero
+GIFT_COFB_INLINE uint64_t
+tag_mismatch_sse2(const block_t y, const uint8_t* const tag)
 {
-  const uint64_t l0 = static_cast<uint64_t>(l[0]);
-  const uint64_t l1 = static_cast<uint64_t>(l[1]);
+  uint8_t tag_[16];
+  store_block(y, tag_);
+
+  const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tag_));
+  const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tag));
+  const uint32_t eq =
+    static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)));
+  const uint64_t d = eq ^ 0xffffu;
+
+  return 0ul - ((d | (0ul - d)) >> 63);
+}
 
-  const uint64_t l2 = (l0 << 32) | l1;
+#endif
 
-  const uint8_t b63 = static_cast<uint8_t>(l2 >> 63);
-  constexpr uint64_t br[2] = { 0ul, 0b11011ul };
+// Compares computed tag with received one, in constant-time, returning
+// all-ones 64 -bit mask if they differ, otherwise zero
+//
+// Scalar comparison is used everywhere, as computed tag already lives in two
+// 64 -bit registers, while vector comparison first needs to spill it to memory
+// ( see `tag_mismatch` benchmarks )
+GIFT_COFB_INLINE uint64_t
+tag_mismatch(const block_t y, const uint8_t* const tag)
+{
+  return tag_mismatch_scalar(y, tag);
+}
 
-  const uint64_t l3 = l2 << 1;
-  const uint64_t l4 = l3 ^ br[b63];
+// GIFT-COFB feedback function, which takes 128 -bit input and produces 128 -bit
+// output, as defined in section 2.5 of specification i.e. G(Y) = Y[2] ||
+// (Y[1] <<< 1), which is a swap of 64 -bit halves, followed by rotation
+// https://csrc.nist.gov/CSRC/media/Projects/lightweight-cryptography/documents/finalist-round/updated-spec-doc/gift-cofb-spec-final.pdf
+GIFT_COFB_INLINE constexpr block_t
+feedback(const block_t y)
+{
+  return { y.lo, std::rotl(y.hi, 1) };
+}
 
-  l[0] = static_cast<uint32_t>(l4 >> 32);
-  l[1] = static_cast<uint32_t>(l4 >> 0);
+// Multiplying a 64 -bit element of field 2^64 ( with irreducible polynomial
+// f(x) = x^64 + x^4 + x^3 + x + 1 ) by primitive element 0b10 ( = α = 2 s),
+// as defined in section 2.1.2 of specification
+// https://csrc.nist.gov/CSRC/media/Projects/lightweight-cryptography/documents/finalist-round/updated-spec-doc/gift-cofb-spec-final.pdf
+GIFT_COFB_INLINE constexpr uint64_t
+lx2(const uint64_t l)
+{
+  // reduction polynomial is added only when bit 63 is set, which is done
+  // without branching on ( secret ) offset
+  const uint64_t msk = 0ul - (l >> 63);
+  return (l << 1) ^ (msk & 0b11011ul);
 }
 
 // Multiplying a 64 -bit element of field 2^64 ( with irreducible polynomial
 // f(x) = x^64 + x^4 + x^3 + x + 1 ) by field element 0b11 ( = α + 1 = 3 ),
 // as defined in section 2.1.2 of specification
 // https://csrc.nist.gov/CSRC/media/Projects/lightweight-cryptography/documents/finalist-round/updated-spec-doc/gift-cofb-spec-final.pdf
-inline static void
-lx3(uint32_t* const l)
+GIFT_COFB_INLINE constexpr uint64_t
+lx3(const uint64_t l)
 {
   // This is what is done below.
   //
@@ -63,13 +267,125 @@ lx3(uint32_t* const l)
   // | a, b ∈ F(2^64) with irreducible polynomial x^64 + x^4 + x^3 + x + 1
   //   lx2(b) = b * 2 ( see function above )
 
-  uint32_t tmp[2];
-  std::memcpy(tmp, l, 8);
+  return lx2(l) ^ l;
+}
+
+// Multiplying a 64 -bit element of field 2^64 ( with irreducible polynomial
+// f(x) = x^64 + x^4 + x^3 + x + 1 ) by x^k ( = α^k = 2^k ), in one go, instead
+// of k -many sequential doublings | 1 <= k <= 59
+//
+// Product ( l << k ) overflows by k -bits, which are reduced by carry-less
+// multiplying them with x^4 + x^3 + x + 1; as that polynomial is sparse, it's
+// just four shifted XORs, and as k <= 59, reduction itself never overflows
+GIFT_COFB_INLINE constexpr uint64_t
+mul_pow2(const uint64_t l, const size_t k)
+{
+  const uint64_t hi = l >> (64 - k);
+  const uint64_t red = hi ^ (hi << 1) ^ (hi << 3) ^ (hi << 4);
+
+  return (l << k) ^ red;
+}
+
+// Number of masking offsets, held in offset ladder i.e. 8 cache lines
+constexpr size_t LADDER = 64;
 
-  lx2(tmp);
+// Number of independent dependency chains, used for filling offset ladder
+constexpr size_t LADDER_CHAINS = 8;
 
-  l[0] ^= tmp[0];
-  l[1] ^= tmp[1];
+// Offset ladder, holding masking offsets L·2^1, L·2^2 ... L·2^N, for N
+// consecutive full blocks of associated data/ plain text, so that block loop
+// only indexes into it, instead of chaining doublings on its critical path
+struct ladder_t
+{
+  alignas(64) uint64_t rungs[LADDER];
+};
+
+// Fills first N rungs of offset ladder, starting from masking offset L, such
+// that i -th rung holds L·2^(i+1) | 1 <= N <= LADDER
+//
+// First LADDER_CHAINS rungs are computed directly from L, while each of
+// remaining ones is computed from the rung LADDER_CHAINS places before it, so
+// that LADDER_CHAINS multiplications are always independent of each other
+GIFT_COFB_INLINE constexpr void
+fill_ladder(ladder_t* const ldr, const uint64_t l, const size_t cnt)
+{
+  const size_t head = std::min(cnt, LADDER_CHAINS);
+
+  for (size_t i = 0; i < head; i++) {
+    ldr->rungs[i] = mul_pow2(l, i + 1);
+  }
+
+  for (size_t i = head; i < cnt; i++) {
+    ldr->rungs[i] = mul_pow2(ldr->rungs[i - LADDER_CHAINS], LADDER_CHAINS);
+  }
+}
+
+// Parses 128 -bit secret key into GIFT-128 key state, only once per call to
+// encrypt/ decrypt, so that it can be reused for every block
+GIFT_COFB_INLINE constexpr void
+load_key(uint16_t* const __restrict kst,  // GIFT-128 key state
+         const uint8_t* const __restrict key // 128 -bit secret key
+)
+{
+  for (size_t i = 0; i < 8; i++) {
+    const size_t boff = i << 1;
+
+    kst[i] = (static_cast<uint16_t>(key[boff ^ 0]) << 8) |
+             (static_cast<uint16_t>(key[boff ^ 1]) << 0);
+  }
+}
+
+// Serialises GIFT-128 key state back into 128 -bit secret key, i.e. inverse of
+// `load_key`, for routines which only hold on to key state
+GIFT_COFB_INLINE constexpr void
+store_key(uint8_t* const __restrict key,        // 128 -bit secret key
+          const uint16_t* const __restrict kst // GIFT-128 key state
+)
+{
+  for (size_t i = 0; i < 8; i++) {
+    const size_t boff = i << 1;
+
+    key[boff ^ 0] = static_cast<uint8_t>(kst[i] >> 8);
+    key[boff ^ 1] = static_cast<uint8_t>(kst[i] >> 0);
+  }
+}
+
+// Encrypts 128 -bit block, using GIFT-128 block cipher, with already parsed
+// secret key, so that block moves in/ out of cipher state only through
+// registers; at compile-time, it runs on scalar PermBits
+GIFT_COFB_INLINE constexpr block_t
+encrypt_block(const block_t blk, const uint16_t* const __restrict kst)
+{
+  gift::state_t st;
+
+  st.cipher[0] = static_cast<uint32_t>(blk.hi >> 32);
+  st.cipher[1] = static_cast<uint32_t>(blk.hi >> 0);
+  st.cipher[2] = static_cast<uint32_t>(blk.lo >> 32);
+  st.cipher[3] = static_cast<uint32_t>(blk.lo >> 0);
+
+  std::copy_n(kst, 8, st.key);
+
+  gift::permute<gift::ROUNDS>(&st);
+
+  return { (static_cast<uint64_t>(st.cipher[0]) << 32) | st.cipher[1],
+           (static_cast<uint64_t>(st.cipher[2]) << 32) | st.cipher[3] };
+}
+
+// Absorbs one 128 -bit ( possibly padded ) block of associated data or plain
+// text into chaining value, using masking offset L, computing
+//
+// Y = E_K(X ^ G(Y) ^ (L || 0^64))
+//
+// See figure 2.3 of specification
+// https://csrc.nist.gov/CSRC/media/Projects/lightweight-cryptography/documents/finalist-round/updated-spec-doc/gift-cofb-spec-final.pdf
+GIFT_COFB_INLINE constexpr block_t
+absorb(const block_t y,
+       const uint64_t l,
+       const block_t blk,
+       const uint16_t* const __restrict kst)
+{
+  const block_t g = feedback(y);
+  return encrypt_block({ blk.hi ^ g.hi ^ l, blk.lo ^ g.lo }, kst);
 }
 
 }
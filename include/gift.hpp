@@ -1,9 +1,11 @@
 #pragma once
+#include "linkage.hpp"
 #include <algorithm>
 #include <bit>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <type_traits>
 
 #if defined __SSE2__
 #include <immintrin.h>
@@ -95,7 +97,7 @@ struct state_t
 // Initializing GIFT-128 block cipher state with plain text block and secret
 // key, as defined in section 2.4.2 of GIFT-COFB specification
 // https://csrc.nist.gov/CSRC/media/Projects/lightweight-cryptography/documents/finalist-round/updated-spec-doc/gift-cofb-spec-final.pdf
-inline static void
+GIFT_COFB_INLINE constexpr void
 initialize(state_t* const __restrict st,        // GIFT-128 block cipher state
            const uint8_t* const __restrict txt, // 128 -bit plain text block
            const uint8_t* const __restrict key  // 128 -bit secret key
@@ -121,7 +123,7 @@ initialize(state_t* const __restrict st,        // GIFT-128 block cipher state
 // Initializing GIFT-128 block cipher state with plain text block and secret
 // key, as defined in section 2.4.2 of GIFT-COFB specification
 // https://csrc.nist.gov/CSRC/media/Projects/lightweight-cryptography/documents/finalist-round/updated-spec-doc/gift-cofb-spec-final.pdf
-inline static void
+GIFT_COFB_INLINE void
 initialize(state_t* const __restrict st,         // GIFT-128 block cipher state
            const uint32_t* const __restrict txt, // 128 -bit plain text block
            const uint8_t* const __restrict key   // 128 -bit secret key
@@ -140,7 +142,7 @@ initialize(state_t* const __restrict st,         // GIFT-128 block cipher state
 // Substitutes cells of cipher state with following instructions, as defined in
 // page 5 of GIFT-COFB specification
 // https://csrc.nist.gov/CSRC/media/Projects/lightweight-cryptography/documents/finalist-round/updated-spec-doc/gift-cofb-spec-final.pdf
-inline static void
+GIFT_COFB_INLINE constexpr void
 sub_cells(state_t* const st)
 {
   const uint32_t t0 = st->cipher[0] & st->cipher[2];
@@ -162,140 +164,34 @@ sub_cells(state_t* const st)
   std::swap(st->cipher[0], st->cipher[3]);
 }
 
-// Four different 32 -bit bit permutations are independently applied on each
-// word of cipher state of GIFT-128 block cipher
-//
-// See PermBits specification defined in page 6 of GIFT-COFB specification
-// https://csrc.nist.gov/CSRC/media/Projects/lightweight-cryptography/documents/finalist-round/updated-spec-doc/gift-cofb-spec-final.pdf
-inline static void
-perm_bits(state_t* const st)
+// PermBits, portable reference implementation, which moves one bit at a time,
+// following bit permutation tables 2.2 of GIFT-COFB specification
+GIFT_COFB_INLINE constexpr void
+perm_bits_ref(state_t* const st)
 {
-#if defined __x86_64__
-#pragma message("Compiling for x86_64")
-
-#if defined __SSE2__
-#pragma message("SSE2 is available")
-
-  constexpr uint32_t b7arr[]{ B7, B7, B7, B7 };
-  constexpr uint32_t b6arr[]{ B6, B6, B6, B6 };
-  constexpr uint32_t b5arr[]{ B5, B5, B5, B5 };
-  constexpr uint32_t b4arr[]{ B4, B4, B4, B4 };
-  constexpr uint32_t b3arr[]{ B3, B3, B3, B3 };
-  constexpr uint32_t b2arr[]{ B2, B2, B2, B2 };
-  constexpr uint32_t b1arr[]{ B1, B1, B1, B1 };
-  constexpr uint32_t b0arr[]{ B0, B0, B0, B0 };
-
-  const __m128i b7vec = _mm_load_si128((__m128i*)b7arr);
-  const __m128i b6vec = _mm_load_si128((__m128i*)b6arr);
-  const __m128i b5vec = _mm_load_si128((__m128i*)b5arr);
-  const __m128i b4vec = _mm_load_si128((__m128i*)b4arr);
-  const __m128i b3vec = _mm_load_si128((__m128i*)b3arr);
-  const __m128i b2vec = _mm_load_si128((__m128i*)b2arr);
-  const __m128i b1vec = _mm_load_si128((__m128i*)b1arr);
-  const __m128i b0vec = _mm_load_si128((__m128i*)b0arr);
-
-  const __m128i s = _mm_load_si128((__m128i*)st->cipher);
-
-  const __m128i sa = _mm_xor_si128(
-    _mm_xor_si128(
-      _mm_xor_si128(
-        _mm_xor_si128(
-          _mm_xor_si128(
-            _mm_xor_si128(
-              _mm_xor_si128(_mm_and_si128(_mm_srli_epi32(s, 21), b7vec),
-                            _mm_and_si128(_mm_srli_epi32(s, 18), b6vec)),
-              _mm_and_si128(_mm_srli_epi32(s, 15), b5vec)),
-            _mm_and_si128(_mm_srli_epi32(s, 12), b4vec)),
-          _mm_and_si128(_mm_srli_epi32(s, 9), b3vec)),
-        _mm_and_si128(_mm_srli_epi32(s, 6), b2vec)),
-      _mm_and_si128(_mm_srli_epi32(s, 3), b1vec)),
-    _mm_and_si128(_mm_srli_epi32(s, 0), b0vec));
-
-  const __m128i sb = _mm_xor_si128(
-    _mm_xor_si128(
-      _mm_xor_si128(
-        _mm_xor_si128(
-          _mm_xor_si128(
-            _mm_xor_si128(
-              _mm_xor_si128(_mm_and_si128(_mm_srli_epi32(s, 22), b7vec),
-                            _mm_and_si128(_mm_srli_epi32(s, 19), b6vec)),
-              _mm_and_si128(_mm_srli_epi32(s, 16), b5vec)),
-            _mm_and_si128(_mm_srli_epi32(s, 13), b4vec)),
-          _mm_and_si128(_mm_srli_epi32(s, 10), b3vec)),
-        _mm_and_si128(_mm_srli_epi32(s, 7), b2vec)),
-      _mm_and_si128(_mm_srli_epi32(s, 4), b1vec)),
-    _mm_and_si128(_mm_srli_epi32(s, 1), b0vec));
-
-  const __m128i sc = _mm_xor_si128(
-    _mm_xor_si128(
-      _mm_xor_si128(
-        _mm_xor_si128(
-          _mm_xor_si128(
-            _mm_xor_si128(
-              _mm_xor_si128(_mm_and_si128(_mm_srli_epi32(s, 23), b7vec),
-                            _mm_and_si128(_mm_srli_epi32(s, 20), b6vec)),
-              _mm_and_si128(_mm_srli_epi32(s, 17), b5vec)),
-            _mm_and_si128(_mm_srli_epi32(s, 14), b4vec)),
-          _mm_and_si128(_mm_srli_epi32(s, 11), b3vec)),
-        _mm_and_si128(_mm_srli_epi32(s, 8), b2vec)),
-      _mm_and_si128(_mm_srli_epi32(s, 5), b1vec)),
-    _mm_and_si128(_mm_srli_epi32(s, 2), b0vec));
-
-  const __m128i sd = _mm_xor_si128(
-    _mm_xor_si128(
-      _mm_xor_si128(
-        _mm_xor_si128(
-          _mm_xor_si128(
-            _mm_xor_si128(
-              _mm_xor_si128(_mm_and_si128(_mm_srli_epi32(s, 24), b7vec),
-                            _mm_and_si128(_mm_srli_epi32(s, 21), b6vec)),
-              _mm_and_si128(_mm_srli_epi32(s, 18), b5vec)),
-            _mm_and_si128(_mm_srli_epi32(s, 15), b4vec)),
-          _mm_and_si128(_mm_srli_epi32(s, 12), b3vec)),
-        _mm_and_si128(_mm_srli_epi32(s, 9), b2vec)),
-      _mm_and_si128(_mm_srli_epi32(s, 6), b1vec)),
-    _mm_and_si128(_mm_srli_epi32(s, 3), b0vec));
-
-#if defined __AVX2__
-#pragma message("AVX2 is available")
-
-  constexpr uint32_t shla[]{ 0, 8, 16, 24 };
-  constexpr uint32_t shlb[]{ 24, 0, 8, 16 };
-  constexpr uint32_t shlc[]{ 16, 24, 0, 8 };
-  constexpr uint32_t shld[]{ 8, 16, 24, 0 };
-
-  const __m128i shla_ = _mm_load_si128((__m128i*)shla);
-  const __m128i shlb_ = _mm_load_si128((__m128i*)shlb);
-  const __m128i shlc_ = _mm_load_si128((__m128i*)shlc);
-  const __m128i shld_ = _mm_load_si128((__m128i*)shld);
-
-  auto t0 = _mm_xor_si128(_mm_sllv_epi32(sa, shla_), _mm_sllv_epi32(sb, shlb_));
-  auto t1 = _mm_xor_si128(_mm_sllv_epi32(sc, shlc_), _mm_sllv_epi32(sd, shld_));
-  const auto t2 = _mm_xor_si128(t0, t1);
-
-  _mm_store_si128((__m128i*)st->cipher, t2);
-
-#else
-
-  uint32_t sa_[4]{};
-  uint32_t sb_[4]{};
-  uint32_t sc_[4]{};
-  uint32_t sd_[4]{};
-
-  _mm_store_si128((__m128i*)sa_, sa);
-  _mm_store_si128((__m128i*)sb_, sb);
-  _mm_store_si128((__m128i*)sc_, sc);
-  _mm_store_si128((__m128i*)sd_, sd);
-
-  st->cipher[0] = (sb_[0] << 24) ^ (sc_[0] << 16) ^ (sd_[0] << 8) ^ sa_[0];
-  st->cipher[1] = (sc_[1] << 24) ^ (sd_[1] << 16) ^ (sa_[1] << 8) ^ sb_[1];
-  st->cipher[2] = (sd_[2] << 24) ^ (sa_[2] << 16) ^ (sb_[2] << 8) ^ sc_[2];
-  st->cipher[3] = (sa_[3] << 24) ^ (sb_[3] << 16) ^ (sc_[3] << 8) ^ sd_[3];
+  uint32_t t0 = 0u;
+  uint32_t t1 = 0u;
+  uint32_t t2 = 0u;
+  uint32_t t3 = 0u;
 
-#endif
+  for (size_t i = 0; i < 32; i++) {
+    t0 |= ((st->cipher[0] >> BIT_PERM_S0[i]) & 0b1u) << i;
+    t1 |= ((st->cipher[1] >> BIT_PERM_S1[i]) & 0b1u) << i;
+    t2 |= ((st->cipher[2] >> BIT_PERM_S2[i]) & 0b1u) << i;
+    t3 |= ((st->cipher[3] >> BIT_PERM_S3[i]) & 0b1u) << i;
+  }
 
-#else
+  st->cipher[0] = t0;
+  st->cipher[1] = t1;
+  st->cipher[2] = t2;
+  st->cipher[3] = t3;
+}
 
+// PermBits, scalar implementation, which collects permuted bits of each byte of
+// output word, using shifts and masks
+GIFT_COFB_INLINE constexpr void
+perm_bits_scalar(state_t* const st)
+{
   const uint32_t s0 = st->cipher[0];
   const uint32_t s1 = st->cipher[1];
   const uint32_t s2 = st->cipher[2];
@@ -385,15 +281,200 @@ perm_bits(state_t* const st)
   st->cipher[1] = (s1b3 << 24) ^ (s1b2 << 16) ^ (s1b1 << 8) ^ s1b0;
   st->cipher[2] = (s2b3 << 24) ^ (s2b2 << 16) ^ (s2b1 << 8) ^ s2b0;
   st->cipher[3] = (s3b3 << 24) ^ (s3b2 << 16) ^ (s3b1 << 8) ^ s3b0;
+}
+
+// Gathers every fourth bit ( i.e. bit 0, 4, 8 ... 28 ) of 32 -bit word into
+// lowest 8 -bits of result
+GIFT_COFB_INLINE constexpr uint32_t
+gather_nibble_bits(const uint32_t x)
+{
+  uint32_t t = x & 0x11111111u;
+
+  t = (t | (t >> 3)) & 0x03030303u;
+  t = (t | (t >> 6)) & 0x000f000fu;
+  t = (t | (t >> 12)) & 0x000000ffu;
+
+  return t;
+}
+
+// PermBits, size optimised implementation, used by small build profile ( see
+// `perm_bits` ), which runs same gather of every fourth bit ( see
+// `perm_word` ) for each byte of each output word, in a loop, instead of
+// unrolled expressions of other implementations
+GIFT_COFB_INLINE constexpr void
+perm_bits_small(state_t* const st)
+{
+  for (size_t j = 0; j < 4; j++) {
+    const uint32_t x = st->cipher[j];
+    uint32_t t = 0u;
+
+    for (size_t c = 0; c < 4; c++) {
+      t |= gather_nibble_bits(x >> ((j - c) & 3)) << (c << 3);
+    }
+
+    st->cipher[j] = t;
+  }
+}
+
+#if defined __SSE2__
+
+// Collects permuted bits of each byte of output words, for all four words of
+// cipher state at once, using SSE2 intrinsics; see `perm_bits_scalar`
+GIFT_COFB_INLINE void
+perm_bits_sse2_gather(const state_t* const st,
+                      __m128i* const __restrict sa_out,
+                      __m128i* const __restrict sb_out,
+                      __m128i* const __restrict sc_out,
+                      __m128i* const __restrict sd_out)
+{
+  constexpr uint32_t b7arr[]{ B7, B7, B7, B7 };
+  constexpr uint32_t b6arr[]{ B6, B6, B6, B6 };
+  constexpr uint32_t b5arr[]{ B5, B5, B5, B5 };
+  constexpr uint32_t b4arr[]{ B4, B4, B4, B4 };
+  constexpr uint32_t b3arr[]{ B3, B3, B3, B3 };
+  constexpr uint32_t b2arr[]{ B2, B2, B2, B2 };
+  constexpr uint32_t b1arr[]{ B1, B1, B1, B1 };
+  constexpr uint32_t b0arr[]{ B0, B0, B0, B0 };
+
+  const __m128i b7vec = _mm_loadu_si128((__m128i*)b7arr);
+  const __m128i b6vec = _mm_loadu_si128((__m128i*)b6arr);
+  const __m128i b5vec = _mm_loadu_si128((__m128i*)b5arr);
+  const __m128i b4vec = _mm_loadu_si128((__m128i*)b4arr);
+  const __m128i b3vec = _mm_loadu_si128((__m128i*)b3arr);
+  const __m128i b2vec = _mm_loadu_si128((__m128i*)b2arr);
+  const __m128i b1vec = _mm_loadu_si128((__m128i*)b1arr);
+  const __m128i b0vec = _mm_loadu_si128((__m128i*)b0arr);
+
+  const __m128i s = _mm_loadu_si128((__m128i*)st->cipher);
+
+  const __m128i sa = _mm_xor_si128(
+    _mm_xor_si128(
+      _mm_xor_si128(
+        _mm_xor_si128(
+          _mm_xor_si128(
+            _mm_xor_si128(
+              _mm_xor_si128(_mm_and_si128(_mm_srli_epi32(s, 21), b7vec),
+                            _mm_and_si128(_mm_srli_epi32(s, 18), b6vec)),
+              _mm_and_si128(_mm_srli_epi32(s, 15), b5vec)),
+            _mm_and_si128(_mm_srli_epi32(s, 12), b4vec)),
+          _mm_and_si128(_mm_srli_epi32(s, 9), b3vec)),
+        _mm_and_si128(_mm_srli_epi32(s, 6), b2vec)),
+      _mm_and_si128(_mm_srli_epi32(s, 3), b1vec)),
+    _mm_and_si128(_mm_srli_epi32(s, 0), b0vec));
+
+  const __m128i sb = _mm_xor_si128(
+    _mm_xor_si128(
+      _mm_xor_si128(
+        _mm_xor_si128(
+          _mm_xor_si128(
+            _mm_xor_si128(
+              _mm_xor_si128(_mm_and_si128(_mm_srli_epi32(s, 22), b7vec),
+                            _mm_and_si128(_mm_srli_epi32(s, 19), b6vec)),
+              _mm_and_si128(_mm_srli_epi32(s, 16), b5vec)),
+            _mm_and_si128(_mm_srli_epi32(s, 13), b4vec)),
+          _mm_and_si128(_mm_srli_epi32(s, 10), b3vec)),
+        _mm_and_si128(_mm_srli_epi32(s, 7), b2vec)),
+      _mm_and_si128(_mm_srli_epi32(s, 4), b1vec)),
+    _mm_and_si128(_mm_srli_epi32(s, 1), b0vec));
+
+  const __m128i sc = _mm_xor_si128(
+    _mm_xor_si128(
+      _mm_xor_si128(
+        _mm_xor_si128(
+          _mm_xor_si128(
+            _mm_xor_si128(
+              _mm_xor_si128(_mm_and_si128(_mm_srli_epi32(s, 23), b7vec),
+                            _mm_and_si128(_mm_srli_epi32(s, 20), b6vec)),
+              _mm_and_si128(_mm_srli_epi32(s, 17), b5vec)),
+            _mm_and_si128(_mm_srli_epi32(s, 14), b4vec)),
+          _mm_and_si128(_mm_srli_epi32(s, 11), b3vec)),
+        _mm_and_si128(_mm_srli_epi32(s, 8), b2vec)),
+      _mm_and_si128(_mm_srli_epi32(s, 5), b1vec)),
+    _mm_and_si128(_mm_srli_epi32(s, 2), b0vec));
+
+  const __m128i sd = _mm_xor_si128(
+    _mm_xor_si128(
+      _mm_xor_si128(
+        _mm_xor_si128(
+          _mm_xor_si128(
+            _mm_xor_si128(
+              _mm_xor_si128(_mm_and_si128(_mm_srli_epi32(s, 24), b7vec),
+                            _mm_and_si128(_mm_srli_epi32(s, 21), b6vec)),
+              _mm_and_si128(_mm_srli_epi32(s, 18), b5vec)),
+            _mm_and_si128(_mm_srli_epi32(s, 15), b4vec)),
+          _mm_and_si128(_mm_srli_epi32(s, 12), b3vec)),
+        _mm_and_si128(_mm_srli_epi32(s, 9), b2vec)),
+      _mm_and_si128(_mm_srli_epi32(s, 6), b1vec)),
+    _mm_and_si128(_mm_srli_epi32(s, 3), b0vec));
+
+  *sa_out = sa;
+  *sb_out = sb;
+  *sc_out = sc;
+  *sd_out = sd;
+}
+
+// PermBits, SSE2 implementation, gathering permuted bits with 128 -bit vector
+// intrinsics and placing collected bytes with scalar shifts
+GIFT_COFB_INLINE void
+perm_bits_sse2(state_t* const st)
+{
+  __m128i sa, sb, sc, sd;
+  perm_bits_sse2_gather(st, &sa, &sb, &sc, &sd);
+
+  uint32_t sa_[4]{};
+  uint32_t sb_[4]{};
+  uint32_t sc_[4]{};
+  uint32_t sd_[4]{};
+
+  _mm_storeu_si128((__m128i*)sa_, sa);
+  _mm_storeu_si128((__m128i*)sb_, sb);
+  _mm_storeu_si128((__m128i*)sc_, sc);
+  _mm_storeu_si128((__m128i*)sd_, sd);
+
+  st->cipher[0] = (sb_[0] << 24) ^ (sc_[0] << 16) ^ (sd_[0] << 8) ^ sa_[0];
+  st->cipher[1] = (sc_[1] << 24) ^ (sd_[1] << 16) ^ (sa_[1] << 8) ^ sb_[1];
+  st->cipher[2] = (sd_[2] << 24) ^ (sa_[2] << 16) ^ (sb_[2] << 8) ^ sc_[2];
+  st->cipher[3] = (sa_[3] << 24) ^ (sb_[3] << 16) ^ (sc_[3] << 8) ^ sd_[3];
+}
+
+#if defined __AVX2__
+
+// PermBits, AVX2 implementation, gathering permuted bits with SSE2 intrinsics
+// and placing collected bytes with per-lane variable shifts of AVX2
+GIFT_COFB_INLINE void
+perm_bits_avx2(state_t* const st)
+{
+  __m128i sa, sb, sc, sd;
+  perm_bits_sse2_gather(st, &sa, &sb, &sc, &sd);
+
+  constexpr uint32_t shla[]{ 0, 8, 16, 24 };
+  constexpr uint32_t shlb[]{ 24, 0, 8, 16 };
+  constexpr uint32_t shlc[]{ 16, 24, 0, 8 };
+  constexpr uint32_t shld[]{ 8, 16, 24, 0 };
+
+  const __m128i shla_ = _mm_loadu_si128((__m128i*)shla);
+  const __m128i shlb_ = _mm_loadu_si128((__m128i*)shlb);
+  const __m128i shlc_ = _mm_loadu_si128((__m128i*)shlc);
+  const __m128i shld_ = _mm_loadu_si128((__m128i*)shld);
+
+  auto t0 = _mm_xor_si128(_mm_sllv_epi32(sa, shla_), _mm_sllv_epi32(sb, shlb_));
+  auto t1 = _mm_xor_si128(_mm_sllv_epi32(sc, shlc_), _mm_sllv_epi32(sd, shld_));
+  const auto t2 = _mm_xor_si128(t0, t1);
+
+  _mm_storeu_si128((__m128i*)st->cipher, t2);
+}
 
 #endif
 
-#else
-#pragma message("Compiling for non-x86_64")
+#endif
 
 #if defined __ARM_NEON
-#pragma message("ARM NEON is available")
 
+// PermBits, ARM NEON implementation, gathering permuted bits with 128 -bit
+// vector intrinsics and placing collected bytes with scalar shifts
+GIFT_COFB_INLINE void
+perm_bits_neon(state_t* const st)
+{
   constexpr uint32_t b7arr[]{ B7, B7, B7, B7 };
   constexpr uint32_t b6arr[]{ B6, B6, B6, B6 };
   constexpr uint32_t b5arr[]{ B5, B5, B5, B5 };
@@ -481,25 +562,66 @@ perm_bits(state_t* const st)
   st->cipher[3] = (vgetq_lane_u32(sa, 3) << 24) ^
                   (vgetq_lane_u32(sb, 3) << 16) ^ (vgetq_lane_u32(sc, 3) << 8) ^
                   vgetq_lane_u32(sd, 3);
+}
+
+#endif
+
+// Four different 32 -bit bit permutations are independently applied on each
+// word of cipher state of GIFT-128 block cipher, using best implementation
+// available on target CPU, unless small build profile is selected, by defining
+// GIFT_COFB_SMALL, which trades speed for code size
+//
+// See PermBits specification defined in page 6 of GIFT-COFB specification
+// https://csrc.nist.gov/CSRC/media/Projects/lightweight-cryptography/documents/finalist-round/updated-spec-doc/gift-cofb-spec-final.pdf
+GIFT_COFB_INLINE constexpr void
+perm_bits(state_t* const st)
+{
+  // SIMD intrinsics can't be evaluated at compile-time, so that constant
+  // evaluation ( say of a `static_assert` ) takes portable scalar path
+  if (std::is_constant_evaluated()) {
+    perm_bits_scalar(st);
+    return;
+  }
+
+#if defined GIFT_COFB_SMALL
+#pragma message("Size optimised profile is selected")
+
+  perm_bits_small(st);
+
+#elif defined __x86_64__
+#pragma message("Compiling for x86_64")
+
+#if defined __SSE2__
+#pragma message("SSE2 is available")
+
+#if defined __AVX2__
+#pragma message("AVX2 is available")
+
+  perm_bits_avx2(st);
 
 #else
 
-  uint32_t t0 = 0u;
-  uint32_t t1 = 0u;
-  uint32_t t2 = 0u;
-  uint32_t t3 = 0u;
+  perm_bits_sse2(st);
 
-  for (size_t i = 0; i < 32; i++) {
-    t0 |= ((st->cipher[0] >> BIT_PERM_S0[i]) & 0b1u) << i;
-    t1 |= ((st->cipher[1] >> BIT_PERM_S1[i]) & 0b1u) << i;
-    t2 |= ((st->cipher[2] >> BIT_PERM_S2[i]) & 0b1u) << i;
-    t3 |= ((st->cipher[3] >> BIT_PERM_S3[i]) & 0b1u) << i;
-  }
+#endif
 
-  st->cipher[0] = t0;
-  st->cipher[1] = t1;
-  st->cipher[2] = t2;
-  st->cipher[3] = t3;
+#else
+
+  perm_bits_scalar(st);
+
+#endif
+
+#else
+#pragma message("Compiling for non-x86_64")
+
+#if defined __ARM_NEON
+#pragma message("ARM NEON is available")
+
+  perm_bits_neon(st);
+
+#else
+
+  perm_bits_ref(st);
 
 #endif
 
@@ -512,7 +634,7 @@ perm_bits(state_t* const st)
 //
 // See page 6 of GIFT-COFB specification
 // https://csrc.nist.gov/CSRC/media/Projects/lightweight-cryptography/documents/finalist-round/updated-spec-doc/gift-cofb-spec-final.pdf
-inline static void
+GIFT_COFB_INLINE constexpr void
 add_round_keys(state_t* const st, const size_t r_idx)
 {
   const uint32_t u = (static_cast<uint32_t>(st->key[2]) << 16) |
@@ -530,15 +652,15 @@ add_round_keys(state_t* const st, const size_t r_idx)
 // GIFT-128 key state updation function, as defined in top of page 7 of
 // GIFT-COFB specification
 // https://csrc.nist.gov/CSRC/media/Projects/lightweight-cryptography/documents/finalist-round/updated-spec-doc/gift-cofb-spec-final.pdf
-inline static void
+GIFT_COFB_INLINE constexpr void
 update_key_state(state_t* const st)
 {
   const uint16_t t0 = std::rotr(st->key[6], 2);
   const uint16_t t1 = std::rotr(st->key[7], 12);
 
-  uint16_t tmp[6];
-  std::memcpy(tmp, st->key, sizeof(tmp));
-  std::memcpy(st->key + 2, tmp, sizeof(tmp));
+  for (size_t i = 7; i > 1; i--) {
+    st->key[i] = st->key[i - 2];
+  }
 
   st->key[0] = t0;
   st->key[1] = t1;
@@ -552,7 +674,7 @@ update_key_state(state_t* const st)
 //
 // See section 2.4.1 of GIFT-COFB specification
 // https://csrc.nist.gov/CSRC/media/Projects/lightweight-cryptography/documents/finalist-round/updated-spec-doc/gift-cofb-spec-final.pdf
-inline static void
+GIFT_COFB_INLINE constexpr void
 round(state_t* const st, const size_t r_idx)
 {
   sub_cells(st);
@@ -568,7 +690,7 @@ round(state_t* const st, const size_t r_idx)
 // See section 2.4.1 of GIFT-COFB specification
 // https://csrc.nist.gov/CSRC/media/Projects/lightweight-cryptography/documents/finalist-round/updated-spec-doc/gift-cofb-spec-final.pdf
 template<const size_t R>
-inline static void
+GIFT_COFB_INLINE constexpr void
 permute(state_t* const st)
 {
   for (size_t i = 0; i < R; i++) {
@@ -576,4 +698,477 @@ permute(state_t* const st)
   }
 }
 
+// GIFT-128 round keys ( U, V ) for each of 40 rounds, computed ahead of time
+// from 128 -bit secret key, so that rounds can be applied in any order and key
+// state doesn't need to be carried along with cipher state
+struct round_keys_t
+{
+  uint32_t u[ROUNDS];
+  uint32_t v[ROUNDS];
+};
+
+// Expands 128 -bit secret key into round keys of all 40 rounds, by running
+// GIFT-128 key schedule, as defined in page 6, 7 of GIFT-COFB specification
+// https://csrc.nist.gov/CSRC/media/Projects/lightweight-cryptography/documents/finalist-round/updated-spec-doc/gift-cofb-spec-final.pdf
+//
+// It can be evaluated at compile-time, so that round keys of a fixed key are
+// embedded as constants
+GIFT_COFB_INLINE constexpr void
+expand_key(round_keys_t* const __restrict rk, // GIFT-128 round keys
+           const uint8_t* const __restrict key // 128 -bit secret key
+)
+{
+  state_t st;
+
+  for (size_t i = 0; i < 8; i++) {
+    const size_t boff = i << 1;
+
+    st.key[i] = (static_cast<uint16_t>(key[boff ^ 0]) << 8) |
+                (static_cast<uint16_t>(key[boff ^ 1]) << 0);
+  }
+
+  for (size_t i = 0; i < ROUNDS; i++) {
+    rk->u[i] = (static_cast<uint32_t>(st.key[2]) << 16) |
+               (static_cast<uint32_t>(st.key[3]) << 0);
+    rk->v[i] = (static_cast<uint32_t>(st.key[6]) << 16) |
+               (static_cast<uint32_t>(st.key[7]) << 0);
+
+    update_key_state(&st);
+  }
+}
+
+// Adds precomputed round key of r -th round and round constant to cipher state
+// of GIFT-128 block cipher; as it's only XOR, same routine also undoes it
+GIFT_COFB_INLINE constexpr void
+add_round_keys(state_t* const st,
+               const round_keys_t* const rk,
+               const size_t r_idx)
+{
+  st->cipher[2] ^= rk->u[r_idx];
+  st->cipher[1] ^= rk->v[r_idx];
+
+  st->cipher[3] ^= (1u << 31) | static_cast<uint32_t>(RC[r_idx]);
+}
+
+// Inverse of GIFT-128 SubCells, obtained by applying instructions of
+// `sub_cells` in reverse order, where each of them is self-inverse
+GIFT_COFB_INLINE constexpr void
+inv_sub_cells(state_t* const st)
+{
+  std::swap(st->cipher[0], st->cipher[3]);
+
+  const uint32_t t3 = st->cipher[0] & st->cipher[1];
+  st->cipher[2] ^= t3;
+
+  st->cipher[3] = ~st->cipher[3];
+  st->cipher[1] ^= st->cipher[3];
+  st->cipher[3] ^= st->cipher[2];
+
+  const uint32_t t2 = st->cipher[0] | st->cipher[1];
+  st->cipher[2] ^= t2;
+
+  const uint32_t t1 = st->cipher[1] & st->cipher[3];
+  st->cipher[0] ^= t1;
+
+  const uint32_t t0 = st->cipher[0] & st->cipher[2];
+  st->cipher[1] ^= t0;
+}
+
+// Spreads lowest 8 -bits of 32 -bit word such that bit i lands on bit 4i of
+// result, which undoes `gather_nibble_bits`
+GIFT_COFB_INLINE constexpr uint32_t
+spread_nibble_bits(const uint32_t x)
+{
+  uint32_t t = x & 0x000000ffu;
+
+  t = (t | (t << 12)) & 0x000f000fu;
+  t = (t | (t << 6)) & 0x03030303u;
+  t = (t | (t << 3)) & 0x11111111u;
+
+  return t;
+}
+
+// PermBits, applied on J -th word of cipher state, written as gather of every
+// fourth bit into each byte of result; in table 2.2 of GIFT-COFB specification,
+// byte c of permuted J -th word collects input bits 4i + ((J - c) mod 4)
+template<const size_t J>
+GIFT_COFB_INLINE constexpr uint32_t
+perm_word(const uint32_t x)
+{
+  return (gather_nibble_bits(x >> ((J - 0) & 3)) << 0) |
+         (gather_nibble_bits(x >> ((J - 1) & 3)) << 8) |
+         (gather_nibble_bits(x >> ((J - 2) & 3)) << 16) |
+         (gather_nibble_bits(x >> ((J - 3) & 3)) << 24);
+}
+
+// Inverse of PermBits, applied on J -th word of cipher state i.e. each byte c
+// of input is spread back to bits 4i + ((J - c) mod 4) of result
+template<const size_t J>
+GIFT_COFB_INLINE constexpr uint32_t
+inv_perm_word(const uint32_t x)
+{
+  return (spread_nibble_bits(x >> 0) << ((J - 0) & 3)) |
+         (spread_nibble_bits(x >> 8) << ((J - 1) & 3)) |
+         (spread_nibble_bits(x >> 16) << ((J - 2) & 3)) |
+         (spread_nibble_bits(x >> 24) << ((J - 3) & 3));
+}
+
+// Inverse of GIFT-128 PermBits, undoing four different 32 -bit bit
+// permutations, applied on each word of cipher state
+GIFT_COFB_INLINE constexpr void
+inv_perm_bits(state_t* const st)
+{
+  st->cipher[0] = inv_perm_word<0>(st->cipher[0]);
+  st->cipher[1] = inv_perm_word<1>(st->cipher[1]);
+  st->cipher[2] = inv_perm_word<2>(st->cipher[2]);
+  st->cipher[3] = inv_perm_word<3>(st->cipher[3]);
+}
+
+// GIFT-128 round function, using precomputed round key of r -th round
+GIFT_COFB_INLINE constexpr void
+round(state_t* const st, const round_keys_t* const rk, const size_t r_idx)
+{
+  sub_cells(st);
+  perm_bits(st);
+  add_round_keys(st, rk, r_idx);
+}
+
+// Inverse of GIFT-128 round function, undoing r -th round, using precomputed
+// round key of that round
+GIFT_COFB_INLINE constexpr void
+inv_round(state_t* const st, const round_keys_t* const rk, const size_t r_idx)
+{
+  add_round_keys(st, rk, r_idx);
+  inv_perm_bits(st);
+  inv_sub_cells(st);
+}
+
+// GIFT-128 block cipher, applying R iterative rounds on cipher state, while
+// round keys are taken from precomputed key schedule | R <= 40
+template<const size_t R>
+GIFT_COFB_INLINE constexpr void
+permute(state_t* const st, const round_keys_t* const rk)
+{
+  static_assert(R <= ROUNDS, "GIFT-128 has only 40 rounds");
+
+  for (size_t i = 0; i < R; i++) {
+    round(st, rk, i);
+  }
+}
+
+// Inverse of GIFT-128 block cipher, undoing R iterative rounds ( in reverse
+// order i.e. from (R-1) -th round to 0 -th round ) on cipher state, while using
+// precomputed round keys | R <= 40
+template<const size_t R>
+GIFT_COFB_INLINE constexpr void
+inverse_permute(state_t* const st, const round_keys_t* const rk)
+{
+  static_assert(R <= ROUNDS, "GIFT-128 has only 40 rounds");
+
+  for (size_t i = R; i > 0; i--) {
+    inv_round(st, rk, i - 1);
+  }
+}
+
+#if defined GIFT_COFB_COMPILED
+
+// Full 40 -round GIFT-128 and its inverse, instantiated only in compiled
+// library, see `linkage.hpp`
+GIFT_COFB_EXTERN template void permute<ROUNDS>(state_t* const);
+GIFT_COFB_EXTERN template void permute<ROUNDS>(state_t* const,
+                                               const round_keys_t* const);
+GIFT_COFB_EXTERN template void inverse_permute<ROUNDS>(
+  state_t* const,
+  const round_keys_t* const);
+
+#endif
+
+// N -many GIFT-128 cipher states, kept in transposed form i.e. j -th word of
+// all N states are placed next to each other, so that each step of round
+// function is applied on all states at once, letting compiler vectorize it
+// over lanes
+template<const size_t N>
+struct lanes_t
+{
+  alignas(32) uint32_t cipher[4][N];
+};
+
+// Substitutes cells of N -many cipher states, see `sub_cells` above
+template<const size_t N>
+GIFT_COFB_INLINE void
+sub_cells(lanes_t<N>* const st)
+{
+  for (size_t i = 0; i < N; i++) {
+    uint32_t s0 = st->cipher[0][i];
+    uint32_t s1 = st->cipher[1][i];
+    uint32_t s2 = st->cipher[2][i];
+    uint32_t s3 = st->cipher[3][i];
+
+    s1 ^= s0 & s2;
+    s0 ^= s1 & s3;
+    s2 ^= s0 | s1;
+    s3 ^= s2;
+    s1 ^= s3;
+    s3 = ~s3;
+    s2 ^= s0 & s1;
+
+    st->cipher[0][i] = s3;
+    st->cipher[1][i] = s1;
+    st->cipher[2][i] = s2;
+    st->cipher[3][i] = s0;
+  }
+}
+
+// Inverse substitution of cells of N -many cipher states, see `inv_sub_cells`
+template<const size_t N>
+GIFT_COFB_INLINE void
+inv_sub_cells(lanes_t<N>* const st)
+{
+  for (size_t i = 0; i < N; i++) {
+    uint32_t s0 = st->cipher[3][i];
+    uint32_t s1 = st->cipher[1][i];
+    uint32_t s2 = st->cipher[2][i];
+    uint32_t s3 = st->cipher[0][i];
+
+    s2 ^= s0 & s1;
+    s3 = ~s3;
+    s1 ^= s3;
+    s3 ^= s2;
+    s2 ^= s0 | s1;
+    s0 ^= s1 & s3;
+    s1 ^= s0 & s2;
+
+    st->cipher[0][i] = s0;
+    st->cipher[1][i] = s1;
+    st->cipher[2][i] = s2;
+    st->cipher[3][i] = s3;
+  }
+}
+
+// Permutes bits of N -many cipher states, see `perm_word` above
+template<const size_t N>
+GIFT_COFB_INLINE void
+perm_bits(lanes_t<N>* const st)
+{
+  for (size_t i = 0; i < N; i++) {
+    st->cipher[0][i] = perm_word<0>(st->cipher[0][i]);
+    st->cipher[1][i] = perm_word<1>(st->cipher[1][i]);
+    st->cipher[2][i] = perm_word<2>(st->cipher[2][i]);
+    st->cipher[3][i] = perm_word<3>(st->cipher[3][i]);
+  }
+}
+
+// Inverse permutation of bits of N -many cipher states, see `inv_perm_word`
+template<const size_t N>
+GIFT_COFB_INLINE void
+inv_perm_bits(lanes_t<N>* const st)
+{
+  for (size_t i = 0; i < N; i++) {
+    st->cipher[0][i] = inv_perm_word<0>(st->cipher[0][i]);
+    st->cipher[1][i] = inv_perm_word<1>(st->cipher[1][i]);
+    st->cipher[2][i] = inv_perm_word<2>(st->cipher[2][i]);
+    st->cipher[3][i] = inv_perm_word<3>(st->cipher[3][i]);
+  }
+}
+
+// Adds ( or removes ) precomputed round key of r -th round and round constant
+// to N -many cipher states, all of them using same secret key
+template<const size_t N>
+GIFT_COFB_INLINE void
+add_round_keys(lanes_t<N>* const st,
+               const round_keys_t* const rk,
+               const size_t r_idx)
+{
+  const uint32_t u = rk->u[r_idx];
+  const uint32_t v = rk->v[r_idx];
+  const uint32_t c = (1u << 31) | static_cast<uint32_t>(RC[r_idx]);
+
+  for (size_t i = 0; i < N; i++) {
+    st->cipher[2][i] ^= u;
+    st->cipher[1][i] ^= v;
+    st->cipher[3][i] ^= c;
+  }
+}
+
+// Applies R rounds of GIFT-128 on N -many cipher states, all keyed with same
+// precomputed round keys | R <= 40
+template<const size_t R, const size_t N>
+GIFT_COFB_INLINE void
+permute(lanes_t<N>* const st, const round_keys_t* const rk)
+{
+  static_assert(R <= ROUNDS, "GIFT-128 has only 40 rounds");
+
+  for (size_t i = 0; i < R; i++) {
+    sub_cells(st);
+    perm_bits(st);
+    add_round_keys(st, rk, i);
+  }
+}
+
+// Undoes R rounds of GIFT-128 on N -many cipher states, all keyed with same
+// precomputed round keys | R <= 40
+template<const size_t R, const size_t N>
+GIFT_COFB_INLINE void
+inverse_permute(lanes_t<N>* const st, const round_keys_t* const rk)
+{
+  static_assert(R <= ROUNDS, "GIFT-128 has only 40 rounds");
+
+  for (size_t i = R; i > 0; i--) {
+    add_round_keys(st, rk, i - 1);
+    inv_perm_bits(st);
+    inv_sub_cells(st);
+  }
+}
+
+// Applies R rounds of GIFT-128, starting at r -th round ( i.e. rounds r, r + 1
+// ... r + R - 1, using their round keys and round constants ), on N -many
+// cipher states, all keyed with same precomputed round keys, where both are
+// only known at run-time, say in reduced-round cryptanalysis | r + R <= 40
+template<const size_t N>
+GIFT_COFB_INLINE void
+permute(lanes_t<N>* const st,
+        const round_keys_t* const rk,
+        const size_t from, // r
+        const size_t cnt   // R
+)
+{
+  for (size_t i = from; i < from + cnt; i++) {
+    sub_cells(st);
+    perm_bits(st);
+    add_round_keys(st, rk, i);
+  }
+}
+
+// Undoes R rounds of GIFT-128, starting at r -th round ( i.e. rounds r + R - 1
+// ... r + 1, r, in that order ), on N -many cipher states, all keyed with same
+// precomputed round keys, see `permute` above | r + R <= 40
+template<const size_t N>
+GIFT_COFB_INLINE void
+inverse_permute(lanes_t<N>* const st,
+                const round_keys_t* const rk,
+                const size_t from, // r
+                const size_t cnt   // R
+)
+{
+  for (size_t i = from + cnt; i > from; i--) {
+    add_round_keys(st, rk, i - 1);
+    inv_perm_bits(st);
+    inv_sub_cells(st);
+  }
+}
+
+// Round keys ( U, V ) of all 40 rounds, for N -many cipher states, each keyed
+// with its own secret key, kept in transposed form i.e. round keys of same
+// round, for all N states, are placed next to each other
+template<const size_t N>
+struct lane_keys_t
+{
+  alignas(32) uint32_t u[ROUNDS][N];
+  alignas(32) uint32_t v[ROUNDS][N];
+};
+
+// N -many GIFT-128 key states, kept in transposed form i.e. j -th 16 -bit word
+// of all N key states are placed next to each other
+template<const size_t N>
+struct lane_key_state_t
+{
+  alignas(32) uint16_t key[8][N];
+};
+
+// Updates N -many key states, see `update_key_state` above
+template<const size_t N>
+GIFT_COFB_INLINE void
+update_key_state(lane_key_state_t<N>* const ks)
+{
+  uint16_t t0[N], t1[N];
+
+  for (size_t i = 0; i < N; i++) {
+    t0[i] = std::rotr(ks->key[6][i], 2);
+    t1[i] = std::rotr(ks->key[7][i], 12);
+  }
+
+  std::memmove(ks->key[2], ks->key[0], 6 * sizeof(ks->key[0]));
+  std::memcpy(ks->key[0], t0, sizeof(t0));
+  std::memcpy(ks->key[1], t1, sizeof(t1));
+}
+
+// Expands N -many 128 -bit secret keys ( i -th one keying i -th lane ) into
+// per-lane round keys of all 40 rounds, by running GIFT-128 key schedule on
+// transposed key states, so that all keys are expanded at once
+template<const size_t N>
+GIFT_COFB_INLINE void
+expand_keys(lane_keys_t<N>* const __restrict rk,
+            const uint8_t* const* const __restrict keys // N x 128 -bit keys
+)
+{
+  lane_key_state_t<N> ks;
+
+  for (size_t i = 0; i < N; i++) {
+    for (size_t j = 0; j < 8; j++) {
+      const size_t boff = j << 1;
+
+      ks.key[j][i] = (static_cast<uint16_t>(keys[i][boff ^ 0]) << 8) |
+                     (static_cast<uint16_t>(keys[i][boff ^ 1]) << 0);
+    }
+  }
+
+  for (size_t r = 0; r < ROUNDS; r++) {
+    for (size_t i = 0; i < N; i++) {
+      rk->u[r][i] = (static_cast<uint32_t>(ks.key[2][i]) << 16) |
+                    (static_cast<uint32_t>(ks.key[3][i]) << 0);
+      rk->v[r][i] = (static_cast<uint32_t>(ks.key[6][i]) << 16) |
+                    (static_cast<uint32_t>(ks.key[7][i]) << 0);
+    }
+
+    update_key_state(&ks);
+  }
+}
+
+// Adds ( or removes ) per-lane round key of r -th round and round constant to
+// N -many cipher states, each of them using its own secret key
+template<const size_t N>
+GIFT_COFB_INLINE void
+add_round_keys(lanes_t<N>* const st,
+               const lane_keys_t<N>* const rk,
+               const size_t r_idx)
+{
+  const uint32_t c = (1u << 31) | static_cast<uint32_t>(RC[r_idx]);
+
+  for (size_t i = 0; i < N; i++) {
+    st->cipher[2][i] ^= rk->u[r_idx][i];
+    st->cipher[1][i] ^= rk->v[r_idx][i];
+    st->cipher[3][i] ^= c;
+  }
+}
+
+// Applies R rounds of GIFT-128 on N -many cipher states, each keyed with its
+// own precomputed round keys | R <= 40
+template<const size_t R, const size_t N>
+GIFT_COFB_INLINE void
+permute(lanes_t<N>* const st, const lane_keys_t<N>* const rk)
+{
+  static_assert(R <= ROUNDS, "GIFT-128 has only 40 rounds");
+
+  for (size_t i = 0; i < R; i++) {
+    sub_cells(st);
+    perm_bits(st);
+    add_round_keys(st, rk, i);
+  }
+}
+
+// Undoes R rounds of GIFT-128 on N -many cipher states, each keyed with its
+// own precomputed round keys | R <= 40
+template<const size_t R, const size_t N>
+GIFT_COFB_INLINE void
+inverse_permute(lanes_t<N>* const st, const lane_keys_t<N>* const rk)
+{
+  static_assert(R <= ROUNDS, "GIFT-128 has only 40 rounds");
+
+  for (size_t i = R; i > 0; i--) {
+    add_round_keys(st, rk, i - 1);
+    inv_perm_bits(st);
+    inv_sub_cells(st);
+  }
+}
+
 }
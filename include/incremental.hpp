@@ -0,0 +1,411 @@
+#pragma once
+#include "aead.hpp"
+#include "common.hpp"
+#include "random.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Incremental GIFT-COFB, for streams too long to be sealed/ opened in one call,
+// where associated data and then plain ( or encrypted ) text are fed in chunks
+// of any length, while everything one-shot `encrypt`/ `decrypt` keep on their
+// stack ( chaining value Y, masking offset L, phase and last, possibly partial,
+// block, which is held back until it's known whether it's the final one ) lives
+// in a context. Output is produced for every byte as soon as it's fed.
+//
+// In-progress context can be exported as a fixed-size opaque checkpoint and
+// imported later, say in another process, on another machine, so that a long
+// job can be resumed from where it was pre-empted. Checkpoint is
+//
+// magic || version ( 4 -bytes ) || nonce ( 16 -bytes ) || encrypted state ||
+// tag ( 16 -bytes )
+//
+// i.e. context is itself sealed, using GIFT-COFB, under stream's secret key,
+// with a fresh random nonce and header as associated data, so that it doesn't
+// leak chaining value or masking offset, while truncated, corrupted or forged
+// checkpoints, ones made under some other key and ones of an unknown version
+// are all rejected on import.
+namespace gift_cofb_incremental {
+
+// Version of checkpoint format, bumped whenever state layout changes
+constexpr uint8_t VERSION = 1;
+
+// Header of checkpoint, i.e. 3 -bytes magic followed by version
+constexpr uint8_t HEADER[]{ 'G', 'C', 'K', VERSION };
+
+// Byte length of checkpoint header
+constexpr size_t HEADER_LEN = sizeof(HEADER);
+
+// Byte length of serialised context, before it's encrypted
+constexpr size_t STATE_LEN = 64;
+
+// Byte length of checkpoint
+constexpr size_t CHECKPOINT_LEN = HEADER_LEN + 16 + STATE_LEN + 16;
+
+// Phase of incremental encryption/ decryption
+enum phase_t : uint8_t
+{
+  DATA = 0, // absorbing associated data
+  TEXT,     // encrypting/ decrypting text
+  DONE      // tag is computed, context is wiped
+};
+
+// In-progress GIFT-COFB encryption or decryption, under one secret key and one
+// nonce, where last block of associated data ( in DATA phase ) or of plain
+// text ( in TEXT phase ) is held back in buffer, as offset of final block
+// differs from offset of others
+struct context_t
+{
+  uint16_t kst[8]; // GIFT-128 key state
+  gift_cofb_common::block_t y;
+  uint64_t l;
+  uint8_t buf[16];
+  size_t buflen;
+  uint64_t dlen;  // associated data bytes fed so far
+  uint64_t ctlen; // text bytes fed so far
+  phase_t phase;
+  bool decrypting;
+};
+
+// Zeroes N -bytes of secret material, in a way compiler can't drop as a dead
+// store
+inline static void
+wipe(void* const ptr, const size_t len)
+{
+  std::memset(ptr, 0, len);
+  asm volatile("" : : "r"(ptr) : "memory");
+}
+
+// Starts incremental encryption ( or decryption, when `decrypting` is set ),
+// under 128 -bit secret key and 128 -bit nonce
+inline static void
+init(context_t* const ctx,
+     const uint8_t* const __restrict key,   // 128 -bit key
+     const uint8_t* const __restrict nonce, // 128 -bit nonce
+     const bool decrypting = false)
+{
+  using namespace gift_cofb_common;
+
+  load_key(ctx->kst, key);
+
+  ctx->y = encrypt_block(load_block(nonce), ctx->kst);
+  ctx->l = ctx->y.hi;
+  ctx->buflen = 0;
+  ctx->dlen = 0;
+  ctx->ctlen = 0;
+  ctx->phase = DATA;
+  ctx->decrypting = decrypting;
+}
+
+// Absorbs buffered full block, knowing that it's not the final one
+inline static void
+flush(context_t* const ctx)
+{
+  using namespace gift_cofb_common;
+
+  ctx->l = lx2(ctx->l);
+  ctx->y = absorb(ctx->y, ctx->l, load_block(ctx->buf), ctx->kst);
+  ctx->buflen = 0;
+}
+
+// Absorbs final block of associated data ( which is empty, when there's none ),
+// knowing whether any text follows it
+inline static void
+finish_data(context_t* const ctx, const bool text_follows)
+{
+  using namespace gift_cofb_common;
+
+  const size_t n = ctx->buflen;
+
+  // buffer is full only if associated data is non-empty, multiple of 16 -bytes
+  if (n < 16) {
+    ctx->l = lx3(lx3(ctx->l));
+  } else {
+    ctx->l = lx3(ctx->l);
+  }
+
+  if (!text_follows) {
+    ctx->l = lx3(lx3(ctx->l));
+  }
+
+  const block_t blk = pad(load_partial(ctx->buf, n), n);
+  ctx->y = absorb(ctx->y, ctx->l, blk, ctx->kst);
+  ctx->buflen = 0;
+  ctx->phase = TEXT;
+}
+
+// Feeds N -bytes of associated data, returning false, without absorbing any of
+// it, if text has already been fed | N >= 0
+inline static bool
+update_data(context_t* const ctx,
+            const uint8_t* const data, // N -bytes associated data
+            const size_t dlen          // len(data) | >= 0
+)
+{
+  using namespace gift_cofb_common;
+
+  if (ctx->phase != DATA) {
+    return false;
+  }
+
+  ctx->dlen += dlen;
+
+  size_t off = 0;
+  while (off < dlen) {
+    if (ctx->buflen == 16) {
+      flush(ctx);
+    }
+
+    if (ctx->buflen == 0) {
+      // full blocks are absorbed straight from input, as long as more input
+      // follows them
+      while (dlen - off > 16) {
+        ctx->l = lx2(ctx->l);
+        ctx->y = absorb(ctx->y, ctx->l, load_block(data + off), ctx->kst);
+        off += 16;
+      }
+    }
+
+    const size_t n = std::min(16 - ctx->buflen, dlen - off);
+    std::memcpy(ctx->buf + ctx->buflen, data + off, n);
+
+    ctx->buflen += n;
+    off += n;
+  }
+
+  return true;
+}
+
+// Encrypts ( or decrypts ) N -bytes input into output, returning false, without
+// touching output, if tag has already been computed | N >= 0
+//
+// Input and output can be the same buffer ( i.e. in-place ), but they must not
+// partially overlap. While decrypting, output isn't authenticated until
+// `verify` returns true, so it must not be consumed ( or released ) before that
+inline static bool
+update(context_t* const ctx,
+       const uint8_t* const in, // N -bytes plain/ encrypted text
+       uint8_t* const out,      // N -bytes encrypted/ plain text
+       const size_t len         // len(in) = len(out) | >= 0
+)
+{
+  using namespace gift_cofb_common;
+
+  if (ctx->phase == DONE) {
+    return false;
+  }
+  if (len == 0) {
+    return true;
+  }
+
+  if (ctx->phase == DATA) {
+    finish_data(ctx, true);
+  }
+
+  ctx->ctlen += len;
+
+  size_t off = 0;
+  while (off < len) {
+    if (ctx->buflen == 16) {
+      flush(ctx);
+    }
+
+    if (ctx->buflen == 0) {
+      // full blocks are processed straight from input, as long as more input
+      // follows them; plain text block is absorbed, in both directions
+      while (len - off > 16) {
+        const block_t blk = load_block(in + off);
+        const block_t res = blk ^ ctx->y;
+        store_block(res, out + off);
+
+        ctx->l = lx2(ctx->l);
+        ctx->y = absorb(ctx->y, ctx->l, ctx->decrypting ? res : blk, ctx->kst);
+        off += 16;
+      }
+    }
+
+    const size_t n = std::min(16 - ctx->buflen, len - off);
+
+    // bytes of current block are masked with matching bytes of Y
+    uint8_t msk[16];
+    store_block(ctx->y, msk);
+
+    for (size_t i = 0; i < n; i++) {
+      const uint8_t b = in[off + i];
+      const uint8_t r = b ^ msk[ctx->buflen + i];
+
+      out[off + i] = r;
+      ctx->buf[ctx->buflen + i] = ctx->decrypting ? r : b;
+    }
+
+    ctx->buflen += n;
+    off += n;
+  }
+
+  return true;
+}
+
+// Absorbs final block and returns final chaining value i.e. tag
+inline static gift_cofb_common::block_t
+finish_text(context_t* const ctx)
+{
+  using namespace gift_cofb_common;
+
+  if (ctx->phase == DATA) {
+    finish_data(ctx, false);
+    return ctx->y;
+  }
+
+  // in TEXT phase, at least one byte of final block is always buffered
+  const size_t n = ctx->buflen;
+
+  if (n == 16) {
+    ctx->l = lx3(ctx->l);
+  } else {
+    ctx->l = lx3(lx3(ctx->l));
+  }
+
+  const block_t blk = pad(load_partial(ctx->buf, n), n);
+  return absorb(ctx->y, ctx->l, blk, ctx->kst);
+}
+
+// Zeroes context, once tag is computed, so that it can't be fed any further
+inline static void
+retire(context_t* const ctx)
+{
+  wipe(ctx, sizeof(context_t));
+  ctx->phase = DONE;
+}
+
+// Completes incremental encryption, writing 128 -bit authentication tag and
+// wiping context, returning false if context is decrypting or already done
+inline static bool
+finish(context_t* const ctx, uint8_t* const tag)
+{
+  if (ctx->phase == DONE || ctx->decrypting) {
+    return false;
+  }
+
+  gift_cofb_common::store_block(finish_text(ctx), tag);
+  retire(ctx);
+
+  return true;
+}
+
+// Completes incremental decryption, comparing computed tag with received 128
+// -bit tag ( in constant-time ) and wiping context, returning true only if it
+// verifies; context which is encrypting or already done never verifies
+inline static bool
+verify(context_t* const ctx, const uint8_t* const tag)
+{
+  if (ctx->phase == DONE || !ctx->decrypting) {
+    return false;
+  }
+
+  const bool flg = gift_cofb_common::tag_mismatch(finish_text(ctx), tag) != 0;
+  retire(ctx);
+
+  return !flg;
+}
+
+// Exports in-progress context as CHECKPOINT_LEN -bytes opaque checkpoint,
+// which can be imported by `restore`, given same secret key, returning false
+// if context is already done; context itself is left untouched, so that it can
+// be fed further
+//
+// Each checkpoint is sealed under a fresh random nonce, so that checkpointing
+// same context twice produces different bytes
+inline static bool
+checkpoint(const context_t* const ctx, uint8_t* const blob)
+{
+  using namespace gift_cofb_common;
+
+  if (ctx->phase == DONE) {
+    return false;
+  }
+
+  uint8_t state[STATE_LEN]{};
+
+  store_block(ctx->y, state);
+  store_be64(ctx->l, state + 16);
+  store_be64(ctx->dlen, state + 24);
+  store_be64(ctx->ctlen, state + 32);
+  std::memcpy(state + 40, ctx->buf, ctx->buflen);
+  state[56] = static_cast<uint8_t>(ctx->buflen);
+  state[57] = ctx->phase;
+  state[58] = ctx->decrypting;
+
+  uint8_t key[16];
+  store_key(key, ctx->kst);
+
+  uint8_t* const nonce = blob + HEADER_LEN;
+  uint8_t* const enc = nonce + 16;
+
+  std::memcpy(blob, HEADER, HEADER_LEN);
+  gift_cofb_random::fill(nonce, 16);
+  gift_cofb::encrypt(
+    key, nonce, blob, HEADER_LEN, state, enc, STATE_LEN, enc + STATE_LEN);
+
+  wipe(state, sizeof(state));
+  wipe(key, sizeof(key));
+
+  return true;
+}
+
+// Imports CHECKPOINT_LEN -bytes checkpoint, exported by `checkpoint`, into
+// context, under same 128 -bit secret key, returning false, with context left
+// untouched, if checkpoint is of unknown version, doesn't authenticate under
+// given key or holds malformed state; on success, context continues exactly
+// where it was checkpointed, i.e. after `dlen` -bytes associated data and
+// `ctlen` -bytes text
+inline static bool
+restore(context_t* const ctx,
+        const uint8_t* const __restrict key, // 128 -bit key
+        const uint8_t* const __restrict blob // CHECKPOINT_LEN -bytes
+)
+{
+  using namespace gift_cofb_common;
+
+  if (std::memcmp(blob, HEADER, HEADER_LEN) != 0) {
+    return false;
+  }
+
+  const uint8_t* const nonce = blob + HEADER_LEN;
+  const uint8_t* const enc = nonce + 16;
+
+  uint8_t state[STATE_LEN];
+  if (!gift_cofb::decrypt(
+        key, nonce, enc + STATE_LEN, blob, HEADER_LEN, enc, state, STATE_LEN)) {
+    return false;
+  }
+
+  const size_t buflen = state[56];
+  const uint8_t phase = state[57];
+  const uint8_t decrypting = state[58];
+
+  // text phase always holds back at least one byte of final block
+  bool ok = buflen <= 16 && phase <= TEXT && decrypting <= 1;
+  ok &= phase == DATA || buflen > 0;
+  ok &= std::all_of(state + 59, state + STATE_LEN, [](uint8_t b) {
+    return b == 0;
+  });
+
+  if (ok) {
+    load_key(ctx->kst, key);
+
+    ctx->y = load_block(state);
+    ctx->l = load_be64(state + 16);
+    ctx->dlen = load_be64(state + 24);
+    ctx->ctlen = load_be64(state + 32);
+    std::memcpy(ctx->buf, state + 40, 16);
+    ctx->buflen = buflen;
+    ctx->phase = static_cast<phase_t>(phase);
+    ctx->decrypting = decrypting != 0;
+  }
+
+  wipe(state, sizeof(state));
+  return ok;
+}
+
+}
@@ -0,0 +1,271 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined GIFT_COFB_INSTRUMENT
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#if defined __x86_64__
+#include <x86intrin.h>
+#endif
+#endif
+
+// Optional instrumentation of GIFT-COFB hot path, which is compiled in only
+// when GIFT_COFB_INSTRUMENT is defined; otherwise probes placed in `aead.hpp`
+// expand to nothing and only the ( zeroed ) snapshot type remains
+namespace gift_cofb_instrument {
+
+// Phases of GIFT-COFB encrypt/ decrypt routine, whose processed blocks are
+// counted and whose time is ( sampled and ) measured, separately
+enum phase_t : size_t
+{
+  INIT = 0, // E_K(N) i.e. deriving Y[0] and L from nonce
+  AD,       // absorbing associated data blocks, including padded last one
+  MSG,      // processing full plain/ cipher text blocks
+  TAIL,     // processing last ( possibly padded ) plain/ cipher text block
+  TAG,      // producing/ comparing authentication tag
+  PHASES
+};
+
+// Events which are counted, on every call to encrypt/ decrypt routine
+enum counter_t : size_t
+{
+  ENCRYPT_CALLS = 0,
+  DECRYPT_CALLS,
+  PERMUTE_CALLS,
+  AD_BYTES,
+  MSG_BYTES,
+  VERIFY_FAILURES,
+  SAMPLED_CALLS,
+  COUNTERS
+};
+
+// Number of buckets in timing histogram, where i -th bucket counts samples
+// taking [2^(i-1), 2^i) ticks | bucket 0 counts samples taking 0 tick
+constexpr size_t BUCKETS = 64;
+
+// Snapshot of instrumentation counters and histograms, aggregated over all
+// threads; this is a plain array of 64 -bit words, so that it can be passed
+// through C-ABI as it's
+struct stats_t
+{
+  uint64_t counters[COUNTERS];
+  uint64_t blocks[PHASES];
+  uint64_t ticks[PHASES];
+  uint64_t hist[PHASES][BUCKETS];
+};
+
+// Number of 64 -bit words in snapshot of instrumentation data
+constexpr size_t STATS_WORDS = sizeof(stats_t) / sizeof(uint64_t);
+
+#if defined GIFT_COFB_INSTRUMENT
+
+// Timing of every SAMPLE_RATE -th call to encrypt/ decrypt ( on each thread )
+// is recorded, while counters are updated on every call | power of 2
+#if !defined GIFT_COFB_INSTRUMENT_SAMPLE_RATE
+#define GIFT_COFB_INSTRUMENT_SAMPLE_RATE 16
+#endif
+
+constexpr uint64_t SAMPLE_RATE = GIFT_COFB_INSTRUMENT_SAMPLE_RATE;
+static_assert(std::has_single_bit(SAMPLE_RATE), "Sample rate must be 2^i");
+
+// Reads cycle counter ( or its closest equivalent ) of executing CPU core
+inline static uint64_t
+ticks()
+{
+#if defined __x86_64__
+  return __rdtsc();
+#elif defined __aarch64__
+  uint64_t v;
+  asm volatile("mrs %0, cntvct_el0" : "=r"(v));
+  return v;
+#else
+  using namespace std::chrono;
+  const auto t = steady_clock::now().time_since_epoch();
+  return static_cast<uint64_t>(duration_cast<nanoseconds>(t).count());
+#endif
+}
+
+// Per-thread instrumentation data, only written by owning thread, but read ( or
+// reset ) by any thread asking for snapshot; hence relaxed atomics
+struct thread_stats_t
+{
+  std::atomic<uint64_t> words[STATS_WORDS];
+  uint64_t calls = 0;
+
+  thread_stats_t();
+  ~thread_stats_t();
+
+  inline void add(const size_t idx, const uint64_t v)
+  {
+    const uint64_t w = words[idx].load(std::memory_order_relaxed);
+    words[idx].store(w + v, std::memory_order_relaxed);
+  }
+};
+
+// Registry of live threads' instrumentation data, along with accumulated data
+// of threads which have already exited
+struct registry_t
+{
+  std::mutex lock;
+  std::vector<thread_stats_t*> live;
+  uint64_t retired[STATS_WORDS]{};
+};
+
+inline registry_t&
+registry()
+{
+  static registry_t reg;
+  return reg;
+}
+
+inline thread_stats_t::thread_stats_t()
+{
+  for (size_t i = 0; i < STATS_WORDS; i++) {
+    words[i].store(0, std::memory_order_relaxed);
+  }
+
+  registry_t& reg = registry();
+  std::lock_guard<std::mutex> guard(reg.lock);
+  reg.live.push_back(this);
+}
+
+inline thread_stats_t::~thread_stats_t()
+{
+  registry_t& reg = registry();
+  std::lock_guard<std::mutex> guard(reg.lock);
+
+  for (size_t i = 0; i < STATS_WORDS; i++) {
+    reg.retired[i] += words[i].load(std::memory_order_relaxed);
+  }
+
+  std::erase(reg.live, this);
+}
+
+inline thread_stats_t&
+local()
+{
+  thread_local thread_stats_t ts;
+  return ts;
+}
+
+// Offsets of different sections of snapshot, when it's seen as array of words
+constexpr size_t BLOCKS_OFF = offsetof(stats_t, blocks) / sizeof(uint64_t);
+constexpr size_t TICKS_OFF = offsetof(stats_t, ticks) / sizeof(uint64_t);
+constexpr size_t HIST_OFF = offsetof(stats_t, hist) / sizeof(uint64_t);
+
+// Probe, living through one call to encrypt/ decrypt routine, which counts
+// events of that call and, if call is sampled, times its phases
+struct probe_t
+{
+  thread_stats_t& ts;
+  bool sampled;
+  uint64_t mark;
+
+  inline probe_t(const counter_t kind, const size_t dlen, const size_t ctlen)
+    : ts(local())
+  {
+    ts.add(kind, 1);
+    ts.add(AD_BYTES, dlen);
+    ts.add(MSG_BYTES, ctlen);
+
+    sampled = (ts.calls++ & (SAMPLE_RATE - 1)) == 0;
+    ts.add(SAMPLED_CALLS, sampled);
+
+    mark = sampled ? ticks() : 0;
+  }
+
+  // Marks end of phase, which required given number of GIFT-128 permutations
+  inline void phase(const phase_t ph, const size_t blk_cnt)
+  {
+    ts.add(PERMUTE_CALLS, blk_cnt);
+    ts.add(BLOCKS_OFF + ph, blk_cnt);
+
+    if (sampled) {
+      const uint64_t now = ticks();
+      const uint64_t dt = now - mark;
+      const size_t bkt = std::min<size_t>(std::bit_width(dt), BUCKETS - 1);
+
+      ts.add(TICKS_OFF + ph, dt);
+      ts.add(HIST_OFF + ph * BUCKETS + bkt, 1);
+
+      mark = now;
+    }
+  }
+
+  // Records outcome of authentication tag verification
+  inline void verify(const bool failed) { ts.add(VERIFY_FAILURES, failed); }
+};
+
+#endif
+
+// Aggregates instrumentation data of all threads ( live or exited ) into given
+// snapshot, returning false if instrumentation is not compiled in, in which
+// case snapshot is zeroed
+inline static bool
+snapshot(stats_t* const stats)
+{
+  std::memset(stats, 0, sizeof(stats_t));
+
+#if defined GIFT_COFB_INSTRUMENT
+  uint64_t* const words = reinterpret_cast<uint64_t*>(stats);
+
+  registry_t& reg = registry();
+  std::lock_guard<std::mutex> guard(reg.lock);
+
+  for (size_t i = 0; i < STATS_WORDS; i++) {
+    words[i] = reg.retired[i];
+  }
+
+  for (const thread_stats_t* ts : reg.live) {
+    for (size_t i = 0; i < STATS_WORDS; i++) {
+      words[i] += ts->words[i].load(std::memory_order_relaxed);
+    }
+  }
+
+  return true;
+#else
+  return false;
+#endif
+}
+
+// Resets instrumentation data of all threads; note, updates racing with reset
+// may survive it
+inline static void
+reset()
+{
+#if defined GIFT_COFB_INSTRUMENT
+  registry_t& reg = registry();
+  std::lock_guard<std::mutex> guard(reg.lock);
+
+  std::memset(reg.retired, 0, sizeof(reg.retired));
+
+  for (thread_stats_t* ts : reg.live) {
+    for (size_t i = 0; i < STATS_WORDS; i++) {
+      ts->words[i].store(0, std::memory_order_relaxed);
+    }
+  }
+#endif
+}
+
+}
+
+// Probes placed in GIFT-COFB encrypt/ decrypt routines, compiled out when
+// instrumentation is disabled
+#if defined GIFT_COFB_INSTRUMENT
+#define GIFT_COFB_PROBE(kind, dlen, ctlen)                                     \
+  gift_cofb_instrument::probe_t probe_(gift_cofb_instrument::kind, dlen, ctlen)
+#define GIFT_COFB_PROBE_PHASE(ph, blk_cnt)                                     \
+  probe_.phase(gift_cofb_instrument::ph, blk_cnt)
+#define GIFT_COFB_PROBE_VERIFY(failed) probe_.verify(failed)
+#else
+#define GIFT_COFB_PROBE(kind, dlen, ctlen)
+#define GIFT_COFB_PROBE_PHASE(ph, blk_cnt)
+#define GIFT_COFB_PROBE_VERIFY(failed)
+#endif
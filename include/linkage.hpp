@@ -0,0 +1,39 @@
+#pragma once
+
+// Linkage of GIFT-128 ( `gift.hpp` ), GIFT-COFB common ( `common.hpp` ) and
+// GIFT-COFB AEAD ( `aead.hpp` ) routines, in one of two modes
+//
+// ( a ) header-only ( default ), where every routine has internal linkage, so
+// that each translation unit gets its own copy of whatever it uses, and can be
+// built with its own compile-time switches ( say `-march` or DFLAGS )
+//
+// ( b ) compiled library, when GIFT_COFB_COMPILED is defined, where routines
+// get external linkage; small ones stay `inline` ( so that they're still
+// inlined, while linker keeps only one out-of-line copy ), while templated
+// encrypt/ decrypt routines and GIFT-128 permutation are explicitly
+// instantiated only once, in `src/gift_cofb.cpp` ( see `make archive` ), and
+// every other translation unit just links against them
+//
+// In compiled library mode, library and everyone linking against it must be
+// built with same compile-time switches, as routines are shared between them
+#if defined GIFT_COFB_COMPILED
+
+// Small routines, inlined where they're used
+#define GIFT_COFB_INLINE inline
+
+// Large routine templates, instantiated once, in library
+#define GIFT_COFB_API
+
+// Instantiations are only declared, except in library itself
+#if defined GIFT_COFB_BUILD
+#define GIFT_COFB_EXTERN
+#else
+#define GIFT_COFB_EXTERN extern
+#endif
+
+#else
+
+#define GIFT_COFB_INLINE inline static
+#define GIFT_COFB_API static
+
+#endif
@@ -0,0 +1,251 @@
+#pragma once
+#include "gift.hpp"
+
+// GIFT-128 block cipher, used in ECB/ CBC mode of operation, with 128 -bit
+// blocks, for legacy key wrapping and CBC protected records
+namespace gift_modes {
+
+// Number of independent blocks, processed together by inverse ( and forward,
+// when possible ) cipher, kept in transposed form, see `gift::lanes_t`
+constexpr size_t LANES = 8;
+
+// Loads 128 -bit block, interpreting its bytes as four big-endian 32 -bit
+// words, into given lane of N -many cipher states
+template<const size_t N>
+inline static void
+load_block(gift::lanes_t<N>* const __restrict st,
+           const size_t lane,
+           const uint8_t* const __restrict blk)
+{
+  for (size_t i = 0; i < 4; i++) {
+    const size_t boff = i << 2;
+
+    st->cipher[i][lane] = (static_cast<uint32_t>(blk[boff ^ 0]) << 24) |
+                          (static_cast<uint32_t>(blk[boff ^ 1]) << 16) |
+                          (static_cast<uint32_t>(blk[boff ^ 2]) << 8) |
+                          (static_cast<uint32_t>(blk[boff ^ 3]) << 0);
+  }
+}
+
+// Stores given lane of N -many cipher states as 128 -bit block, where each word
+// is written in big-endian byte order, optionally XORing it with another
+// 128 -bit block ( say previous cipher text block, in CBC decryption )
+template<const size_t N>
+inline static void
+store_block(const gift::lanes_t<N>* const __restrict st,
+            const size_t lane,
+            const uint8_t* const __restrict msk, // 128 -bit mask, can be null
+            uint8_t* const __restrict blk)
+{
+  uint8_t tmp[16];
+
+  for (size_t i = 0; i < 4; i++) {
+    const size_t boff = i << 2;
+    const uint32_t w = st->cipher[i][lane];
+
+    tmp[boff ^ 0] = static_cast<uint8_t>(w >> 24);
+    tmp[boff ^ 1] = static_cast<uint8_t>(w >> 16);
+    tmp[boff ^ 2] = static_cast<uint8_t>(w >> 8);
+    tmp[boff ^ 3] = static_cast<uint8_t>(w >> 0);
+  }
+
+  if (msk != nullptr) {
+    for (size_t i = 0; i < 16; i++) {
+      tmp[i] ^= msk[i];
+    }
+  }
+
+  std::memcpy(blk, tmp, sizeof(tmp));
+}
+
+// Given 128 -bit secret key and N -many 128 -bit plain text blocks, this
+// routine encrypts them independently ( i.e. ECB mode ), LANES -many blocks at
+// a time | N >= 0
+inline static void
+ecb_encrypt(const uint8_t* const __restrict key, // 128 -bit secret key
+            const uint8_t* const __restrict txt, // N x 128 -bit plain text
+            uint8_t* const __restrict enc,       // N x 128 -bit cipher text
+            const size_t blk_cnt                 // N | >= 0
+)
+{
+  gift::round_keys_t rk;
+  gift::expand_key(&rk, key);
+
+  gift::lanes_t<LANES> st;
+
+  for (size_t off = 0; off < blk_cnt; off += LANES) {
+    const size_t cnt = std::min(LANES, blk_cnt - off);
+
+    std::memset(&st, 0, sizeof(st));
+    for (size_t i = 0; i < cnt; i++) {
+      load_block(&st, i, txt + ((off + i) << 4));
+    }
+
+    gift::permute<gift::ROUNDS>(&st, &rk);
+
+    for (size_t i = 0; i < cnt; i++) {
+      store_block(&st, i, nullptr, enc + ((off + i) << 4));
+    }
+  }
+}
+
+// Given 128 -bit secret key and N -many 128 -bit cipher text blocks, this
+// routine decrypts them independently ( i.e. ECB mode ), LANES -many blocks at
+// a time | N >= 0
+inline static void
+ecb_decrypt(const uint8_t* const __restrict key, // 128 -bit secret key
+            const uint8_t* const __restrict enc, // N x 128 -bit cipher text
+            uint8_t* const __restrict txt,       // N x 128 -bit plain text
+            const size_t blk_cnt                 // N | >= 0
+)
+{
+  gift::round_keys_t rk;
+  gift::expand_key(&rk, key);
+
+  gift::lanes_t<LANES> st;
+
+  for (size_t off = 0; off < blk_cnt; off += LANES) {
+    const size_t cnt = std::min(LANES, blk_cnt - off);
+
+    std::memset(&st, 0, sizeof(st));
+    for (size_t i = 0; i < cnt; i++) {
+      load_block(&st, i, enc + ((off + i) << 4));
+    }
+
+    gift::inverse_permute<gift::ROUNDS>(&st, &rk);
+
+    for (size_t i = 0; i < cnt; i++) {
+      store_block(&st, i, nullptr, txt + ((off + i) << 4));
+    }
+  }
+}
+
+// Given K -many 128 -bit secret keys and N -many 128 -bit plain text blocks,
+// where i -th block is keyed with secret key at index `key_idx[i]`, this
+// routine encrypts them independently, LANES -many blocks at a time, each lane
+// carrying its own round keys | N >= 0
+inline static void
+ecb_encrypt_keys(const uint8_t* const __restrict keys,     // K x 128 -bit keys
+                 const uint32_t* const __restrict key_idx, // N key indices
+                 const uint8_t* const __restrict txt,      // N x plain text
+                 uint8_t* const __restrict enc,            // N x cipher text
+                 const size_t blk_cnt                      // N | >= 0
+)
+{
+  gift::lane_keys_t<LANES> rk;
+  gift::lanes_t<LANES> st;
+
+  const uint8_t* lane_keys[LANES];
+
+  for (size_t off = 0; off < blk_cnt; off += LANES) {
+    const size_t cnt = std::min(LANES, blk_cnt - off);
+
+    // unused lanes are keyed with first one's key, their output is discarded
+    for (size_t i = 0; i < LANES; i++) {
+      const size_t blk = off + (i < cnt ? i : 0);
+      lane_keys[i] = keys + (static_cast<size_t>(key_idx[blk]) << 4);
+    }
+
+    gift::expand_keys(&rk, lane_keys);
+
+    std::memset(&st, 0, sizeof(st));
+    for (size_t i = 0; i < cnt; i++) {
+      load_block(&st, i, txt + ((off + i) << 4));
+    }
+
+    gift::permute<gift::ROUNDS>(&st, &rk);
+
+    for (size_t i = 0; i < cnt; i++) {
+      store_block(&st, i, nullptr, enc + ((off + i) << 4));
+    }
+  }
+}
+
+// Given 128 -bit secret key, 128 -bit initialization vector and N -many
+// 128 -bit plain text blocks, this routine encrypts them in CBC mode | N >= 0
+//
+// Note, CBC encryption is inherently sequential, so it's computed one block at
+// a time, using GIFT-128 block cipher from `gift.hpp`, with round keys expanded
+// only once
+inline static void
+cbc_encrypt(const uint8_t* const __restrict key, // 128 -bit secret key
+            const uint8_t* const __restrict iv,  // 128 -bit IV
+            const uint8_t* const __restrict txt, // N x 128 -bit plain text
+            uint8_t* const __restrict enc,       // N x 128 -bit cipher text
+            const size_t blk_cnt                 // N | >= 0
+)
+{
+  gift::round_keys_t rk;
+  gift::expand_key(&rk, key);
+
+  uint8_t prev[16];
+  std::memcpy(prev, iv, sizeof(prev));
+
+  for (size_t i = 0; i < blk_cnt; i++) {
+    const size_t off = i << 4;
+
+    gift::state_t st{};
+    for (size_t j = 0; j < 4; j++) {
+      const size_t boff = j << 2;
+      const uint8_t* const p = txt + off + boff;
+      const uint8_t* const q = prev + boff;
+
+      st.cipher[j] = (static_cast<uint32_t>(p[0] ^ q[0]) << 24) |
+                     (static_cast<uint32_t>(p[1] ^ q[1]) << 16) |
+                     (static_cast<uint32_t>(p[2] ^ q[2]) << 8) |
+                     (static_cast<uint32_t>(p[3] ^ q[3]) << 0);
+    }
+
+    gift::permute<gift::ROUNDS>(&st, &rk);
+
+    for (size_t j = 0; j < 4; j++) {
+      const size_t boff = j << 2;
+
+      prev[boff ^ 0] = static_cast<uint8_t>(st.cipher[j] >> 24);
+      prev[boff ^ 1] = static_cast<uint8_t>(st.cipher[j] >> 16);
+      prev[boff ^ 2] = static_cast<uint8_t>(st.cipher[j] >> 8);
+      prev[boff ^ 3] = static_cast<uint8_t>(st.cipher[j] >> 0);
+    }
+
+    std::memcpy(enc + off, prev, sizeof(prev));
+  }
+}
+
+// Given 128 -bit secret key, 128 -bit initialization vector and N -many
+// 128 -bit cipher text blocks, this routine decrypts them in CBC mode | N >= 0
+//
+// Note, i -th plain text block only depends on i -th and (i-1) -th cipher text
+// blocks, so LANES -many blocks are decrypted at once, using inverse GIFT-128
+inline static void
+cbc_decrypt(const uint8_t* const __restrict key, // 128 -bit secret key
+            const uint8_t* const __restrict iv,  // 128 -bit IV
+            const uint8_t* const __restrict enc, // N x 128 -bit cipher text
+            uint8_t* const __restrict txt,       // N x 128 -bit plain text
+            const size_t blk_cnt                 // N | >= 0
+)
+{
+  gift::round_keys_t rk;
+  gift::expand_key(&rk, key);
+
+  gift::lanes_t<LANES> st;
+
+  for (size_t off = 0; off < blk_cnt; off += LANES) {
+    const size_t cnt = std::min(LANES, blk_cnt - off);
+
+    std::memset(&st, 0, sizeof(st));
+    for (size_t i = 0; i < cnt; i++) {
+      load_block(&st, i, enc + ((off + i) << 4));
+    }
+
+    gift::inverse_permute<gift::ROUNDS>(&st, &rk);
+
+    for (size_t i = 0; i < cnt; i++) {
+      const size_t idx = off + i;
+      const uint8_t* const msk = idx == 0 ? iv : enc + ((idx - 1) << 4);
+
+      store_block(&st, i, msk, txt + (idx << 4));
+    }
+  }
+}
+
+}
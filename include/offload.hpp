@@ -0,0 +1,696 @@
+#pragma once
+#include "aead.hpp"
+#include "batch.hpp"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// GIFT-COFB offload over Unix domain sockets, where one daemon serves seal/
+// open requests of many local processes, coalescing requests which arrive
+// together ( from any connection ) into batches, while clients pipeline
+// requests and receive responses asynchronously, matched by request id
+namespace gift_cofb_offload {
+
+// Number of secret key slots, per connection
+constexpr size_t MAX_KEYS = 16;
+
+// Number of concurrently served connections
+constexpr size_t MAX_CLIENTS = 64;
+
+// Maximum byte length of associated data/ input of one request
+constexpr uint32_t MAX_LEN = 1u << 20;
+
+// Maximum number of bytes buffered per connection, in each direction, which
+// is large enough to hold largest request/ response; beyond it, connection's
+// input isn't read, nor are its requests served, until it reads responses
+constexpr size_t MAX_QUEUED = 4ul * MAX_LEN;
+
+// Connection whose requests are held back, for not reading its responses, for
+// this long, is dropped
+constexpr auto MAX_STALL = std::chrono::seconds(10);
+
+// Kinds of requests
+enum op_t : uint32_t
+{
+  SET_KEY = 0, // installs 128 -bit secret key ( payload ) in given key slot
+  SEAL,        // payload = AD || plain text, response = cipher text || tag
+  OPEN         // payload = AD || cipher text || tag, response = plain text
+};
+
+// Outcome of requests
+enum status_t : uint32_t
+{
+  OK = 0,
+  AUTH_FAILED, // authentication tag didn't verify, no plain text is returned
+  BAD_REQUEST  // unknown op, unset key slot or malformed lengths
+};
+
+// Fixed size request header, followed by `dlen` -bytes associated data and
+// `len` -bytes input; fields are in host byte order, as both ends live on same
+// host
+struct request_t
+{
+  uint32_t op;
+  uint32_t key_idx;
+  uint64_t id;
+  uint8_t nonce[16];
+  uint32_t dlen;
+  uint32_t len;
+};
+
+// Fixed size response header, followed by `len` -bytes output
+struct response_t
+{
+  uint64_t id;
+  uint32_t status;
+  uint32_t len;
+};
+
+static_assert(sizeof(request_t) == 40, "Request header must be packed");
+static_assert(sizeof(response_t) == 16, "Response header must be packed");
+
+// Writes all N -bytes to ( blocking ) file descriptor, returning false on error
+inline static bool
+write_all(const int fd, const uint8_t* const buf, const size_t len)
+{
+  size_t off = 0;
+
+  while (off < len) {
+    const ssize_t n = write(fd, buf + off, len - off);
+
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+
+    off += static_cast<size_t>(n);
+  }
+
+  return true;
+}
+
+// Reads exactly N -bytes from ( blocking ) file descriptor, returning false on
+// error or end of stream
+inline static bool
+read_all(const int fd, uint8_t* const buf, const size_t len)
+{
+  size_t off = 0;
+
+  while (off < len) {
+    const ssize_t n = read(fd, buf + off, len - off);
+
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+
+    off += static_cast<size_t>(n);
+  }
+
+  return true;
+}
+
+// Fills Unix domain socket address with given path, returning false if it's
+// too long
+inline static bool
+make_addr(const char* const path, sockaddr_un* const addr)
+{
+  std::memset(addr, 0, sizeof(sockaddr_un));
+  addr->sun_family = AF_UNIX;
+
+  if (std::strlen(path) >= sizeof(addr->sun_path)) {
+    return false;
+  }
+
+  std::strcpy(addr->sun_path, path);
+  return true;
+}
+
+// Listens on Unix domain socket at given path ( replacing stale socket file,
+// if any ), returning non-blocking listening socket or -1 on error
+inline static int
+listen_unix(const char* const path)
+{
+  sockaddr_un addr;
+  if (!make_addr(path, &addr)) {
+    return -1;
+  }
+
+  const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return -1;
+  }
+
+  unlink(path);
+
+  const auto sa = reinterpret_cast<const sockaddr*>(&addr);
+  if (bind(fd, sa, sizeof(addr)) != 0 || listen(fd, SOMAXCONN) != 0) {
+    close(fd);
+    return -1;
+  }
+
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  return fd;
+}
+
+// One connection served by daemon, along with its buffered input/ output bytes
+// and key slots
+struct conn_t
+{
+  int fd = -1;
+  std::vector<uint8_t> in;  // received bytes, not yet parsed
+  std::vector<uint8_t> out; // response bytes, not yet written
+  size_t out_off = 0;
+  bool has_key[MAX_KEYS]{};
+  bool broken = false;    // violated protocol, to be closed
+  bool throttled = false; // requests held back, as too many bytes are queued
+  std::chrono::steady_clock::time_point stalled; // since when it's throttled
+
+  // Number of response bytes, not yet written
+  inline size_t queued() const { return out.size() - out_off; }
+
+  // Whether socket shouldn't be read from, for now
+  inline bool full() const { return throttled || in.size() >= MAX_QUEUED; }
+};
+
+// Counters of served requests, kept by daemon
+struct server_stats_t
+{
+  std::atomic<uint64_t> batches{ 0 };
+  std::atomic<uint64_t> records{ 0 };
+};
+
+// Seal/ open request, parsed out of some connection's input, in current batch
+struct pending_t
+{
+  size_t conn;
+  uint64_t id;
+  uint32_t op;
+  uint32_t status; // only for requests answered without running batch
+  size_t job;
+};
+
+// Zeroes N -bytes of secret material, in a way compiler can't drop as a dead
+// store
+inline static void
+wipe(void* const ptr, const size_t len)
+{
+  std::memset(ptr, 0, len);
+  asm volatile("" : : "r"(ptr) : "memory");
+}
+
+// Appends response header and output bytes to connection's output buffer
+inline static void
+respond(conn_t* const c,
+        const uint64_t id,
+        const uint32_t status,
+        const uint8_t* const out,
+        const uint32_t len)
+{
+  const response_t resp{ id, status, len };
+  const auto hdr = reinterpret_cast<const uint8_t*>(&resp);
+
+  c->out.insert(c->out.end(), hdr, hdr + sizeof(resp));
+  c->out.insert(c->out.end(), out, out + len);
+}
+
+// Writes as many buffered response bytes as socket accepts, without blocking,
+// returning false if connection is broken
+inline static bool
+flush(conn_t* const c)
+{
+  while (c->out_off < c->out.size()) {
+    const size_t left = c->out.size() - c->out_off;
+    const uint8_t* const buf = c->out.data() + c->out_off;
+    const ssize_t n = send(c->fd, buf, left, MSG_DONTWAIT | MSG_NOSIGNAL);
+
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      return true;
+    }
+    if (n <= 0) {
+      return false;
+    }
+
+    c->out_off += static_cast<size_t>(n);
+  }
+
+  c->out.clear();
+  c->out_off = 0;
+
+  return true;
+}
+
+// Reads bytes available on socket ( until MAX_QUEUED -bytes are buffered ),
+// without blocking, returning false if connection is closed by peer or broken
+inline static bool
+drain(conn_t* const c)
+{
+  uint8_t buf[1ul << 16];
+
+  while (c->in.size() < MAX_QUEUED) {
+    const ssize_t n = recv(c->fd, buf, sizeof(buf), MSG_DONTWAIT);
+
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      return true;
+    }
+    if (n <= 0) {
+      return false;
+    }
+
+    c->in.insert(c->in.end(), buf, buf + n);
+  }
+
+  return true;
+}
+
+// Serves seal/ open requests on Unix domain socket at given path, until `stop`
+// is set, returning false if it can't listen on that path or if job
+// descriptors of `max_batch` requests don't fit in its arena
+//
+// In every round, bytes available on all ready connections are read, complete
+// requests ( at max `max_batch` of them ) are parsed out of them, seal and open
+// requests are coalesced into one batch each, which are run through batch API,
+// and responses are queued back, in order of requests, on each connection
+//
+// As secret keys are only read when batches run, SET_KEY request, which comes
+// after seal/ open requests of same connection in current round, is left for
+// next round, so that it can't replace key of requests parsed before it
+//
+// At most MAX_QUEUED -bytes of input and of responses are buffered per
+// connection, so that a client which keeps sending requests, without reading
+// responses, is throttled ( its socket isn't polled for input ) and, after
+// MAX_STALL, dropped, instead of making daemon buffer without bound
+inline static bool
+serve(const char* const path,
+      const std::atomic<bool>& stop,
+      server_stats_t* const stats,
+      const size_t max_batch)
+{
+  const int lfd = listen_unix(path);
+  if (lfd < 0) {
+    return false;
+  }
+
+  std::vector<conn_t> conns(MAX_CLIENTS);
+  std::vector<uint8_t> keys(MAX_CLIENTS * MAX_KEYS * 16);
+  std::vector<pending_t> pending;
+  std::vector<size_t> consumed(MAX_CLIENTS);
+
+  // job descriptors of both batches, output slabs of ( say ) 4 KiB requests
+  // and room for at least two largest requests
+  const size_t slab_len = gift_cofb_batch::round_up(MAX_LEN + 16, 64);
+  const size_t arena_len = max_batch * (2 * 128 + 4096) + 2 * slab_len;
+  gift_cofb_batch::arena_t arena(arena_len, true);
+
+  // closes i -th connection, wiping its secret keys
+  auto drop = [&](const size_t i) {
+    close(conns[i].fd);
+    conns[i] = conn_t{};
+    wipe(keys.data() + i * MAX_KEYS * 16, MAX_KEYS * 16);
+  };
+
+  bool backlog = false;
+  bool served = true;
+
+  while (!stop.load(std::memory_order_relaxed)) {
+    pollfd fds[1 + MAX_CLIENTS];
+    size_t nfds = 0;
+
+    fds[nfds++] = { lfd, POLLIN, 0 };
+    for (size_t i = 0; i < MAX_CLIENTS; i++) {
+      const conn_t& c = conns[i];
+
+      if (c.fd >= 0) {
+        const short ev =
+          (c.full() ? 0 : POLLIN) | (c.out.empty() ? 0 : POLLOUT);
+        fds[nfds++] = { c.fd, ev, 0 };
+      }
+    }
+
+    // don't wait, when requests are left from previous ( full ) batch
+    if (poll(fds, nfds, backlog ? 0 : 100) < 0 && errno != EINTR) {
+      break;
+    }
+
+    if (fds[0].revents & POLLIN) {
+      int cfd;
+      while ((cfd = accept(lfd, nullptr, nullptr)) >= 0) {
+        size_t i = 0;
+        while (i < MAX_CLIENTS && conns[i].fd >= 0) {
+          i++;
+        }
+
+        if (i == MAX_CLIENTS) {
+          close(cfd);
+          continue;
+        }
+
+        conns[i] = conn_t{};
+        conns[i].fd = cfd;
+      }
+    }
+
+    for (size_t k = 1; k < nfds; k++) {
+      size_t i = 0;
+      while (conns[i].fd != fds[k].fd) {
+        i++;
+      }
+
+      bool alive = (fds[k].revents & (POLLERR | POLLNVAL)) == 0;
+      if (alive && (fds[k].revents & (POLLIN | POLLHUP))) {
+        alive = drain(&conns[i]);
+      }
+      if (alive && (fds[k].revents & POLLOUT)) {
+        alive = flush(&conns[i]);
+      }
+
+      if (!alive) {
+        drop(i);
+      }
+    }
+
+    // parse complete requests, out of every connection's input
+    arena.reset();
+
+    gift_cofb_batch::jobs_t seals, opens;
+
+    const bool made = gift_cofb_batch::make_jobs(&arena, max_batch, &seals) &
+                      gift_cofb_batch::make_jobs(&arena, max_batch, &opens);
+    if (!made) {
+      served = false;
+      break;
+    }
+
+    pending.clear();
+    backlog = false;
+
+    for (size_t i = 0; i < MAX_CLIENTS; i++) {
+      conn_t& c = conns[i];
+      size_t off = 0;
+      size_t queued = c.queued(); // including responses of this round
+      size_t batched = 0;         // seal/ open requests in this round
+
+      c.throttled = false;
+
+      while (c.fd >= 0 && c.in.size() - off >= sizeof(request_t)) {
+        request_t req;
+        std::memcpy(&req, c.in.data() + off, sizeof(req));
+
+        if (req.dlen > MAX_LEN || req.len > MAX_LEN + 16) {
+          // can't skip payload of unbounded length, so drop connection, once
+          // current batch ( which may point into its input ) is done
+          c.broken = true;
+          break;
+        }
+
+        const size_t need = sizeof(req) + req.dlen + req.len;
+        if (c.in.size() - off < need) {
+          break;
+        }
+
+        // leave request until client reads enough of its responses
+        const size_t resp_len = sizeof(response_t) + req.len + 16;
+        if (queued + resp_len > MAX_QUEUED) {
+          c.throttled = true;
+          break;
+        }
+
+        // leave request for next round, if batch or its arena is full
+        const size_t out_len = gift_cofb_batch::round_up(req.len + 16, 64);
+        if (pending.size() == max_batch || arena.cap - arena.used < out_len) {
+          backlog = true;
+          break;
+        }
+
+        // leave key change for next round, once batched requests are done
+        if (req.op == SET_KEY && batched > 0) {
+          backlog = true;
+          break;
+        }
+
+        const uint8_t* const data = c.in.data() + off + sizeof(req);
+        const uint8_t* const inp = data + req.dlen;
+        off += need;
+        queued += resp_len;
+
+        const bool key_ok = req.key_idx < MAX_KEYS;
+        const size_t key_slot = i * MAX_KEYS + (key_ok ? req.key_idx : 0);
+
+        pending_t p{ i, req.id, req.op, OK, 0 };
+
+        if (req.op == SET_KEY && key_ok && req.len == 16) {
+          std::memcpy(keys.data() + key_slot * 16, inp, 16);
+          c.has_key[req.key_idx] = true;
+        } else if (!key_ok || !c.has_key[req.key_idx]) {
+          p.status = BAD_REQUEST;
+        } else if (req.op == SEAL) {
+          batched++;
+          p.job = gift_cofb_batch::push(&seals,
+                                        static_cast<uint32_t>(key_slot),
+                                        req.nonce,
+                                        data,
+                                        req.dlen,
+                                        inp,
+                                        arena.alloc(req.len + 16),
+                                        req.len,
+                                        nullptr);
+        } else if (req.op == OPEN && req.len >= 16) {
+          const uint32_t ctlen = req.len - 16;
+
+          batched++;
+          p.job = gift_cofb_batch::push(&opens,
+                                        static_cast<uint32_t>(key_slot),
+                                        req.nonce,
+                                        data,
+                                        req.dlen,
+                                        inp,
+                                        arena.alloc(ctlen),
+                                        ctlen,
+                                        inp + ctlen);
+        } else {
+          p.status = BAD_REQUEST;
+        }
+
+        pending.push_back(p);
+      }
+
+      consumed[i] = off;
+    }
+
+    // run coalesced batches, then queue responses in order of requests
+    gift_cofb_batch::encrypt(keys.data(), &seals);
+    gift_cofb_batch::decrypt(keys.data(), &opens);
+
+    for (const pending_t& p : pending) {
+      conn_t& c = conns[p.conn];
+
+      if (p.status != OK || p.op == SET_KEY) {
+        respond(&c, p.id, p.status, nullptr, 0);
+      } else if (p.op == SEAL) {
+        const uint32_t ctlen = static_cast<uint32_t>(seals.ctlen[p.job]);
+
+        // tag is placed right after cipher text, in same output slab
+        uint8_t* const out = seals.out[p.job];
+        std::memcpy(out + ctlen, seals.tags + (p.job << 4), 16);
+
+        respond(&c, p.id, OK, out, ctlen + 16);
+      } else {
+        const bool ok = opens.ok[p.job];
+        const uint32_t ctlen = static_cast<uint32_t>(opens.ctlen[p.job]);
+
+        const uint32_t status = ok ? OK : AUTH_FAILED;
+
+        respond(&c, p.id, status, opens.out[p.job], ok ? ctlen : 0);
+      }
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < MAX_CLIENTS; i++) {
+      conn_t& c = conns[i];
+
+      if (c.fd < 0) {
+        continue;
+      }
+
+      c.in.erase(c.in.begin(), c.in.begin() + consumed[i]);
+
+      if (!c.throttled) {
+        c.stalled = now;
+      }
+
+      if (!flush(&c) || c.broken || now - c.stalled > MAX_STALL) {
+        drop(i);
+      }
+    }
+
+    const size_t recs = seals.cnt + opens.cnt;
+    if (recs > 0) {
+      stats->batches.fetch_add(1, std::memory_order_relaxed);
+      stats->records.fetch_add(recs, std::memory_order_relaxed);
+    }
+  }
+
+  for (size_t i = 0; i < MAX_CLIENTS; i++) {
+    if (conns[i].fd >= 0) {
+      drop(i);
+    }
+  }
+
+  close(lfd);
+  unlink(path);
+
+  return served;
+}
+
+// Client of offload daemon, which can pipeline any number of seal/ open
+// requests, before receiving their responses ( in order of submission ), as
+// long as responses in flight fit in MAX_QUEUED -bytes, beyond which daemon
+// stops reading requests, until responses are read
+struct client_t
+{
+  int fd = -1;
+
+  client_t() = default;
+  client_t(const client_t&) = delete;
+  client_t& operator=(const client_t&) = delete;
+
+  ~client_t()
+  {
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+
+  // Connects to daemon listening at given path, returning false on error
+  inline bool connect(const char* const path)
+  {
+    sockaddr_un addr;
+    if (!make_addr(path, &addr)) {
+      return false;
+    }
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+      return false;
+    }
+
+    const auto sa = reinterpret_cast<const sockaddr*>(&addr);
+    return ::connect(fd, sa, sizeof(addr)) == 0;
+  }
+
+  // Submits request, with given id, writing header and payload with one system
+  // call, without waiting for its response
+  inline bool submit(const op_t op,
+                     const uint64_t id,
+                     const uint32_t key_idx,
+                     const uint8_t* const nonce, // 128 -bit nonce, can be null
+                     const uint8_t* const data,  // N -bytes associated data
+                     const uint32_t dlen,
+                     const uint8_t* const in, // M -bytes input
+                     const uint32_t len)
+  {
+    request_t req{ op, key_idx, id, {}, dlen, len };
+    if (nonce != nullptr) {
+      std::memcpy(req.nonce, nonce, sizeof(req.nonce));
+    }
+
+    iovec iov[3] = {
+      { &req, sizeof(req) },
+      { const_cast<uint8_t*>(data), dlen },
+      { const_cast<uint8_t*>(in), len },
+    };
+
+    const size_t total = sizeof(req) + dlen + len;
+    const ssize_t n = writev(fd, iov, 3);
+
+    if (n < 0) {
+      return false;
+    }
+    if (static_cast<size_t>(n) == total) {
+      return true;
+    }
+
+    // partially written, so write rest of it, piece by piece
+    size_t done = static_cast<size_t>(n);
+    for (const iovec& v : iov) {
+      const auto base = static_cast<const uint8_t*>(v.iov_base);
+
+      if (done >= v.iov_len) {
+        done -= v.iov_len;
+        continue;
+      }
+
+      if (!write_all(fd, base + done, v.iov_len - done)) {
+        return false;
+      }
+      done = 0;
+    }
+
+    return true;
+  }
+
+  // Installs 128 -bit secret key in given key slot, waiting for daemon to
+  // acknowledge it; must be called without any outstanding request
+  inline bool set_key(const uint32_t key_idx, const uint8_t* const key)
+  {
+    if (!submit(SET_KEY, 0, key_idx, nullptr, nullptr, 0, key, 16)) {
+      return false;
+    }
+
+    response_t resp;
+    return receive(&resp, nullptr, 0) && resp.status == OK;
+  }
+
+  // Receives next response, blocking until it arrives, copying its output to
+  // given buffer, when it fits, otherwise discarding it; returns false if
+  // connection is broken
+  inline bool receive(response_t* const resp,
+                      uint8_t* const out,
+                      const size_t cap)
+  {
+    if (!read_all(fd, reinterpret_cast<uint8_t*>(resp), sizeof(*resp))) {
+      return false;
+    }
+
+    if (resp->len <= cap) {
+      return read_all(fd, out, resp->len);
+    }
+
+    uint8_t sink[4096];
+    size_t left = resp->len;
+
+    while (left > 0) {
+      const size_t n = std::min(left, sizeof(sink));
+      if (!read_all(fd, sink, n)) {
+        return false;
+      }
+      left -= n;
+    }
+
+    return true;
+  }
+};
+
+}
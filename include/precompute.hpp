@@ -0,0 +1,230 @@
+#pragma once
+#include "aead.hpp"
+#include "common.hpp"
+#include "gift.hpp"
+#include "modes.hpp"
+#include "random.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+// Ahead-of-time computation of E_K(N), for senders whose nonces are predictable
+// ( i.e. drawn from a counter ), so that initial chaining value Y[0] of each
+// record is ready before its message arrives. A producer ( background thread
+// or event loop, when idle ) draws nonces and encrypts them LANES at a time,
+// using transposed multi-lane GIFT-128, into a single-producer/ single-consumer
+// queue, while sealing takes next ready nonce along with its E_K(N), taking one
+// full block cipher call off its critical path.
+//
+// Only sealing benefits, as opening uses nonce chosen by sender.
+namespace gift_cofb_precompute {
+
+// Number of entries, queue can hold
+constexpr size_t DEPTH = 64;
+
+// Nonce, along with its initial chaining value Y[0] = E_K(N)
+struct entry_t
+{
+  uint8_t nonce[16];
+  gift_cofb_common::block_t y;
+};
+
+// Single-producer/ single-consumer queue of precomputed entries, under one
+// secret key, whose nonces come from given nonce space
+//
+// Producer and consumer draw nonces from their own generators, leasing
+// disjoint ranges of same source, so that when queue runs dry, consumer can
+// still compute E_K(N) synchronously, with a fresh nonce, without ever reusing
+// one of producer's
+struct queue_t
+{
+  queue_t(const uint8_t* const k, gift_cofb_random::source_t* const src)
+    : producer(src)
+    , consumer(src)
+  {
+    std::memcpy(key, k, sizeof(key));
+    gift::expand_key(&rk, key);
+    gift_cofb_common::load_key(kst, key);
+  }
+
+  queue_t(const queue_t&) = delete;
+  queue_t& operator=(const queue_t&) = delete;
+
+  // Fills free entries of queue, LANES at a time, returning number of entries
+  // added; to be called only by producer
+  inline size_t refill()
+  {
+    using namespace gift_modes;
+
+    const uint64_t t = tail.load(std::memory_order_relaxed);
+    const uint64_t h = head.load(std::memory_order_acquire);
+    const size_t free = DEPTH - static_cast<size_t>(t - h);
+
+    gift::lanes_t<LANES> st;
+    uint8_t nonces[LANES][16];
+    uint8_t blk[16];
+
+    size_t done = 0;
+    while (done < free) {
+      const size_t want = std::min(LANES, free - done);
+
+      size_t cnt = 0;
+      while (cnt < want && producer.next(nonces[cnt])) {
+        cnt++;
+      }
+      if (cnt == 0) {
+        break;
+      }
+
+      std::memset(&st, 0, sizeof(st));
+      for (size_t i = 0; i < cnt; i++) {
+        load_block(&st, i, nonces[i]);
+      }
+
+      gift::permute<gift::ROUNDS>(&st, &rk);
+
+      for (size_t i = 0; i < cnt; i++) {
+        entry_t& e = ring[(t + done + i) % DEPTH];
+
+        store_block(&st, i, nullptr, blk);
+        std::memcpy(e.nonce, nonces[i], sizeof(e.nonce));
+        e.y = gift_cofb_common::load_block(blk);
+      }
+
+      done += cnt;
+      if (cnt < want) {
+        break;
+      }
+    }
+
+    tail.store(t + done, std::memory_order_release);
+    return done;
+  }
+
+  // Takes next precomputed entry, returning false if queue is empty; to be
+  // called only by consumer
+  inline bool take(entry_t* const e)
+  {
+    const uint64_t h = head.load(std::memory_order_relaxed);
+    if (h == tail.load(std::memory_order_acquire)) {
+      return false;
+    }
+
+    entry_t& slot = ring[h % DEPTH];
+
+    *e = slot;
+    std::memset(&slot, 0, sizeof(slot));
+
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Takes next precomputed entry, or computes one synchronously, if queue is
+  // empty, returning false only if nonce space is exhausted; to be called only
+  // by consumer
+  inline bool next(entry_t* const e)
+  {
+    if (take(e)) [[likely]] {
+      hits++;
+      return true;
+    }
+
+    if (!consumer.next(e->nonce)) {
+      return false;
+    }
+
+    using namespace gift_cofb_common;
+
+    e->y = encrypt_block(load_block(e->nonce), kst);
+    misses++;
+    return true;
+  }
+
+  // Number of entries, ready to be taken
+  inline size_t ready() const
+  {
+    const uint64_t t = tail.load(std::memory_order_acquire);
+    return static_cast<size_t>(t - head.load(std::memory_order_relaxed));
+  }
+
+  uint8_t key[16];
+
+  // entries taken from queue/ computed synchronously, so far, by consumer
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+
+private:
+  gift::round_keys_t rk;
+  uint16_t kst[8];
+
+  gift_cofb_random::generator_t producer;
+  gift_cofb_random::generator_t consumer;
+
+  alignas(64) std::atomic<uint64_t> head{ 0 }; // next entry to be taken
+  alignas(64) std::atomic<uint64_t> tail{ 0 }; // next entry to be filled
+  alignas(64) entry_t ring[DEPTH];
+};
+
+// Seals M -bytes plain text, with next nonce of queue ( which is written to
+// 128 -bit `nonce`, to be sent along with record ), using its precomputed
+// E_K(N), if there's one ready, returning false only if nonce space is
+// exhausted | N, M >= 0
+inline static bool
+seal(queue_t* const q,
+     const uint8_t* const __restrict data, // N -bytes associated data
+     const size_t dlen,                    // len(data) | >= 0
+     const uint8_t* const txt,             // M -bytes plain text
+     uint8_t* const enc,                   // M -bytes encrypted text
+     const size_t ctlen,                   // len(enc) = len(txt) | >= 0
+     uint8_t* const __restrict tag,        // 128 -bit authentication tag
+     uint8_t* const __restrict nonce       // 128 -bit nonce, used
+)
+{
+  entry_t e;
+  if (!q->next(&e)) {
+    return false;
+  }
+
+  std::memcpy(nonce, e.nonce, sizeof(e.nonce));
+  gift_cofb::encrypt_precomputed(q->key, e.y, data, dlen, txt, enc, ctlen, tag);
+
+  std::memset(&e, 0, sizeof(e));
+  return true;
+}
+
+// Background producer, keeping queue topped up, sleeping for `pause` whenever
+// it's found full
+struct filler_t
+{
+  explicit filler_t(queue_t* const q,
+                    const std::chrono::microseconds pause =
+                      std::chrono::microseconds(50))
+    : thread([this, q, pause]() {
+      while (!stopping.load(std::memory_order_relaxed)) {
+        if (q->refill() == 0) {
+          std::this_thread::sleep_for(pause);
+        }
+      }
+    })
+  {
+  }
+
+  filler_t(const filler_t&) = delete;
+  filler_t& operator=(const filler_t&) = delete;
+
+  ~filler_t()
+  {
+    stopping.store(true, std::memory_order_relaxed);
+    thread.join();
+  }
+
+private:
+  std::atomic<bool> stopping{ false };
+  std::thread thread;
+};
+
+}
@@ -0,0 +1,167 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+
+#if defined __linux__
+#include <sys/random.h>
+#endif
+
+// Nonce and random byte sources, used by benchmarks, examples and record layer,
+// where ( a ) nonces are handed out by per-thread counters, leasing disjoint
+// ranges of one 64 -bit counter space, so that they are unique across threads,
+// without any synchronization per nonce and ( b ) random bytes come from
+// operating system's CSPRNG, in bulk, through a buffer which is refilled only
+// once it's drained
+namespace gift_cofb_random {
+
+// Byte length of buffer, from which small random byte requests are served
+constexpr size_t POOL_LEN = 4096;
+
+// Number of nonces, leased by a thread at once
+constexpr uint64_t LEASE = 1ul << 16;
+
+// Fills N -bytes with random bytes from operating system's CSPRNG, using
+// `getrandom` on Linux and `std::random_device` elsewhere | N >= 0
+inline static void
+os_random(uint8_t* const bytes, const size_t len)
+{
+  size_t off = 0;
+
+#if defined __linux__
+  while (off < len) {
+    const ssize_t n = getrandom(bytes + off, len - off, 0);
+
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      break;
+    }
+
+    off += static_cast<size_t>(n);
+  }
+#endif
+
+  if (off < len) {
+    std::random_device rd;
+
+    for (; off < len; off += 4) {
+      const uint32_t w = rd();
+      std::memcpy(bytes + off, &w, std::min<size_t>(4, len - off));
+    }
+  }
+}
+
+// Buffered random byte source, not to be shared across threads; requests
+// smaller than buffer are served from it ( refilling it with one system call,
+// once drained ), while larger ones go to operating system directly
+struct pool_t
+{
+  uint8_t buf[POOL_LEN];
+  size_t off = POOL_LEN; // first unused byte of buffer
+
+  // Fills N -bytes with random bytes | N >= 0
+  inline void fill(uint8_t* const bytes, const size_t len)
+  {
+    if (len >= POOL_LEN) {
+      os_random(bytes, len);
+      return;
+    }
+
+    size_t done = 0;
+    while (done < len) {
+      if (off == POOL_LEN) {
+        os_random(buf, POOL_LEN);
+        off = 0;
+      }
+
+      const size_t n = std::min(len - done, POOL_LEN - off);
+      std::memcpy(bytes + done, buf + off, n);
+
+      // served bytes are wiped, so that they don't linger in buffer
+      std::memset(buf + off, 0, n);
+
+      off += n;
+      done += n;
+    }
+  }
+};
+
+// Fills N -bytes with random bytes, using calling thread's own pool | N >= 0
+inline static void
+fill(uint8_t* const bytes, const size_t len)
+{
+  thread_local pool_t pool;
+  pool.fill(bytes, len);
+}
+
+// Shared state of one nonce space, where every 128 -bit nonce is
+//
+// 64 -bit prefix || 64 -bit counter ( big-endian )
+//
+// and counter space is leased out to threads, LEASE counters at a time, with
+// one atomic increment per lease; nonces are unique as long as no two sources
+// share same prefix under same secret key
+struct source_t
+{
+  uint8_t prefix[8];
+  std::atomic<uint64_t> leases{ 0 };
+
+  // Nonce space with random prefix
+  source_t() { fill(prefix, sizeof(prefix)); }
+
+  // Nonce space with given 64 -bit prefix, say identifier of sender
+  explicit source_t(const uint8_t* const pfx)
+  {
+    std::memcpy(prefix, pfx, sizeof(prefix));
+  }
+
+  source_t(const source_t&) = delete;
+  source_t& operator=(const source_t&) = delete;
+};
+
+// Per-thread nonce generator, drawing counters from its current lease, until
+// it's exhausted
+struct generator_t
+{
+  source_t* src;
+  uint64_t ctr = 0;
+  uint64_t end = 0; // one past last counter of current lease
+
+  explicit generator_t(source_t* const s)
+    : src(s)
+  {
+  }
+
+  // Writes next 128 -bit nonce, returning false only if whole 64 -bit counter
+  // space of source is exhausted
+  inline bool next(uint8_t* const nonce)
+  {
+    if (ctr == end) [[unlikely]] {
+      const uint64_t lease =
+        src->leases.fetch_add(1, std::memory_order_relaxed);
+      if (lease >= (~0ul / LEASE)) {
+        return false;
+      }
+
+      ctr = lease * LEASE;
+      end = ctr + LEASE;
+    }
+
+    std::memcpy(nonce, src->prefix, 8);
+
+    const uint64_t c = ctr++;
+    for (size_t i = 0; i < 8; i++) {
+      nonce[8 + i] = static_cast<uint8_t>(c >> ((7 - i) << 3));
+    }
+
+    return true;
+  }
+};
+
+}
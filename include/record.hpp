@@ -0,0 +1,265 @@
+#pragma once
+#include "aead.hpp"
+#include "batch.hpp"
+#include "common.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <sys/uio.h>
+
+// Record protection layer for datagram protocols, where each record is
+//
+// sequence number ( 8 -bytes, big-endian ) || cipher text || tag
+//
+// sequence number being associated data of record, while its nonce is derived
+// by XORing sequence number into last 8 -bytes of per-direction static IV.
+// Whole batches of datagrams ( say as filled in by `recvmmsg`/ consumed by
+// `sendmmsg` ) are sealed/ opened in one call, through batch API, while opened
+// records are checked against a sliding anti-replay window.
+namespace gift_cofb_record {
+
+// Byte length of sequence number header
+constexpr size_t SEQ_LEN = 8;
+
+// Bytes added to each datagram, by sealing it
+constexpr size_t OVERHEAD = SEQ_LEN + gift_cofb::TAG_LEN;
+
+// Number of 64 -bit words in anti-replay bitmap
+constexpr size_t WINDOW_WORDS = 16;
+
+// Number of most recent sequence numbers, tracked by anti-replay window; one
+// word of bitmap is always being recycled, see RFC 6479
+constexpr uint64_t WINDOW = (WINDOW_WORDS - 1) * 64;
+
+// Number of records, sealed/ opened through batch API at once
+constexpr size_t MAX_BATCH = 64;
+
+// Outcome of opening one record
+enum status_t : uint8_t
+{
+  OK = 0,
+  MALFORMED,  // shorter than OVERHEAD, or doesn't fit in output buffer
+  REPLAYED,   // already seen, or older than anti-replay window
+  AUTH_FAILED // authentication tag didn't verify
+};
+
+// Derives 128 -bit nonce of record, from 128 -bit static IV and 64 -bit
+// sequence number
+inline static void
+make_nonce(const uint8_t* const __restrict iv,
+           const uint64_t seq,
+           uint8_t* const __restrict nonce)
+{
+  using namespace gift_cofb_common;
+
+  std::memcpy(nonce, iv, 8);
+  store_be64(load_be64(iv + 8) ^ seq, nonce + 8);
+}
+
+// Sliding anti-replay window, tracking which of most recent WINDOW sequence
+// numbers are already seen, as a ring of bitmap words, so that sliding it
+// forwards only clears words, instead of shifting whole bitmap ( RFC 6479 )
+struct window_t
+{
+  uint64_t top = 0; // highest sequence number seen so far
+  bool any = false;
+  uint64_t bits[WINDOW_WORDS]{};
+
+  // Whether sequence number is neither seen nor too old
+  inline bool fresh(const uint64_t seq) const
+  {
+    if (!any || seq > top) {
+      return true;
+    }
+    if (top - seq >= WINDOW) {
+      return false;
+    }
+
+    const uint64_t word = bits[(seq >> 6) % WINDOW_WORDS];
+    return ((word >> (seq & 63)) & 1) == 0;
+  }
+
+  // Marks sequence number as seen, sliding window forwards if it's newest one,
+  // returning false if it wasn't fresh
+  inline bool update(const uint64_t seq)
+  {
+    if (!fresh(seq)) {
+      return false;
+    }
+
+    if (!any || seq > top) {
+      const uint64_t from = any ? (top >> 6) + 1 : seq >> 6;
+      const uint64_t to = seq >> 6;
+      const uint64_t cnt = std::min<uint64_t>(to - from + 1, WINDOW_WORDS);
+
+      for (uint64_t i = 0; i < cnt && from <= to; i++) {
+        bits[(to - i) % WINDOW_WORDS] = 0;
+      }
+
+      top = seq;
+      any = true;
+    }
+
+    bits[(seq >> 6) % WINDOW_WORDS] |= 1ul << (seq & 63);
+    return true;
+  }
+};
+
+// Sealing end of one direction, owning its secret key, static IV, next
+// sequence number and job descriptors, reused across batches
+struct sender_t
+{
+  uint8_t key[16];
+  uint8_t iv[16];
+  uint64_t seq = 0;
+
+  gift_cofb_batch::arena_t arena;
+  gift_cofb_batch::jobs_t jobs;
+
+  sender_t(const uint8_t* const k, const uint8_t* const v)
+    : arena(MAX_BATCH * 128 + 16 * gift_cofb_batch::ALIGN)
+  {
+    std::memcpy(key, k, sizeof(key));
+    std::memcpy(iv, v, sizeof(iv));
+    gift_cofb_batch::make_jobs(&arena, MAX_BATCH, &jobs);
+  }
+
+  // Seals N datagrams, assigning them consecutive sequence numbers, writing
+  // each record to corresponding output buffer ( of at least plain text
+  // length + OVERHEAD -bytes ) and setting its length
+  inline void seal(const iovec* const txts, iovec* const recs, const size_t n)
+  {
+    for (size_t off = 0; off < n; off += MAX_BATCH) {
+      const size_t cnt = std::min(MAX_BATCH, n - off);
+      jobs.cnt = 0;
+
+      for (size_t i = off; i < off + cnt; i++) {
+        auto rec = static_cast<uint8_t*>(recs[i].iov_base);
+        const size_t len = txts[i].iov_len;
+
+        uint8_t nonce[16];
+        make_nonce(iv, seq, nonce);
+        gift_cofb_common::store_be64(seq, rec);
+        seq++;
+
+        gift_cofb_batch::push(&jobs,
+                              0,
+                              nonce,
+                              rec,
+                              SEQ_LEN,
+                              static_cast<const uint8_t*>(txts[i].iov_base),
+                              rec + SEQ_LEN,
+                              len,
+                              nullptr);
+
+        recs[i].iov_len = len + OVERHEAD;
+      }
+
+      gift_cofb_batch::encrypt(key, &jobs);
+
+      for (size_t i = 0; i < cnt; i++) {
+        uint8_t* const tag = jobs.out[i] + jobs.ctlen[i];
+        std::memcpy(tag, jobs.tags + (i << 4), gift_cofb::TAG_LEN);
+      }
+    }
+  }
+};
+
+// Opening end of one direction, owning its secret key, static IV, anti-replay
+// window and job descriptors, reused across batches
+struct receiver_t
+{
+  uint8_t key[16];
+  uint8_t iv[16];
+  window_t window;
+
+  gift_cofb_batch::arena_t arena;
+  gift_cofb_batch::jobs_t jobs;
+
+  receiver_t(const uint8_t* const k, const uint8_t* const v)
+    : arena(MAX_BATCH * 128 + 16 * gift_cofb_batch::ALIGN)
+  {
+    std::memcpy(key, k, sizeof(key));
+    std::memcpy(iv, v, sizeof(iv));
+    gift_cofb_batch::make_jobs(&arena, MAX_BATCH, &jobs);
+  }
+
+  // Opens N records, writing decrypted datagrams to corresponding output
+  // buffers ( whose lengths are capacities on input, datagram lengths on
+  // output ) and status of each record, returning number of accepted ones
+  //
+  // Records are checked against anti-replay window before decryption ( so
+  // that replayed ones aren't decrypted at all ), while window is only updated
+  // by authenticated records, in order, so that duplicates within same batch
+  // are caught too; such duplicates are already decrypted by then, so their
+  // output is zeroed, same as it's done for records failing authentication
+  inline size_t open(const iovec* const recs,
+                     iovec* const txts,
+                     uint8_t* const status,
+                     const size_t n)
+  {
+    size_t accepted = 0;
+    size_t idx[MAX_BATCH];
+
+    for (size_t off = 0; off < n; off += MAX_BATCH) {
+      const size_t cnt = std::min(MAX_BATCH, n - off);
+      jobs.cnt = 0;
+
+      for (size_t i = off; i < off + cnt; i++) {
+        auto rec = static_cast<const uint8_t*>(recs[i].iov_base);
+        const size_t rlen = recs[i].iov_len;
+
+        if (rlen < OVERHEAD || rlen - OVERHEAD > txts[i].iov_len) {
+          status[i] = MALFORMED;
+          continue;
+        }
+
+        const uint64_t seq = gift_cofb_common::load_be64(rec);
+        if (!window.fresh(seq)) {
+          status[i] = REPLAYED;
+          continue;
+        }
+
+        const size_t len = rlen - OVERHEAD;
+
+        uint8_t nonce[16];
+        make_nonce(iv, seq, nonce);
+
+        idx[jobs.cnt] = i;
+        gift_cofb_batch::push(&jobs,
+                              0,
+                              nonce,
+                              rec,
+                              SEQ_LEN,
+                              rec + SEQ_LEN,
+                              static_cast<uint8_t*>(txts[i].iov_base),
+                              len,
+                              rec + SEQ_LEN + len);
+      }
+
+      gift_cofb_batch::decrypt(key, &jobs);
+
+      for (size_t j = 0; j < jobs.cnt; j++) {
+        const size_t i = idx[j];
+        const uint64_t seq = gift_cofb_common::load_be64(jobs.data[j]);
+
+        if (!jobs.ok[j]) {
+          status[i] = AUTH_FAILED;
+        } else if (!window.update(seq)) {
+          status[i] = REPLAYED;
+          std::memset(jobs.out[j], 0, jobs.ctlen[j]);
+        } else {
+          status[i] = OK;
+          txts[i].iov_len = jobs.ctlen[j];
+          accepted++;
+        }
+      }
+    }
+
+    return accepted;
+  }
+};
+
+}
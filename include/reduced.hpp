@@ -0,0 +1,291 @@
+#pragma once
+#include "gift.hpp"
+#include "modes.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#if defined __BMI2__
+#include <immintrin.h>
+#endif
+
+// Bulk evaluation of reduced-round GIFT-128, for cryptanalysis experiments
+// ( say validating differential trails or key-recovery attacks ), where R
+// rounds, starting at an arbitrary round r, are applied on huge batches of
+// blocks, LANES at a time, in transposed form ( see `gift::lanes_t`, whose
+// SubCells is bitsliced over 32 nibbles of each state, while every step of
+// round function is vectorized over lanes ), split across threads.
+//
+// Differential sweeps don't take input blocks at all, instead i -th pair of
+// plain texts ( P, P ^ ΔIN ) is derived from a seed and i, so that sweep of
+// billions of pairs needs neither input nor output buffers, while only
+// histogram of ( selected bits of ) output differences is kept; as pairs only
+// depend on their index, a sweep gives same result on any number of threads,
+// and can be split across machines, by pair index ranges.
+namespace gift_reduced {
+
+// Number of blocks, evaluated together, in transposed form
+constexpr size_t LANES = 32;
+
+// Number of plain text pairs, evaluated together, first blocks of pairs in
+// lower half of lanes, second ones in upper half
+constexpr size_t PAIRS = LANES / 2;
+
+// Largest number of output difference bits, which can index histogram, i.e.
+// each thread keeps at most 2^20 64 -bit counters
+constexpr size_t MAX_HIST_BITS = 20;
+
+// Number of threads to use, when zero is asked for, i.e. one per CPU
+inline static size_t
+pick_threads(const size_t threads)
+{
+  if (threads > 0) {
+    return threads;
+  }
+
+  return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+// Runs f(t, begin, end) on T threads, each taking t -th of N items, split into
+// contiguous ranges, each a multiple of given granule ( except last one )
+template<typename F>
+inline static void
+split(const size_t threads, const size_t n, const size_t granule, F f)
+{
+  const size_t units = (n + granule - 1) / granule;
+  const size_t t_cnt = std::max<size_t>(std::min(threads, units), 1);
+
+  std::vector<std::thread> pool;
+
+  for (size_t t = 0; t < t_cnt; t++) {
+    const size_t begin = std::min(n, (units * t / t_cnt) * granule);
+    const size_t end = std::min(n, (units * (t + 1) / t_cnt) * granule);
+
+    if (t + 1 == t_cnt) {
+      f(t, begin, end);
+    } else {
+      pool.emplace_back(f, t, begin, end);
+    }
+  }
+
+  for (auto& th : pool) {
+    th.join();
+  }
+}
+
+// Given precomputed round keys and N -many 128 -bit blocks, this routine
+// applies R rounds of GIFT-128, starting at r -th round, on each of them, on T
+// threads ( zero means one per CPU ) | r + R <= 40, N >= 0
+//
+// Input and output can be the same buffer ( i.e. in-place ), returns false,
+// without touching output, if rounds run past last round of GIFT-128
+inline static bool
+evaluate(const gift::round_keys_t* const __restrict rk,
+         const size_t from,       // r
+         const size_t cnt,        // R
+         const uint8_t* const in, // N x 128 -bit blocks
+         uint8_t* const out,      // N x 128 -bit blocks
+         const size_t blk_cnt,    // N | >= 0
+         const size_t threads = 0 // T | >= 0
+)
+{
+  if (from > gift::ROUNDS || cnt > gift::ROUNDS - from) {
+    return false;
+  }
+
+  auto work = [=](size_t, const size_t begin, const size_t end) {
+    gift::lanes_t<LANES> st{};
+
+    for (size_t off = begin; off < end; off += LANES) {
+      const size_t n = std::min(LANES, end - off);
+
+      for (size_t i = 0; i < n; i++) {
+        gift_modes::load_block(&st, i, in + ((off + i) << 4));
+      }
+
+      gift::permute(&st, rk, from, cnt);
+
+      for (size_t i = 0; i < n; i++) {
+        gift_modes::store_block(&st, i, nullptr, out + ((off + i) << 4));
+      }
+    }
+  };
+
+  split(pick_threads(threads), blk_cnt, LANES, work);
+  return true;
+}
+
+// Differential sweep, where i -th plain text pair ( P, P ^ ΔIN ) goes through
+// R rounds of GIFT-128, starting at r -th round, under same key, and output
+// difference ΔOUT = C ^ C' is kept only if ( ΔOUT & FILTER_MASK ) == FILTER
+// ( all zero filter keeps every pair ), in which case it's counted in
+// histogram, by bits of ΔOUT selected by HIST_MASK ( all zero mask counts
+// every kept pair in one bin ) | i ∈ [FIRST, FIRST + N)
+//
+// Selected bits are concatenated in their order, from word 0 to word 3, into
+// bin index, so that bits of word 0 are the most significant ones
+//
+// All 128 -bit masks and differences are four 32 -bit words, as loaded from
+// big-endian bytes of a block, see `gift_modes::load_block`
+struct sweep_t
+{
+  const gift::round_keys_t* rk;
+  size_t from; // r
+  size_t cnt;  // R
+  uint32_t din[4];
+  uint32_t filter_mask[4];
+  uint32_t filter[4];
+  uint32_t hist_mask[4];
+  uint64_t seed;
+  uint64_t first; // FIRST
+  uint64_t pairs; // N
+};
+
+// Number of bits set in HIST_MASK of differential sweep, i.e. B | B <= 128
+inline static size_t
+hist_bits(const sweep_t& sw)
+{
+  size_t b = 0;
+  for (size_t j = 0; j < 4; j++) {
+    b += std::popcount(sw.hist_mask[j]);
+  }
+
+  return b;
+}
+
+// Number of bins of histogram of differential sweep, i.e. 2^B, or zero if more
+// than MAX_HIST_BITS bits are selected, in which case sweep is refused
+inline static size_t
+bins(const sweep_t& sw)
+{
+  const size_t b = hist_bits(sw);
+  return b > MAX_HIST_BITS ? 0 : 1ul << b;
+}
+
+// Collects bits of 32 -bit word, selected by mask, into lowest bits of result,
+// keeping their order, using BMI2 when available
+inline static uint32_t
+extract_bits(const uint32_t x, const uint32_t m)
+{
+#if defined __BMI2__
+  return _pext_u32(x, m);
+#else
+  uint32_t res = 0u;
+  uint32_t msk = m;
+
+  for (uint32_t b = 1u; msk != 0u; b <<= 1) {
+    res |= (x & msk & (0u - msk)) != 0u ? b : 0u;
+    msk &= msk - 1u;
+  }
+
+  return res;
+#endif
+}
+
+// Mixes 64 -bit word, using finalizer of SplitMix64, so that consecutive pair
+// indices give unrelated plain texts
+inline static constexpr uint64_t
+mix(uint64_t z)
+{
+  z += 0x9e3779b97f4a7c15ul;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ul;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebul;
+  return z ^ (z >> 31);
+}
+
+// First plain text P of i -th pair of a sweep, with given seed, as four 32 -bit
+// words
+inline static constexpr void
+pair_input(const uint64_t seed, const uint64_t idx, uint32_t* const words)
+{
+  const uint64_t hi = mix(seed ^ mix(idx << 1));
+  const uint64_t lo = mix(seed ^ mix((idx << 1) | 1));
+
+  words[0] = static_cast<uint32_t>(hi >> 32);
+  words[1] = static_cast<uint32_t>(hi);
+  words[2] = static_cast<uint32_t>(lo >> 32);
+  words[3] = static_cast<uint32_t>(lo);
+}
+
+// Runs differential sweep on T threads ( zero means one per CPU ), adding
+// number of kept pairs to each bin of histogram, which has `bins(sw)` counters
+// and is not zeroed first, so that consecutive sweeps can accumulate into it;
+// returns false, without touching histogram, if rounds run past last round of
+// GIFT-128 or if more than MAX_HIST_BITS bits are selected by HIST_MASK
+//
+// Each thread keeps its own histogram, which is added to given one once it's
+// done, so that no output difference is ever materialised
+inline static bool
+sweep(const sweep_t& sw, uint64_t* const hist, const size_t threads = 0)
+{
+  if (sw.from > gift::ROUNDS || sw.cnt > gift::ROUNDS - sw.from) {
+    return false;
+  }
+
+  if (hist_bits(sw) > MAX_HIST_BITS) {
+    return false;
+  }
+
+  const size_t n_bins = bins(sw);
+
+  // widths of each word's selected bits, so that they are concatenated
+  size_t widths[4];
+  for (size_t j = 0; j < 4; j++) {
+    widths[j] = std::popcount(sw.hist_mask[j]);
+  }
+
+  const size_t t_cnt = pick_threads(threads);
+  std::vector<std::vector<uint64_t>> local(t_cnt);
+
+  auto work = [&](const size_t t, const size_t begin, const size_t end) {
+    std::vector<uint64_t>& h = local[t];
+    h.assign(n_bins, 0);
+
+    gift::lanes_t<LANES> st{};
+
+    for (size_t off = begin; off < end; off += PAIRS) {
+      const size_t n = std::min(PAIRS, end - off);
+
+      for (size_t i = 0; i < PAIRS; i++) {
+        uint32_t p[4];
+        pair_input(sw.seed, sw.first + off + i, p);
+
+        for (size_t j = 0; j < 4; j++) {
+          st.cipher[j][i] = p[j];
+          st.cipher[j][PAIRS + i] = p[j] ^ sw.din[j];
+        }
+      }
+
+      gift::permute(&st, sw.rk, sw.from, sw.cnt);
+
+      for (size_t i = 0; i < n; i++) {
+        bool keep = true;
+        size_t idx = 0;
+
+        for (size_t j = 0; j < 4; j++) {
+          const uint32_t d = st.cipher[j][i] ^ st.cipher[j][PAIRS + i];
+
+          keep &= (d & sw.filter_mask[j]) == sw.filter[j];
+          idx = (idx << widths[j]) | extract_bits(d, sw.hist_mask[j]);
+        }
+
+        h[idx] += keep;
+      }
+    }
+  };
+
+  split(t_cnt, sw.pairs, PAIRS, work);
+
+  for (const std::vector<uint64_t>& h : local) {
+    for (size_t i = 0; i < h.size(); i++) {
+      hist[i] += h[i];
+    }
+  }
+
+  return true;
+}
+
+}
@@ -0,0 +1,654 @@
+#pragma once
+#include "aead.hpp"
+#include "batch.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// GIFT-COFB over shared memory rings, where producers ( threads of same or
+// other processes ) place records in slots of one memfd backed region, and a
+// pool of worker threads seals/ opens them in place, so that neither records
+// are copied nor system calls are made, on the hot path
+//
+// Region is made up of fixed size slots, along with three kinds of bounded
+// lock-free queues of slot indices: free slots, submitted slots ( shared by all
+// producers and workers ) and one completion queue per lane ( say per producer
+// thread ). Only offsets are stored in region, so that it can be mapped at
+// different addresses, by different processes. Linux only ( memfd, eventfd ).
+namespace gift_cofb_ring {
+
+// Tag of initialized region
+constexpr uint64_t MAGIC = 0x676966742d72696eul;
+
+// Number of secret key slots, shared by all producers
+constexpr size_t MAX_KEYS = 16;
+
+// Number of lanes i.e. completion queues
+constexpr size_t MAX_LANES = 64;
+
+// Number of slots in region
+constexpr size_t MAX_SLOTS = 1ul << 24;
+
+// Byte length of payload of each slot
+constexpr size_t MAX_SLOT_LEN = 1ul << 24;
+
+// Returned by queue pops, when queue is empty
+constexpr uint32_t NONE = ~0u;
+
+// Number of failed polls, after which busy-polling thread yields its CPU
+constexpr size_t SPINS = 1024;
+
+// Kinds of records
+enum op_t : uint32_t
+{
+  SEAL = 0, // payload = AD || plain text || ( room for ) tag
+  OPEN      // payload = AD || cipher text || tag
+};
+
+// How idle workers ( and producers waiting for completions ) wait
+enum wait_t : uint32_t
+{
+  BUSY_POLL = 0, // spin on queue, yielding CPU every SPINS -many failed polls
+  EVENTFD        // sleep on eventfd, which is only written to when some
+                 // thread is sleeping on it
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "Atomics in shared memory must be lock-free");
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "Atomics in shared memory must be lock-free");
+
+// One cell of bounded queue, holding slot index, along with sequence number,
+// telling whether it's ready to be pushed to or popped from
+struct cell_t
+{
+  std::atomic<uint64_t> seq;
+  uint32_t val;
+};
+
+// Producer and consumer positions of bounded queue, along with number of
+// threads sleeping on its eventfd, each on its own cache line
+struct queue_hdr_t
+{
+  alignas(64) std::atomic<uint64_t> head;
+  alignas(64) std::atomic<uint64_t> tail;
+  alignas(64) std::atomic<uint32_t> sleepers;
+};
+
+// View of bounded multi-producer multi-consumer queue, living in shared
+// region, whose capacity is power of 2; see
+// https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+//
+// Each push/ pop claims a position with one compare-and-swap and publishes it
+// with one release store on cell's sequence number, so that single producer/
+// single consumer use of it is also cheap
+struct queue_t
+{
+  queue_hdr_t* hdr = nullptr;
+  cell_t* cells = nullptr;
+  uint64_t mask = 0;
+
+  // Initializes empty queue, before region is shared
+  inline void init()
+  {
+    hdr->head.store(0, std::memory_order_relaxed);
+    hdr->tail.store(0, std::memory_order_relaxed);
+    hdr->sleepers.store(0, std::memory_order_relaxed);
+
+    for (uint64_t i = 0; i <= mask; i++) {
+      cells[i].seq.store(i, std::memory_order_relaxed);
+      cells[i].val = NONE;
+    }
+  }
+
+  // Pushes slot index, returning false if queue is full
+  inline bool push(const uint32_t val)
+  {
+    uint64_t pos = hdr->tail.load(std::memory_order_relaxed);
+    cell_t* c;
+
+    while (true) {
+      c = cells + (pos & mask);
+
+      const uint64_t seq = c->seq.load(std::memory_order_acquire);
+      const int64_t dif = static_cast<int64_t>(seq - pos);
+
+      if (dif == 0) {
+        if (hdr->tail.compare_exchange_weak(
+              pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (dif < 0) {
+        return false;
+      } else {
+        pos = hdr->tail.load(std::memory_order_relaxed);
+      }
+    }
+
+    c->val = val;
+    c->seq.store(pos + 1, std::memory_order_release);
+
+    return true;
+  }
+
+  // Pops slot index, returning NONE if queue is empty
+  inline uint32_t pop()
+  {
+    uint64_t pos = hdr->head.load(std::memory_order_relaxed);
+    cell_t* c;
+
+    while (true) {
+      c = cells + (pos & mask);
+
+      const uint64_t seq = c->seq.load(std::memory_order_acquire);
+      const int64_t dif = static_cast<int64_t>(seq - (pos + 1));
+
+      if (dif == 0) {
+        if (hdr->head.compare_exchange_weak(
+              pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (dif < 0) {
+        return NONE;
+      } else {
+        pos = hdr->head.load(std::memory_order_relaxed);
+      }
+    }
+
+    const uint32_t val = c->val;
+    c->seq.store(pos + mask + 1, std::memory_order_release);
+
+    return val;
+  }
+};
+
+// Descriptor of one slot, filled in by producer before submission; `ok` is
+// written by worker, before slot is pushed to completion queue of its lane
+struct slot_t
+{
+  uint32_t op;
+  uint32_t key_idx;
+  uint32_t lane;
+  uint32_t ok;
+  uint64_t user; // opaque to workers, say index of packet
+  uint8_t nonce[16];
+  uint32_t dlen; // byte length of associated data
+  uint32_t len;  // byte length of plain/ cipher text, excluding tag
+};
+
+// Header of shared region
+struct shm_t
+{
+  uint64_t magic;
+  uint32_t slots;
+  uint32_t slot_len; // byte length of payload of each slot
+  uint32_t lanes;
+  uint32_t wait;
+  std::atomic<uint32_t> stop;
+  alignas(64) uint8_t keys[MAX_KEYS << 4];
+};
+
+// Byte offsets of parts of shared region
+struct layout_t
+{
+  size_t free_q;
+  size_t sub_q;
+  size_t cmp_q; // first of `lanes` -many completion queues
+  size_t queue_len;
+  size_t descs;
+  size_t payloads;
+  size_t size;
+};
+
+// Computes byte offsets of parts of shared region
+inline static layout_t
+layout(const size_t slots, const size_t slot_len, const size_t lanes)
+{
+  using gift_cofb_batch::round_up;
+  constexpr size_t A = gift_cofb_batch::ALIGN;
+
+  layout_t l;
+
+  l.queue_len = round_up(sizeof(queue_hdr_t) + slots * sizeof(cell_t), A);
+  l.free_q = round_up(sizeof(shm_t), A);
+  l.sub_q = l.free_q + l.queue_len;
+  l.cmp_q = l.sub_q + l.queue_len;
+  l.descs = l.cmp_q + lanes * l.queue_len;
+  l.payloads = l.descs + round_up(slots * sizeof(slot_t), A);
+  l.size = l.payloads + slots * round_up(slot_len, A);
+
+  return l;
+}
+
+// Spin loop hint, issued between failed polls
+inline static void
+relax()
+{
+#if defined __x86_64__ || defined __i386__
+  __builtin_ia32_pause();
+#elif defined __aarch64__
+  __asm__ volatile("yield");
+#endif
+}
+
+// Process local handle of shared region, either created by this process or
+// attached to, using file descriptors inherited from/ passed by its creator
+struct ring_t
+{
+  int fd = -1;      // memfd backing region
+  int sub_efd = -1; // eventfd, on which idle workers sleep
+  int cmp_efd[MAX_LANES];
+  bool owner = false;
+
+  uint8_t* base = nullptr;
+  size_t size = 0;
+  size_t stride = 0; // byte distance between payloads of adjacent slots
+
+  // Geometry of region, captured by `create`/ `attach`, so that records are
+  // checked against it, not against header of ( writable ) shared region
+  size_t slot_cnt = 0;
+  size_t payload_len = 0;
+  size_t lane_cnt = 0;
+
+  shm_t* shm = nullptr;
+  queue_t free_q;
+  queue_t sub_q;
+  queue_t cmp_q[MAX_LANES];
+  slot_t* descs = nullptr;
+  uint8_t* payloads = nullptr;
+
+  ring_t() { std::fill(cmp_efd, cmp_efd + MAX_LANES, -1); }
+  ring_t(const ring_t&) = delete;
+  ring_t& operator=(const ring_t&) = delete;
+
+  ~ring_t()
+  {
+    if (base != nullptr) {
+      munmap(base, size);
+    }
+    if (!owner) {
+      return;
+    }
+
+    if (fd >= 0) {
+      close(fd);
+    }
+    if (sub_efd >= 0) {
+      close(sub_efd);
+    }
+    for (const int efd : cmp_efd) {
+      if (efd >= 0) {
+        close(efd);
+      }
+    }
+  }
+
+  // Creates shared region of N slots ( rounded up to power of 2 ), each with
+  // M -bytes payload, and L lanes, returning false on error | N, L > 0
+  inline bool create(const size_t slots,
+                     const size_t slot_len,
+                     const size_t lanes,
+                     const wait_t wait)
+  {
+    if (slots == 0 || slots > MAX_SLOTS || slot_len == 0 ||
+        slot_len > MAX_SLOT_LEN || lanes == 0 || lanes > MAX_LANES) {
+      return false;
+    }
+
+    const size_t cap = std::bit_ceil(slots);
+    const layout_t l = layout(cap, slot_len, lanes);
+
+    slot_cnt = cap;
+    payload_len = slot_len;
+    lane_cnt = lanes;
+
+    owner = true;
+    fd = memfd_create("gift_cofb_ring", MFD_CLOEXEC);
+    if (fd < 0 || ftruncate(fd, static_cast<off_t>(l.size)) != 0) {
+      return false;
+    }
+
+    sub_efd = eventfd(0, EFD_CLOEXEC | EFD_SEMAPHORE);
+    if (sub_efd < 0) {
+      return false;
+    }
+    for (size_t i = 0; i < lanes; i++) {
+      cmp_efd[i] = eventfd(0, EFD_CLOEXEC | EFD_SEMAPHORE);
+      if (cmp_efd[i] < 0) {
+        return false;
+      }
+    }
+
+    if (!map(l.size)) {
+      return false;
+    }
+
+    shm->slots = static_cast<uint32_t>(cap);
+    shm->slot_len = static_cast<uint32_t>(slot_len);
+    shm->lanes = static_cast<uint32_t>(lanes);
+    shm->wait = wait;
+    shm->stop.store(0, std::memory_order_relaxed);
+    std::memset(shm->keys, 0, sizeof(shm->keys));
+
+    views();
+
+    free_q.init();
+    sub_q.init();
+    for (size_t i = 0; i < lanes; i++) {
+      cmp_q[i].init();
+    }
+    for (uint32_t i = 0; i < cap; i++) {
+      free_q.push(i);
+    }
+
+    std::atomic_thread_fence(std::memory_order_release);
+    shm->magic = MAGIC;
+
+    return true;
+  }
+
+  // Attaches to shared region, created by some other handle ( possibly in some
+  // other process ), returning false if it's not an initialized region;
+  // file descriptors are borrowed, not closed by this handle
+  inline bool attach(const int mfd, const int sefd, const int* const cefds)
+  {
+    fd = mfd;
+    sub_efd = sefd;
+
+    // leading fields of `shm_t`, read before mapping region
+    struct
+    {
+      uint64_t magic;
+      uint32_t slots;
+      uint32_t slot_len;
+      uint32_t lanes;
+    } hdr;
+
+    if (pread(fd, &hdr, sizeof(hdr), 0) != sizeof(hdr) || hdr.magic != MAGIC) {
+      return false;
+    }
+
+    // header lives in region, writable by everyone sharing it, so geometry is
+    // checked once here, before anything is sized from it
+    if (hdr.slots == 0 || hdr.slots > MAX_SLOTS ||
+        !std::has_single_bit(hdr.slots) || hdr.slot_len == 0 ||
+        hdr.slot_len > MAX_SLOT_LEN || hdr.lanes == 0 ||
+        hdr.lanes > MAX_LANES) {
+      return false;
+    }
+
+    const layout_t l = layout(hdr.slots, hdr.slot_len, hdr.lanes);
+
+    struct stat sb;
+    if (fstat(fd, &sb) != 0 || static_cast<size_t>(sb.st_size) < l.size) {
+      return false;
+    }
+
+    slot_cnt = hdr.slots;
+    payload_len = hdr.slot_len;
+    lane_cnt = hdr.lanes;
+
+    std::copy(cefds, cefds + lane_cnt, cmp_efd);
+
+    if (!map(l.size)) {
+      return false;
+    }
+
+    views();
+    return true;
+  }
+
+  // Installs 128 -bit secret key in given key slot, which must not be in use
+  // by any submitted record
+  inline void set_key(const uint32_t key_idx, const uint8_t* const key)
+  {
+    std::memcpy(shm->keys + (static_cast<size_t>(key_idx) << 4), key, 16);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  // Descriptor of i -th slot
+  inline slot_t* desc(const uint32_t idx) { return descs + idx; }
+
+  // Payload of i -th slot, holding AD || text || tag
+  inline uint8_t* payload(const uint32_t idx)
+  {
+    return payloads + static_cast<size_t>(idx) * stride;
+  }
+
+  // Takes one free slot, returning NONE if all slots are in use
+  inline uint32_t acquire() { return free_q.pop(); }
+
+  // Gives slot back, after its completion is consumed
+  inline void release(const uint32_t idx) { free_q.push(idx); }
+
+  // Hands filled in slot over to workers
+  inline void submit(const uint32_t idx)
+  {
+    sub_q.push(idx);
+    notify(&sub_q, sub_efd);
+  }
+
+  // Pops completed slot of given lane, without waiting, returning NONE if
+  // there's none
+  inline uint32_t reap(const uint32_t lane) { return cmp_q[lane].pop(); }
+
+  // Pops completed slot of given lane, waiting ( as configured ) for one,
+  // returning NONE only if region is being stopped
+  inline uint32_t wait(const uint32_t lane)
+  {
+    return await(&cmp_q[lane], cmp_efd[lane]);
+  }
+
+  // Seals/ opens record in i -th slot, in place, and pushes slot to completion
+  // queue of its lane
+  //
+  // Descriptor lives in shared region, where producer may still be writing to
+  // it, so that each field is read only once, into a local, which is both
+  // checked and used; slot indices out of range are dropped
+  inline void process(const uint32_t idx)
+  {
+    if (idx >= slot_cnt) {
+      return;
+    }
+
+    slot_t* const d = desc(idx);
+    uint8_t* const p = payload(idx);
+
+    auto once = [](uint32_t& f) {
+      return std::atomic_ref<uint32_t>(f).load(std::memory_order_relaxed);
+    };
+
+    const uint32_t op = once(d->op);
+    const uint32_t key_idx = once(d->key_idx);
+    const uint32_t lane_idx = once(d->lane);
+    const size_t dlen = once(d->dlen);
+    const size_t len = once(d->len);
+
+    // AD, text and tag must fit in payload, checked without any overflow
+    const bool fits = (dlen <= payload_len) && (len <= payload_len - dlen) &&
+                      (gift_cofb::TAG_LEN <= payload_len - dlen - len);
+    const bool valid = fits && (key_idx < MAX_KEYS) && (lane_idx < lane_cnt);
+
+    if (!valid) {
+      d->ok = 0;
+    } else {
+      const size_t koff = static_cast<size_t>(key_idx) << 4;
+      const uint8_t* const key = shm->keys + koff;
+      uint8_t* const txt = p + dlen;
+
+      if (op == SEAL) {
+        gift_cofb::seal(key, d->nonce, p, dlen, txt, len, txt);
+        d->ok = 1;
+      } else {
+        const size_t inlen = len + gift_cofb::TAG_LEN;
+        d->ok = gift_cofb::open(key, d->nonce, p, dlen, txt, inlen, txt);
+      }
+    }
+
+    const uint32_t lane = lane_idx < lane_cnt ? lane_idx : 0;
+
+    cmp_q[lane].push(idx);
+    notify(&cmp_q[lane], cmp_efd[lane]);
+  }
+
+  // Worker loop, processing submitted slots until region is stopped
+  inline void work()
+  {
+    uint32_t idx;
+    while ((idx = await(&sub_q, sub_efd)) != NONE) {
+      process(idx);
+    }
+  }
+
+  // Asks workers and waiting producers to return, waking sleeping ones
+  inline void stop()
+  {
+    shm->stop.store(1, std::memory_order_seq_cst);
+
+    const uint64_t many = 1ul << 32;
+    (void)!write(sub_efd, &many, sizeof(many));
+
+    for (size_t i = 0; i < lane_cnt; i++) {
+      (void)!write(cmp_efd[i], &many, sizeof(many));
+    }
+  }
+
+private:
+  // Maps shared region of given byte length
+  inline bool map(const size_t len)
+  {
+    void* const ptr =
+      mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (ptr == MAP_FAILED) {
+      return false;
+    }
+
+    base = static_cast<uint8_t*>(ptr);
+    size = len;
+    shm = reinterpret_cast<shm_t*>(base);
+
+    return true;
+  }
+
+  // Points queue views, descriptors and payloads into mapped region
+  inline void views()
+  {
+    const layout_t l = layout(slot_cnt, payload_len, lane_cnt);
+
+    auto view = [&](queue_t* const q, const size_t off) {
+      q->hdr = reinterpret_cast<queue_hdr_t*>(base + off);
+      q->cells = reinterpret_cast<cell_t*>(base + off + sizeof(queue_hdr_t));
+      q->mask = slot_cnt - 1;
+    };
+
+    view(&free_q, l.free_q);
+    view(&sub_q, l.sub_q);
+    for (size_t i = 0; i < lane_cnt; i++) {
+      view(&cmp_q[i], l.cmp_q + i * l.queue_len);
+    }
+
+    descs = reinterpret_cast<slot_t*>(base + l.descs);
+    payloads = base + l.payloads;
+    stride = gift_cofb_batch::round_up(payload_len, gift_cofb_batch::ALIGN);
+  }
+
+  // Wakes one thread sleeping on queue's eventfd, if there's any; pairs with
+  // fence in `await`, so that either sleeper sees pushed index or this sees
+  // sleeper
+  inline void notify(queue_t* const q, const int efd)
+  {
+    if (shm->wait != EVENTFD) {
+      return;
+    }
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (q->hdr->sleepers.load(std::memory_order_relaxed) > 0) {
+      const uint64_t one = 1;
+      (void)!write(efd, &one, sizeof(one));
+    }
+  }
+
+  // Pops from queue, waiting ( as configured ) while it's empty, returning
+  // NONE only if region is being stopped
+  inline uint32_t await(queue_t* const q, const int efd)
+  {
+    size_t spins = 0;
+
+    while (shm->stop.load(std::memory_order_relaxed) == 0) {
+      uint32_t idx = q->pop();
+      if (idx != NONE) {
+        return idx;
+      }
+
+      if (shm->wait == BUSY_POLL) {
+        relax();
+
+        if (++spins == SPINS) {
+          spins = 0;
+          std::this_thread::yield();
+        }
+        continue;
+      }
+
+      q->hdr->sleepers.fetch_add(1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+
+      idx = q->pop();
+      if (idx == NONE && shm->stop.load(std::memory_order_relaxed) == 0) {
+        uint64_t cnt;
+        while (read(efd, &cnt, sizeof(cnt)) < 0 && errno == EINTR) {
+        }
+      }
+
+      q->hdr->sleepers.fetch_sub(1, std::memory_order_relaxed);
+
+      if (idx != NONE) {
+        return idx;
+      }
+    }
+
+    return NONE;
+  }
+};
+
+// Pool of worker threads, draining submitted slots of one region, until it's
+// destroyed, which stops region
+struct pool_t
+{
+  ring_t* ring;
+  std::vector<std::thread> threads;
+
+  pool_t(ring_t* const r, const size_t workers)
+    : ring(r)
+  {
+    for (size_t i = 0; i < workers; i++) {
+      threads.emplace_back([r]() { r->work(); });
+    }
+  }
+
+  pool_t(const pool_t&) = delete;
+  pool_t& operator=(const pool_t&) = delete;
+
+  ~pool_t()
+  {
+    ring->stop();
+
+    for (auto& t : threads) {
+      t.join();
+    }
+  }
+};
+
+}
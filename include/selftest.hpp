@@ -0,0 +1,188 @@
+#pragma once
+#include "aead.hpp"
+#include "common.hpp"
+#include "gift.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+// Known Answer Self-Test of GIFT-COFB, for deployments which must run one at
+// process start, split into ( a ) a compile-time part, where a handful of NIST
+// LWC Known Answer Tests are checked with `static_assert`, on portable
+// GIFT-COFB ( see `gift_cofb::encrypt_constexpr` ), so that a build which
+// doesn't match them fails to compile and ( b ) a tiny run-time part, which
+// checks that `encrypt`/ `decrypt`, on whichever PermBits backend they are
+// dispatched to, produce same output, costing a few dozen GIFT-128 calls
+namespace gift_cofb_selftest {
+
+// One Known Answer Test, from `LWC_AEAD_KAT_128_128.txt`, where key and nonce
+// are bytes 0, 1 ... 15, while N -bytes associated data and M -bytes plain
+// text are bytes 0, 1 ... N-1 and 0, 1 ... M-1 | N, M <= 32
+struct kat_t
+{
+  size_t count;
+  size_t dlen;
+  size_t ctlen;
+  uint8_t ct[48]; // M -bytes cipher text || 128 -bit tag
+};
+
+// Covering empty, partial, full and multi-block associated data/ plain text
+constexpr kat_t KATS[]{
+  { 1,
+    0,
+    0,
+    { 0x36, 0x89, 0x65, 0x83, 0x6d, 0x36, 0x61, 0x4d,
+      0xe2, 0xfc, 0x24, 0xd0, 0xf8, 0x01, 0xb9, 0xaf } },
+  { 18,
+    17,
+    0,
+    { 0x65, 0x91, 0xab, 0x7e, 0x3c, 0xac, 0xb1, 0xa5,
+      0xb0, 0xbe, 0x50, 0x63, 0x3e, 0x73, 0x52, 0x96 } },
+  { 34,
+    0,
+    1,
+    { 0x5d, 0xf9, 0x6d, 0xb3, 0x29, 0xe9, 0x26, 0x88, 0x24,
+      0x2e, 0xf4, 0xe0, 0x6f, 0x94, 0xfe, 0x1b, 0xd9 } },
+  { 545,
+    16,
+    16,
+    { 0x3b, 0xff, 0x71, 0x5a, 0x56, 0xcb, 0xa4, 0x9d, 0x1f, 0x7a, 0xc0,
+      0x69, 0x1a, 0x96, 0x6f, 0xdc, 0xbf, 0x77, 0x81, 0x40, 0x44, 0xbf,
+      0x3f, 0xc9, 0xa9, 0xde, 0xbb, 0xd3, 0x93, 0xf5, 0x45, 0xd4 } },
+  { 701,
+    7,
+    21,
+    { 0x51, 0x15, 0x4c, 0x40, 0xa6, 0x82, 0xca, 0x58, 0x90, 0x70, 0x21, 0x1f,
+      0x76, 0xe4, 0x22, 0x76, 0x04, 0x43, 0xa1, 0x3a, 0xf7, 0x01, 0x2c, 0xb8,
+      0xfe, 0xfa, 0x11, 0xe8, 0x90, 0x23, 0x47, 0x3a, 0xbb, 0x5c, 0xb9, 0x59,
+      0xcd } },
+  { 1089,
+    32,
+    32,
+    { 0xba, 0xf5, 0x63, 0xc6, 0x0f, 0xbe, 0xdd, 0xc5, 0x66, 0x29, 0x95, 0xf4,
+      0xc6, 0x78, 0xbe, 0x80, 0xa7, 0xf7, 0xde, 0x9b, 0x3a, 0xd8, 0xc9, 0x7a,
+      0xa6, 0xca, 0x17, 0x01, 0x6d, 0x2a, 0xe6, 0x50, 0x8e, 0x6f, 0xb3, 0xf7,
+      0x9b, 0x41, 0x2a, 0x16, 0x27, 0xab, 0x7d, 0xfa, 0x75, 0x5e, 0x0a,
+      0x22 } },
+};
+
+// Fills N -bytes with 0, 1 ... N-1, as in NIST LWC Known Answer Tests
+inline static constexpr void
+fill_kat_bytes(uint8_t* const bytes, const size_t len)
+{
+  for (size_t i = 0; i < len; i++) {
+    bytes[i] = static_cast<uint8_t>(i);
+  }
+}
+
+// Inputs of Known Answer Tests, shared by all of them
+struct inputs_t
+{
+  uint8_t key[16];
+  uint8_t nonce[16];
+  uint8_t data[32];
+  uint8_t txt[32];
+
+  constexpr inputs_t()
+    : key()
+    , nonce()
+    , data()
+    , txt()
+  {
+    fill_kat_bytes(key, sizeof(key));
+    fill_kat_bytes(nonce, sizeof(nonce));
+    fill_kat_bytes(data, sizeof(data));
+    fill_kat_bytes(txt, sizeof(txt));
+  }
+};
+
+// Checks one Known Answer Test, on portable GIFT-COFB, which is also how it's
+// evaluated at compile-time
+inline static constexpr bool
+check_constexpr(const kat_t& k)
+{
+  const inputs_t in;
+  uint8_t out[48]{};
+
+  gift_cofb::encrypt_constexpr(
+    in.key, in.nonce, in.data, k.dlen, in.txt, out, k.ctlen, out + k.ctlen);
+
+  return std::equal(out, out + k.ctlen + 16, k.ct);
+}
+
+// Checks every Known Answer Test, on portable GIFT-COFB
+inline static constexpr bool
+check_all_constexpr()
+{
+  for (const kat_t& k : KATS) {
+    if (!check_constexpr(k)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static_assert(check_all_constexpr(),
+              "GIFT-COFB doesn't match NIST LWC Known Answer Tests");
+
+// Round keys of Known Answer Test key, derived at compile-time, so that they
+// are embedded in binary as constants
+constexpr gift::round_keys_t KAT_ROUND_KEYS = []() {
+  const inputs_t in;
+
+  gift::round_keys_t rk{};
+  gift::expand_key(&rk, in.key);
+  return rk;
+}();
+
+// GIFT-128 on precomputed round keys must agree with GIFT-128 running key
+// schedule alongside rounds, as used by `encrypt_block`, given same key
+static_assert(
+  []() {
+    const inputs_t in;
+
+    gift::state_t a{}, b{};
+    gift::initialize(&a, in.nonce, in.key);
+    gift::initialize(&b, in.nonce, in.key);
+
+    gift::permute<gift::ROUNDS>(&a);
+    gift::permute<gift::ROUNDS>(&b, &KAT_ROUND_KEYS);
+
+    return std::equal(a.cipher, a.cipher + 4, b.cipher);
+  }(),
+  "GIFT-128 round key schedules disagree");
+
+// Run-time part of power-on self-test, checking that `encrypt` and `decrypt`,
+// on dispatched PermBits backend, reproduce Known Answer Tests, which are
+// already verified at compile-time, returning false if any of them doesn't
+//
+// Only last two of them are run, as between them, they go through full and
+// partial blocks of both associated data and plain text, while remaining ones
+// differ only in masking offset constants, which don't depend on backend
+inline static bool
+power_on()
+{
+  const inputs_t in;
+  bool ok = true;
+
+  for (const kat_t* const k : { &KATS[4], &KATS[5] }) {
+    uint8_t out[48]{};
+    uint8_t dec[32]{};
+
+    const size_t dlen = k->dlen;
+    const size_t ctlen = k->ctlen;
+
+    gift_cofb::encrypt(
+      in.key, in.nonce, in.data, dlen, in.txt, out, ctlen, out + ctlen);
+    ok &= std::equal(out, out + ctlen + 16, k->ct);
+
+    ok &= gift_cofb::decrypt(
+      in.key, in.nonce, k->ct + ctlen, in.data, dlen, k->ct, dec, ctlen);
+    ok &= std::equal(dec, dec + ctlen, in.txt);
+  }
+
+  return ok;
+}
+
+}
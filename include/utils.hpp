@@ -1,8 +1,8 @@
 #pragma once
+#include "random.hpp"
 #include <cstddef>
 #include <cstdint>
 #include <iomanip>
-#include <random>
 #include <sstream>
 
 // Given a bytearray of length N, this function converts it to human readable
@@ -20,15 +20,10 @@ to_hex(const uint8_t* const bytes, const size_t len)
   return ss.str();
 }
 
-// Generates N -many random bytes | N >= 0
+// Generates N -many random bytes, from calling thread's buffered pool of
+// operating system provided random bytes | N >= 0
 static inline void
 random_data(uint8_t* const data, const size_t len)
 {
-  std::random_device rd;
-  std::mt19937_64 gen(rd());
-  std::uniform_int_distribution<uint8_t> dis;
-
-  for (size_t i = 0; i < len; i++) {
-    data[i] = dis(gen);
-  }
+  gift_cofb_random::fill(data, len);
 }
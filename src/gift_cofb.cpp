@@ -0,0 +1,23 @@
+// Compiled GIFT-COFB library, holding only out-of-line instantiations of
+// GIFT-128 permutation and GIFT-COFB encrypt/ decrypt routines, which every
+// translation unit built with GIFT_COFB_COMPILED links against, instead of
+// compiling its own copy; see `linkage.hpp`
+//
+// Build it with
+//
+// make archive
+//
+// and link against it with
+//
+// g++ -std=c++20 -O3 -march=native -DGIFT_COFB_COMPILED -I ./include main.cpp
+//   src/libgift_cofb.a
+
+#if !defined GIFT_COFB_COMPILED
+#define GIFT_COFB_COMPILED
+#endif
+
+#define GIFT_COFB_BUILD
+
+#include "aead.hpp"
+#include "common.hpp"
+#include "gift.hpp"
@@ -0,0 +1,1018 @@
+#include "aead.hpp"
+#include "batch.hpp"
+#include "gift.hpp"
+#include "incremental.hpp"
+#include "modes.hpp"
+#include "offload.hpp"
+#include "reduced.hpp"
+#include "selftest.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+// Self-contained correctness gate, which ( a ) checks GIFT-COFB against every
+// Known Answer Test of vendored `LWC_AEAD_KAT_128_128.txt`, in parallel, and
+// ( b ) runs a randomised differential test, where a plain, byte oriented
+// GIFT-COFB reference ( written from specification, using reference PermBits )
+// is compared against same reference on every compiled in PermBits backend
+// ( scalar, SSE2, AVX2, NEON ) and against every optimised entry point i.e.
+// `gift_cofb::encrypt`/ `decrypt` ( with whichever backend is dispatched to ),
+// compile-time evaluable, in-place and large message ( streamed ) encryption,
+// encryption from E_K(N) computed in transposed lanes, batch API, incremental
+// API, resumed from a checkpoint after every chunk, and in-place `decrypt`/
+// `open` along with both release policies, on genuine and forged tags, followed
+// by ( c ) a check of reduced-round GIFT-128 bulk evaluator and differential
+// sweep, against one block at a time GIFT-128 and ( d ) a check that offload
+// daemon seals requests under key installed when they were sent
+//
+// Compile it with
+//
+// make test/test_gift_cofb.out
+//
+// Run it with ( all arguments are optional; zero threads means one per CPU )
+//
+// ./test/test_gift_cofb.out --kat=test/LWC_AEAD_KAT_128_128.txt --iters=20000
+// --threads=0 --seed=42
+//
+// Same differential check is also a libFuzzer target, when compiled with
+// clang++ -fsanitize=fuzzer and GIFT_COFB_LIBFUZZER defined, see `make fuzz`
+
+// Reads value of command line option of form --name=value, if present
+static size_t
+option(const int argc, char** argv, const char* name, const size_t dflt)
+{
+  const size_t nlen = std::strlen(name);
+
+  for (int i = 1; i < argc; i++) {
+    if (std::strncmp(argv[i], name, nlen) == 0 && argv[i][nlen] == '=') {
+      return std::strtoull(argv[i] + nlen + 1, nullptr, 10);
+    }
+  }
+
+  return dflt;
+}
+
+// Reads value of command line option of form --name=value, if present
+static const char*
+option(const int argc, char** argv, const char* name, const char* dflt)
+{
+  const size_t nlen = std::strlen(name);
+
+  for (int i = 1; i < argc; i++) {
+    if (std::strncmp(argv[i], name, nlen) == 0 && argv[i][nlen] == '=') {
+      return argv[i] + nlen + 1;
+    }
+  }
+
+  return dflt;
+}
+
+// GIFT-128 encryption of one 128 -bit block, round by round, as in
+// specification, using given PermBits backend
+template<void (*perm)(gift::state_t* const)>
+static void
+ref_cipher(const uint8_t* const key,
+           const uint8_t* const in,
+           uint8_t* const out)
+{
+  gift::state_t st;
+  gift::initialize(&st, in, key);
+
+  for (size_t r = 0; r < gift::ROUNDS; r++) {
+    gift::sub_cells(&st);
+    perm(&st);
+    gift::add_round_keys(&st, r);
+    gift::update_key_state(&st);
+  }
+
+  for (size_t i = 0; i < 16; i++) {
+    out[i] = static_cast<uint8_t>(st.cipher[i >> 2] >> ((3 - (i & 3)) << 3));
+  }
+}
+
+// Multiplies masking offset L ( 8 -bytes, big-endian ) by 2, in field 2^64
+static void
+ref_double(uint8_t* const l)
+{
+  const uint8_t carry = l[0] >> 7;
+
+  for (size_t i = 0; i < 7; i++) {
+    l[i] = static_cast<uint8_t>((l[i] << 1) | (l[i + 1] >> 7));
+  }
+  l[7] = static_cast<uint8_t>((l[7] << 1) ^ (carry ? 0x1b : 0));
+}
+
+// Multiplies masking offset L ( 8 -bytes, big-endian ) by 3, in field 2^64
+static void
+ref_triple(uint8_t* const l)
+{
+  uint8_t t[8];
+  std::memcpy(t, l, sizeof(t));
+
+  ref_double(l);
+  for (size_t i = 0; i < 8; i++) {
+    l[i] ^= t[i];
+  }
+}
+
+// Y = E_K(X ^ G(Y) ^ (L || 0^64)), where X is first N -bytes of block, padded
+// with 10* when N < 16, while G(Y) = Y[2] || (Y[1] <<< 1) | 0 <= N <= 16
+template<void (*perm)(gift::state_t* const)>
+static void
+ref_absorb(const uint8_t* const key,
+           uint8_t* const y,
+           const uint8_t* const l,
+           const uint8_t* const blk,
+           const size_t len)
+{
+  // block of empty associated data/ text may be a null pointer
+  uint8_t x[16]{};
+  if (len > 0) {
+    std::memcpy(x, blk, len);
+  }
+  if (len < 16) {
+    x[len] = 0x80;
+  }
+
+  for (size_t i = 0; i < 8; i++) {
+    x[i] ^= y[8 + i] ^ l[i];
+    x[8 + i] ^= static_cast<uint8_t>((y[i] << 1) | (y[(i + 1) & 7] >> 7));
+  }
+
+  ref_cipher<perm>(key, x, y);
+}
+
+// GIFT-COFB encryption, as in figure 2.3 of specification, processing one
+// block at a time, with masking offset updated one doubling at a time
+template<void (*perm)(gift::state_t* const)>
+static void
+ref_encrypt(const uint8_t* const key,
+            const uint8_t* const nonce,
+            const uint8_t* const data,
+            const size_t dlen,
+            const uint8_t* const txt,
+            uint8_t* const enc,
+            const size_t ctlen,
+            uint8_t* const tag)
+{
+  uint8_t y[16], l[8];
+
+  ref_cipher<perm>(key, nonce, y);
+  std::memcpy(l, y, sizeof(l));
+
+  const size_t ablks = dlen == 0 ? 1 : (dlen + 15) >> 4;
+  for (size_t i = 0; i + 1 < ablks; i++) {
+    ref_double(l);
+    ref_absorb<perm>(key, y, l, data + (i << 4), 16);
+  }
+
+  const size_t arem = dlen - ((ablks - 1) << 4);
+  ref_triple(l);
+  if (dlen == 0 || arem < 16) {
+    ref_triple(l);
+  }
+  if (ctlen == 0) {
+    ref_triple(l);
+    ref_triple(l);
+  }
+  ref_absorb<perm>(key, y, l, data + ((ablks - 1) << 4), arem);
+
+  if (ctlen > 0) {
+    const size_t mblks = (ctlen + 15) >> 4;
+
+    for (size_t i = 0; i < mblks; i++) {
+      const size_t off = i << 4;
+      const size_t len = std::min<size_t>(16, ctlen - off);
+
+      if (i + 1 < mblks) {
+        ref_double(l);
+      } else {
+        ref_triple(l);
+        if (len < 16) {
+          ref_triple(l);
+        }
+      }
+
+      for (size_t j = 0; j < len; j++) {
+        enc[off + j] = txt[off + j] ^ y[j];
+      }
+      ref_absorb<perm>(key, y, l, txt + off, len);
+    }
+  }
+
+  std::memcpy(tag, y, 16);
+}
+
+// Encryption routine, with signature of `ref_encrypt`
+using encrypt_t = void (*)(const uint8_t*,
+                           const uint8_t*,
+                           const uint8_t*,
+                           size_t,
+                           const uint8_t*,
+                           uint8_t*,
+                           size_t,
+                           uint8_t*);
+
+// Every compiled in PermBits backend, run through reference GIFT-COFB
+struct backend_t
+{
+  const char* name;
+  encrypt_t encrypt;
+};
+
+constexpr backend_t BACKENDS[]{
+  { "perm_bits_scalar", ref_encrypt<gift::perm_bits_scalar> },
+#if defined __SSE2__
+  { "perm_bits_sse2", ref_encrypt<gift::perm_bits_sse2> },
+#if defined __AVX2__
+  { "perm_bits_avx2", ref_encrypt<gift::perm_bits_avx2> },
+#endif
+#endif
+#if defined __ARM_NEON
+  { "perm_bits_neon", ref_encrypt<gift::perm_bits_neon> },
+#endif
+};
+
+// Reports first failure only, so that a broken kernel doesn't flood output
+static void
+report(const char* what, const size_t dlen, const size_t ctlen)
+{
+  static std::once_flag once;
+  std::call_once(once, [&]() {
+    std::fprintf(
+      stderr, "FAIL: %s, AD %zu, PT %zu -bytes\n", what, dlen, ctlen);
+  });
+}
+
+// Per-thread scratch space of differential check
+struct scratch_t
+{
+  std::vector<uint8_t> ref, out, dec;
+  gift_cofb_batch::arena_t arena{ 4096 };
+  gift_cofb_batch::jobs_t jobs;
+
+  explicit scratch_t(const size_t max_len)
+    : ref(max_len + 16)
+    , out(max_len + 64)
+    , dec(max_len + 16)
+  {
+  }
+};
+
+// Cipher text ( followed by tag ) of a candidate matches reference's
+static bool
+same(const scratch_t& s, const uint8_t* const out, const size_t ctlen)
+{
+  return std::memcmp(s.ref.data(), out, ctlen + 16) == 0;
+}
+
+// Exports incremental context as checkpoint and imports it back, into a wiped
+// context, after checking that a corrupted copy of checkpoint is rejected
+static bool
+resume(gift_cofb_incremental::context_t* const ctx, const uint8_t* const key)
+{
+  namespace inc = gift_cofb_incremental;
+
+  uint8_t blob[inc::CHECKPOINT_LEN];
+  if (!inc::checkpoint(ctx, blob)) {
+    return false;
+  }
+
+  std::memset(ctx, 0xff, sizeof(inc::context_t));
+
+  const size_t pos = (blob[inc::HEADER_LEN] * 7) % inc::CHECKPOINT_LEN;
+  blob[pos] ^= 1;
+  const bool forged = inc::restore(ctx, key, blob);
+  blob[pos] ^= 1;
+
+  return !forged && inc::restore(ctx, key, blob);
+}
+
+// Runs every backend/ entry point on one input, against reference, returning
+// false ( after reporting it ) on first mismatch
+static bool
+differential(scratch_t& s,
+             const uint8_t* const key,
+             const uint8_t* const nonce,
+             const uint8_t* const data,
+             const size_t dlen,
+             const uint8_t* const txt,
+             const size_t ctlen)
+{
+  using gift::perm_bits_ref;
+
+  uint8_t* const ref = s.ref.data();
+  ref_encrypt<perm_bits_ref>(
+    key, nonce, data, dlen, txt, ref, ctlen, ref + ctlen);
+
+  // 16 -bytes aligned output, so that streamed encryption takes its
+  // non-temporal store path
+  const uintptr_t addr = reinterpret_cast<uintptr_t>(s.out.data());
+  uint8_t* const out = s.out.data() + ((16 - (addr & 15)) & 15);
+
+  for (const backend_t& b : BACKENDS) {
+    b.encrypt(key, nonce, data, dlen, txt, out, ctlen, out + ctlen);
+    if (!same(s, out, ctlen)) {
+      report(b.name, dlen, ctlen);
+      return false;
+    }
+  }
+
+  gift_cofb::encrypt(key, nonce, data, dlen, txt, out, ctlen, out + ctlen);
+  if (!same(s, out, ctlen)) {
+    report("gift_cofb::encrypt", dlen, ctlen);
+    return false;
+  }
+
+  gift_cofb::encrypt_constexpr(
+    key, nonce, data, dlen, txt, out, ctlen, out + ctlen);
+  if (!same(s, out, ctlen)) {
+    report("gift_cofb::encrypt_constexpr", dlen, ctlen);
+    return false;
+  }
+
+  gift_cofb::encrypt_from<false, true>(
+    key, nonce, {}, data, dlen, txt, out, ctlen, out + ctlen);
+  if (!same(s, out, ctlen)) {
+    report("gift_cofb::encrypt_from<streamed>", dlen, ctlen);
+    return false;
+  }
+
+  std::memcpy(out, txt, ctlen);
+  gift_cofb::encrypt(key, nonce, data, dlen, out, out, ctlen, out + ctlen);
+  if (!same(s, out, ctlen)) {
+    report("gift_cofb::encrypt ( in-place )", dlen, ctlen);
+    return false;
+  }
+
+  {
+    // E_K(N) computed in transposed lanes, as precomputation queue does
+    uint8_t y[16];
+    const uint32_t key_idx = 0;
+
+    gift_modes::ecb_encrypt_keys(key, &key_idx, nonce, y, 1);
+    const auto y0 = gift_cofb_common::load_block(y);
+
+    gift_cofb::encrypt_precomputed(
+      key, y0, data, dlen, txt, out, ctlen, out + ctlen);
+    if (!same(s, out, ctlen)) {
+      report("gift_cofb::encrypt_precomputed", dlen, ctlen);
+      return false;
+    }
+  }
+
+  {
+    s.arena.reset();
+    gift_cofb_batch::make_jobs(&s.arena, 1, &s.jobs);
+    gift_cofb_batch::push(
+      &s.jobs, 0, nonce, data, dlen, txt, out, ctlen, nullptr);
+    gift_cofb_batch::encrypt(key, &s.jobs);
+
+    std::memcpy(out + ctlen, s.jobs.tags, 16);
+    if (!same(s, out, ctlen)) {
+      report("gift_cofb_batch::encrypt", dlen, ctlen);
+      return false;
+    }
+
+    s.arena.reset();
+    gift_cofb_batch::make_jobs(&s.arena, 1, &s.jobs);
+    gift_cofb_batch::push(
+      &s.jobs, 0, nonce, data, dlen, ref, s.dec.data(), ctlen, ref + ctlen);
+
+    const bool failed = gift_cofb_batch::decrypt(key, &s.jobs) != 0;
+    if (failed || std::memcmp(s.dec.data(), txt, ctlen) != 0) {
+      report("gift_cofb_batch::decrypt", dlen, ctlen);
+      return false;
+    }
+
+    // sizes which would wrap around, when rounded up or multiplied, are
+    // refused instead of handing out a short slab
+    gift_cofb_batch::jobs_t huge;
+    gift_cofb_batch::make_jobs(&s.arena, (SIZE_MAX >> 4) + 1 + ctlen, &huge);
+
+    const gift_cofb_batch::arena_t none{ SIZE_MAX - (ctlen & 63) };
+
+    const bool wraps = s.arena.alloc(SIZE_MAX - ctlen) != nullptr ||
+                       s.arena.alloc_n<uint64_t>(SIZE_MAX / 4) != nullptr ||
+                       huge.nonces != nullptr || huge.tags != nullptr ||
+                       none.cap != 0;
+    if (wraps) {
+      report("gift_cofb_batch::arena_t::alloc", dlen, ctlen);
+      return false;
+    }
+  }
+
+  {
+    // fed in uneven chunks, so that blocks straddle chunk boundaries, giving
+    // up on first failure, as context may then be garbage
+    namespace inc = gift_cofb_incremental;
+
+    const size_t step = 1 + (dlen + ctlen) % 37;
+    bool ok = true;
+
+    inc::context_t ctx;
+    inc::init(&ctx, key, nonce);
+
+    for (size_t off = 0; off < dlen; off += step) {
+      const size_t n = std::min(step, dlen - off);
+      ok = ok && inc::update_data(&ctx, data + off, n) && resume(&ctx, key);
+    }
+    for (size_t off = 0; off < ctlen; off += step) {
+      const size_t n = std::min(step, ctlen - off);
+      uint8_t* const enc = out + off;
+      ok = ok && inc::update(&ctx, txt + off, enc, n) && resume(&ctx, key);
+    }
+    ok = ok && inc::finish(&ctx, out + ctlen);
+
+    if (!ok || !same(s, out, ctlen)) {
+      report("gift_cofb_incremental::finish", dlen, ctlen);
+      return false;
+    }
+
+    inc::init(&ctx, key, nonce, true);
+    ok = ok && inc::update_data(&ctx, data, dlen);
+
+    for (size_t off = 0; off < ctlen; off += step) {
+      const size_t n = std::min(step, ctlen - off);
+      uint8_t* const dec = s.dec.data() + off;
+      ok = ok && inc::update(&ctx, ref + off, dec, n) && resume(&ctx, key);
+    }
+    ok = ok && inc::verify(&ctx, ref + ctlen);
+
+    if (!ok || std::memcmp(s.dec.data(), txt, ctlen) != 0) {
+      report("gift_cofb_incremental::verify", dlen, ctlen);
+      return false;
+    }
+  }
+
+  using gift_cofb::KEEP;
+
+  auto zeroed = [&](const uint8_t* const buf) {
+    return std::all_of(buf, buf + ctlen, [](uint8_t b) { return b == 0; });
+  };
+
+  bool ok = gift_cofb::decrypt(
+    key, nonce, ref + ctlen, data, dlen, ref, s.dec.data(), ctlen);
+  if (!ok || std::memcmp(s.dec.data(), txt, ctlen) != 0) {
+    report("gift_cofb::decrypt", dlen, ctlen);
+    return false;
+  }
+
+  ok = gift_cofb::decrypt<KEEP>(
+    key, nonce, ref + ctlen, data, dlen, ref, s.dec.data(), ctlen);
+  if (!ok || std::memcmp(s.dec.data(), txt, ctlen) != 0) {
+    report("gift_cofb::decrypt<KEEP>", dlen, ctlen);
+    return false;
+  }
+
+  std::memcpy(out, ref, ctlen + 16);
+  ok = gift_cofb::decrypt(key, nonce, out + ctlen, data, dlen, out, out, ctlen);
+  if (!ok || std::memcmp(out, txt, ctlen) != 0) {
+    report("gift_cofb::decrypt ( in-place )", dlen, ctlen);
+    return false;
+  }
+
+  std::memcpy(out, ref, ctlen + 16);
+  ok = gift_cofb::open(key, nonce, data, dlen, out, ctlen + 16, out);
+  if (!ok || std::memcmp(out, txt, ctlen) != 0) {
+    report("gift_cofb::open ( in-place )", dlen, ctlen);
+    return false;
+  }
+
+  // flipping one tag bit must fail verification, zeroing decrypted text, unless
+  // it's asked to be kept
+  ref[ctlen + (ctlen & 15)] ^= 1;
+  ok = gift_cofb::decrypt(
+    key, nonce, ref + ctlen, data, dlen, ref, s.dec.data(), ctlen);
+  if (ok || !zeroed(s.dec.data())) {
+    report("gift_cofb::decrypt ( forged tag )", dlen, ctlen);
+    return false;
+  }
+
+  ok = gift_cofb::decrypt<KEEP>(
+    key, nonce, ref + ctlen, data, dlen, ref, s.dec.data(), ctlen);
+  if (ok || std::memcmp(s.dec.data(), txt, ctlen) != 0) {
+    report("gift_cofb::decrypt<KEEP> ( forged tag )", dlen, ctlen);
+    return false;
+  }
+
+  std::memcpy(out, ref, ctlen + 16);
+  ok = gift_cofb::decrypt(key, nonce, out + ctlen, data, dlen, out, out, ctlen);
+  if (ok || !zeroed(out)) {
+    report("gift_cofb::decrypt ( in-place, forged tag )", dlen, ctlen);
+    return false;
+  }
+
+  std::memcpy(out, ref, ctlen + 16);
+  ok = gift_cofb::open(key, nonce, data, dlen, out, ctlen + 16, out);
+  if (ok || !zeroed(out)) {
+    report("gift_cofb::open ( in-place, forged tag )", dlen, ctlen);
+    return false;
+  }
+
+  return true;
+}
+
+#if defined GIFT_COFB_LIBFUZZER
+
+// Input is interpreted as 16 -bytes key || 16 -bytes nonce || 1 -byte split
+// || rest, where rest is split into associated data and plain text, at
+// split/256 of its length
+extern "C" int
+LLVMFuzzerTestOneInput(const uint8_t* const in, const size_t len)
+{
+  if (len < 33) {
+    return 0;
+  }
+
+  const size_t rest = len - 33;
+  const size_t dlen = (rest * in[32]) >> 8;
+
+  static scratch_t s(1ul << 16);
+  if (rest > (1ul << 16)) {
+    return 0;
+  }
+
+  const uint8_t* const data = in + 33;
+  if (!differential(s, in, in + 16, data, dlen, data + dlen, rest - dlen)) {
+    __builtin_trap();
+  }
+
+  return 0;
+}
+
+#else
+
+// One Known Answer Test
+struct kat_t
+{
+  size_t count;
+  std::vector<uint8_t> key, nonce, pt, ad, ct;
+};
+
+// Parses hex string into bytes
+static std::vector<uint8_t>
+from_hex(const std::string& hex)
+{
+  std::vector<uint8_t> bytes(hex.size() >> 1);
+
+  for (size_t i = 0; i < bytes.size(); i++) {
+    const unsigned long b = std::stoul(hex.substr(i << 1, 2), nullptr, 16);
+    bytes[i] = static_cast<uint8_t>(b);
+  }
+
+  return bytes;
+}
+
+// Parses KAT file of NIST LWC format, returning empty vector, if it can't be
+// read
+static std::vector<kat_t>
+parse_kats(const char* const path)
+{
+  std::vector<kat_t> kats;
+  std::ifstream file(path);
+
+  std::string line;
+  while (std::getline(file, line)) {
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+
+    const size_t sep = line.find(" = ");
+    if (sep == std::string::npos) {
+      continue;
+    }
+
+    const std::string name = line.substr(0, sep);
+    const std::string value = line.substr(sep + 3);
+
+    if (name == "Count") {
+      kats.push_back({ std::stoul(value), {}, {}, {}, {}, {} });
+    } else if (kats.empty()) {
+      continue;
+    } else if (name == "Key") {
+      kats.back().key = from_hex(value);
+    } else if (name == "Nonce") {
+      kats.back().nonce = from_hex(value);
+    } else if (name == "PT") {
+      kats.back().pt = from_hex(value);
+    } else if (name == "AD") {
+      kats.back().ad = from_hex(value);
+    } else if (name == "CT") {
+      kats.back().ct = from_hex(value);
+    }
+  }
+
+  return kats;
+}
+
+// Checks one Known Answer Test, with optimised encrypt/ decrypt routines and
+// with reference GIFT-COFB, so that reference itself is validated too
+static bool
+check_kat(const kat_t& k)
+{
+  const size_t ctlen = k.pt.size();
+
+  if (k.key.size() != 16 || k.nonce.size() != 16 ||
+      k.ct.size() != ctlen + 16) {
+    return false;
+  }
+
+  std::vector<uint8_t> out(ctlen + 16), dec(ctlen);
+
+  gift_cofb::encrypt(k.key.data(),
+                     k.nonce.data(),
+                     k.ad.data(),
+                     k.ad.size(),
+                     k.pt.data(),
+                     out.data(),
+                     ctlen,
+                     out.data() + ctlen);
+  bool ok = out == k.ct;
+
+  ref_encrypt<gift::perm_bits_ref>(k.key.data(),
+                                   k.nonce.data(),
+                                   k.ad.data(),
+                                   k.ad.size(),
+                                   k.pt.data(),
+                                   out.data(),
+                                   ctlen,
+                                   out.data() + ctlen);
+  ok &= out == k.ct;
+
+  ok &= gift_cofb::decrypt(k.key.data(),
+                           k.nonce.data(),
+                           k.ct.data() + ctlen,
+                           k.ad.data(),
+                           k.ad.size(),
+                           k.ct.data(),
+                           dec.data(),
+                           ctlen);
+  ok &= dec == k.pt;
+
+  return ok;
+}
+
+// Runs N work items on T threads, each taking every T -th item
+template<typename F>
+static void
+parallel(const size_t threads, const size_t n, F f)
+{
+  std::vector<std::thread> pool;
+
+  for (size_t t = 0; t < threads; t++) {
+    pool.emplace_back([&, t]() {
+      for (size_t i = t; i < n; i += threads) {
+        f(t, i);
+      }
+    });
+  }
+
+  for (auto& th : pool) {
+    th.join();
+  }
+}
+
+// Picks length of associated data/ plain text, mostly small ones ( around
+// block boundaries ), sometimes long enough to span multiple offset ladders
+static size_t
+pick_len(std::mt19937_64& rng)
+{
+  const uint64_t r = rng();
+
+  switch (r & 7) {
+    case 0:
+      return 0;
+    case 1:
+      return ((r >> 3) % 5) << 4;
+    case 2:
+      return (r >> 3) % 2200;
+    default:
+      return (r >> 3) % 80;
+  }
+}
+
+// Applies rounds r, r + 1 ... r + R - 1 of GIFT-128 on one block, one round
+// at a time, on dispatched PermBits backend
+static void
+ref_rounds(const gift::round_keys_t* const rk,
+           const size_t from,
+           const size_t cnt,
+           uint32_t* const words)
+{
+  gift::state_t st{};
+  std::copy_n(words, 4, st.cipher);
+
+  for (size_t r = from; r < from + cnt; r++) {
+    gift::round(&st, rk, r);
+  }
+
+  std::copy_n(st.cipher, 4, words);
+}
+
+// Picks 32 -bit mask with about one in 16 bits set
+static uint32_t
+pick_mask(std::mt19937_64& rng)
+{
+  return static_cast<uint32_t>(rng() & rng() & rng() & rng());
+}
+
+// Checks reduced-round GIFT-128 bulk evaluator ( on random round range, block
+// count and key ) and differential sweep ( on random differences, filter and
+// histogram mask ) against one block/ pair at a time computation
+static bool
+check_reduced(std::mt19937_64& rng, const size_t threads)
+{
+  namespace red = gift_reduced;
+
+  uint8_t key[16];
+  for (auto& b : key) {
+    b = static_cast<uint8_t>(rng());
+  }
+
+  gift::round_keys_t rk;
+  gift::expand_key(&rk, key);
+
+  const size_t from = rng() % (gift::ROUNDS + 1);
+  const size_t cnt = rng() % (gift::ROUNDS - from + 1);
+  const size_t n = rng() % 200;
+
+  std::vector<uint8_t> in(n << 4), out(n << 4);
+  for (auto& b : in) {
+    b = static_cast<uint8_t>(rng());
+  }
+
+  bool ok = red::evaluate(&rk, from, cnt, in.data(), out.data(), n, threads);
+
+  for (size_t i = 0; i < n; i++) {
+    gift::lanes_t<1> a, b;
+    gift_modes::load_block(&a, 0, in.data() + (i << 4));
+    gift_modes::load_block(&b, 0, out.data() + (i << 4));
+
+    uint32_t w[4];
+    for (size_t j = 0; j < 4; j++) {
+      w[j] = a.cipher[j][0];
+    }
+
+    ref_rounds(&rk, from, cnt, w);
+
+    for (size_t j = 0; j < 4; j++) {
+      ok &= w[j] == b.cipher[j][0];
+    }
+
+    // undoing same rounds gets input block back
+    gift::inverse_permute(&b, &rk, from, cnt);
+
+    for (size_t j = 0; j < 4; j++) {
+      ok &= b.cipher[j][0] == a.cipher[j][0];
+    }
+  }
+
+  // rounds past last one are refused
+  ok &= !red::evaluate(&rk, from, gift::ROUNDS + 1 - from, nullptr, nullptr, 0);
+
+  red::sweep_t sw{};
+  sw.rk = &rk;
+  sw.from = rng() % (gift::ROUNDS - 3);
+  sw.cnt = rng() % 4;
+  sw.seed = rng();
+  sw.first = rng() >> 8;
+  sw.pairs = rng() % 3000;
+
+  for (size_t j = 0; j < 4; j++) {
+    sw.din[j] = pick_mask(rng);
+    sw.filter_mask[j] = pick_mask(rng) & pick_mask(rng);
+    sw.filter[j] = static_cast<uint32_t>(rng()) & sw.filter_mask[j];
+    sw.hist_mask[j] = pick_mask(rng) & pick_mask(rng);
+  }
+
+  const size_t bins = red::bins(sw);
+  std::vector<uint64_t> hist(bins), ref(bins);
+
+  ok &= red::sweep(sw, hist.data(), threads);
+
+  // selecting more than MAX_HIST_BITS bits ( here all 128 ) is refused, with
+  // no histogram to size, instead of indexing past one
+  red::sweep_t wide = sw;
+  std::fill_n(wide.hist_mask, 4, ~0u);
+
+  ok &= red::bins(wide) == 0;
+  ok &= !red::sweep(wide, nullptr, threads);
+
+  for (uint64_t i = sw.first; i < sw.first + sw.pairs; i++) {
+    uint32_t c0[4], c1[4];
+    red::pair_input(sw.seed, i, c0);
+
+    for (size_t j = 0; j < 4; j++) {
+      c1[j] = c0[j] ^ sw.din[j];
+    }
+
+    ref_rounds(&rk, sw.from, sw.cnt, c0);
+    ref_rounds(&rk, sw.from, sw.cnt, c1);
+
+    bool keep = true;
+    size_t idx = 0;
+
+    // selected bits, one at a time, from most significant one of word 0
+    for (size_t j = 0; j < 4; j++) {
+      const uint32_t d = c0[j] ^ c1[j];
+      keep &= (d & sw.filter_mask[j]) == sw.filter[j];
+
+      for (size_t k = 32; k > 0; k--) {
+        if ((sw.hist_mask[j] >> (k - 1)) & 1) {
+          idx = (idx << 1) | ((d >> (k - 1)) & 1);
+        }
+      }
+    }
+
+    ref[idx] += keep;
+  }
+
+  return ok && hist == ref;
+}
+
+// Checks that offload daemon seals request under key which was installed when
+// it was sent, even if it's immediately followed by a key change for same key
+// slot, arriving in same write ( so that both are parsed in same round )
+static bool
+check_offload(std::mt19937_64& rng)
+{
+  namespace off = gift_cofb_offload;
+
+  char path[64];
+  std::snprintf(path, sizeof(path), "/tmp/test_gift_cofb.%d.sock", getpid());
+
+  std::atomic<bool> stop{ false };
+  off::server_stats_t stats;
+  std::thread server([&]() { off::serve(path, stop, &stats, 64); });
+
+  off::client_t cl;
+  bool connected = false;
+
+  // daemon may not be listening yet
+  for (size_t i = 0; i < 100 && !connected; i++) {
+    connected = cl.connect(path);
+    if (!connected) {
+      close(cl.fd);
+      cl.fd = -1;
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  }
+
+  uint8_t key0[16], key1[16], nonce[16], data[8], txt[64];
+  for (auto* v : { key0, key1, nonce }) {
+    for (size_t i = 0; i < 16; i++) {
+      v[i] = static_cast<uint8_t>(rng());
+    }
+  }
+  for (auto& b : data) {
+    b = static_cast<uint8_t>(rng());
+  }
+  for (auto& b : txt) {
+    b = static_cast<uint8_t>(rng());
+  }
+
+  bool ok = connected && cl.set_key(0, key0);
+
+  // SEAL || SET_KEY, written at once
+  std::vector<uint8_t> msg;
+  auto append = [&](const void* const ptr, const size_t len) {
+    const auto bytes = static_cast<const uint8_t*>(ptr);
+    msg.insert(msg.end(), bytes, bytes + len);
+  };
+
+  off::request_t seal{ off::SEAL, 0, 1, {}, sizeof(data), sizeof(txt) };
+  off::request_t set_key{ off::SET_KEY, 0, 2, {}, 0, sizeof(key1) };
+  std::memcpy(seal.nonce, nonce, sizeof(nonce));
+
+  append(&seal, sizeof(seal));
+  append(data, sizeof(data));
+  append(txt, sizeof(txt));
+  append(&set_key, sizeof(set_key));
+  append(key1, sizeof(key1));
+
+  ok = ok && off::write_all(cl.fd, msg.data(), msg.size());
+
+  uint8_t out[sizeof(txt) + 16], exp[sizeof(txt) + 16];
+  off::response_t r0{}, r1{};
+
+  ok = ok && cl.receive(&r0, out, sizeof(out));
+  ok = ok && cl.receive(&r1, nullptr, 0);
+
+  gift_cofb::seal(key0, nonce, data, sizeof(data), txt, sizeof(txt), exp);
+
+  ok = ok && r0.id == 1 && r0.status == off::OK && r0.len == sizeof(out) &&
+       std::memcmp(out, exp, sizeof(out)) == 0;
+  ok = ok && r1.id == 2 && r1.status == off::OK;
+
+  stop.store(true);
+  server.join();
+
+  return ok;
+}
+
+int
+main(int argc, char** argv)
+{
+  const char* path =
+    option(argc, argv, "--kat", "test/LWC_AEAD_KAT_128_128.txt");
+  const size_t iters = option(argc, argv, "--iters", 20000);
+  const size_t seed = option(argc, argv, "--seed", std::random_device{}());
+
+  size_t threads = option(argc, argv, "--threads", size_t(0));
+  if (threads == 0) {
+    threads = std::max<unsigned>(std::thread::hardware_concurrency(), 1);
+  }
+
+  // compile-time part of self-test is checked just by including its header
+  const bool self_ok = gift_cofb_selftest::power_on();
+  std::printf("self-test    : %s\n", self_ok ? "passed" : "FAILED");
+
+  const std::vector<kat_t> kats = parse_kats(path);
+  if (kats.empty()) {
+    std::fprintf(stderr, "FAIL: no Known Answer Tests found in %s\n", path);
+    return EXIT_FAILURE;
+  }
+
+  std::atomic<size_t> kat_fails{ 0 };
+  parallel(threads, kats.size(), [&](size_t, size_t i) {
+    if (!check_kat(kats[i])) {
+      // first few failures are enough to tell which vectors break
+      if (kat_fails.fetch_add(1, std::memory_order_relaxed) < 8) {
+        std::fprintf(stderr, "FAIL: KAT Count = %zu\n", kats[i].count);
+      }
+    }
+  });
+
+  std::printf("KAT          : %zu / %zu passed, on %zu threads\n",
+              kats.size() - kat_fails.load(),
+              kats.size(),
+              threads);
+
+  constexpr size_t max_len = 2200;
+
+  std::atomic<size_t> diff_fails{ 0 };
+  parallel(threads, threads, [&](size_t t, size_t) {
+    std::mt19937_64 rng(seed + t);
+    scratch_t s(max_len);
+
+    std::vector<uint8_t> key(16), nonce(16), data(max_len), txt(max_len);
+
+    for (size_t i = t; i < iters; i += threads) {
+      const size_t dlen = pick_len(rng);
+      const size_t ctlen = pick_len(rng);
+
+      for (auto* v : { &key, &nonce, &data, &txt }) {
+        for (auto& b : *v) {
+          b = static_cast<uint8_t>(rng());
+        }
+      }
+
+      if (!differential(s,
+                        key.data(),
+                        nonce.data(),
+                        data.data(),
+                        dlen,
+                        txt.data(),
+                        ctlen)) {
+        diff_fails.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+  });
+
+  std::printf(
+    "differential : %zu / %zu passed, against %zu backends, seed %zu\n",
+    iters - diff_fails.load(),
+    iters,
+    std::size(BACKENDS),
+    seed);
+
+  // on random thread counts, as sweep must not depend on them
+  std::mt19937_64 rng(seed);
+  bool reduced_ok = true;
+
+  for (size_t i = 0; i < 64; i++) {
+    reduced_ok &= check_reduced(rng, 1 + (rng() % (threads + 2)));
+  }
+
+  std::printf("reduced      : %s\n", reduced_ok ? "passed" : "FAILED");
+
+  const bool offload_ok = check_offload(rng);
+  std::printf("offload      : %s\n", offload_ok ? "passed" : "FAILED");
+
+  const bool ok = self_ok && reduced_ok && offload_ok &&
+                  (kat_fails.load() | diff_fails.load()) == 0;
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif
@@ -1,4 +1,5 @@
 #include "aead.hpp"
+#include "modes.hpp"
 
 // Thin C wrapper on top of underlying C++ implementation of GIFT-COFB
 // authenticated encryption, which can be used for producing shared library
@@ -28,6 +29,85 @@ extern "C"
     uint8_t* const __restrict,       // M -bytes decrypted text
     const size_t // byte length of encrypted/ decrypted text = M | >= 0
   );
+
+  void gift_cofb_seal(
+    const uint8_t* const __restrict, // 128 -bit secret key
+    const uint8_t* const __restrict, // 128 -bit nonce
+    const uint8_t* const __restrict, // N -bytes associated data
+    const size_t,          // byte length of associated data = N | >= 0
+    const uint8_t* const,  // M -bytes plain text
+    const size_t,          // byte length of plain text = M | >= 0
+    uint8_t* const         // (M + 16) -bytes encrypted text || tag
+  );
+
+  bool gift_cofb_open(
+    const uint8_t* const __restrict, // 128 -bit secret key
+    const uint8_t* const __restrict, // 128 -bit nonce
+    const uint8_t* const __restrict, // N -bytes associated data
+    const size_t,         // byte length of associated data = N | >= 0
+    const uint8_t* const, // (M + 16) -bytes encrypted text || tag
+    const size_t,         // byte length of encrypted text || tag = M + 16
+    uint8_t* const        // M -bytes decrypted text
+  );
+
+  size_t gift_cofb_seal_framed(
+    const uint8_t* const __restrict, // 128 -bit secret key
+    const uint8_t* const __restrict, // 128 -bit nonce
+    const uint8_t* const __restrict, // N -bytes associated data
+    const size_t,         // byte length of associated data = N | >= 0
+    const uint8_t* const, // M -bytes plain text
+    const size_t,         // byte length of plain text = M | >= 0
+    uint8_t* const        // (M + 20) -bytes header || encrypted text || tag
+  );
+
+  bool gift_cofb_open_framed(
+    const uint8_t* const __restrict, // 128 -bit secret key
+    const uint8_t* const __restrict, // 128 -bit nonce
+    const uint8_t* const __restrict, // N -bytes associated data
+    const size_t,         // byte length of associated data = N | >= 0
+    const uint8_t* const, // (M + 20) -bytes header || encrypted text || tag
+    const size_t,         // byte length of frame = M + 20
+    uint8_t* const,       // M -bytes decrypted text
+    size_t* const         // byte length of decrypted text = M, on success
+  );
+
+  void gift_ecb_encrypt(
+    const uint8_t* const __restrict, // 128 -bit secret key
+    const uint8_t* const __restrict, // N x 128 -bit plain text
+    uint8_t* const __restrict,       // N x 128 -bit encrypted text
+    const size_t                     // number of 128 -bit blocks = N | >= 0
+  );
+
+  void gift_ecb_decrypt(
+    const uint8_t* const __restrict, // 128 -bit secret key
+    const uint8_t* const __restrict, // N x 128 -bit encrypted text
+    uint8_t* const __restrict,       // N x 128 -bit decrypted text
+    const size_t                     // number of 128 -bit blocks = N | >= 0
+  );
+
+  void gift_cbc_encrypt(
+    const uint8_t* const __restrict, // 128 -bit secret key
+    const uint8_t* const __restrict, // 128 -bit initialization vector
+    const uint8_t* const __restrict, // N x 128 -bit plain text
+    uint8_t* const __restrict,       // N x 128 -bit encrypted text
+    const size_t                     // number of 128 -bit blocks = N | >= 0
+  );
+
+  void gift_cbc_decrypt(
+    const uint8_t* const __restrict, // 128 -bit secret key
+    const uint8_t* const __restrict, // 128 -bit initialization vector
+    const uint8_t* const __restrict, // N x 128 -bit encrypted text
+    uint8_t* const __restrict,       // N x 128 -bit decrypted text
+    const size_t                     // number of 128 -bit blocks = N | >= 0
+  );
+
+  size_t gift_cofb_stats_words();
+
+  bool gift_cofb_stats_snapshot(
+    uint64_t* const // snapshot of instrumentation data, see `instrument.hpp`
+  );
+
+  void gift_cofb_stats_reset();
 }
 
 // Function implementation
@@ -61,4 +141,119 @@ extern "C"
     using namespace gift_cofb;
     return decrypt(key, nonce, tag, data, dlen, enc, txt, ctlen);
   }
+
+  void gift_cofb_seal(
+    const uint8_t* const __restrict key,   // 128 -bit secret key
+    const uint8_t* const __restrict nonce, // 128 -bit nonce
+    const uint8_t* const __restrict data,  // N -bytes associated data
+    const size_t dlen,         // byte length of associated data = N | >= 0
+    const uint8_t* const txt,  // M -bytes plain text
+    const size_t ctlen,        // byte length of plain text = M | >= 0
+    uint8_t* const out         // (M + 16) -bytes encrypted text || tag
+  )
+  {
+    gift_cofb::seal(key, nonce, data, dlen, txt, ctlen, out);
+  }
+
+  bool gift_cofb_open(
+    const uint8_t* const __restrict key,   // 128 -bit secret key
+    const uint8_t* const __restrict nonce, // 128 -bit nonce
+    const uint8_t* const __restrict data,  // N -bytes associated data
+    const size_t dlen,        // byte length of associated data = N | >= 0
+    const uint8_t* const in,  // (M + 16) -bytes encrypted text || tag
+    const size_t inlen,       // byte length of encrypted text || tag = M + 16
+    uint8_t* const txt        // M -bytes decrypted text
+  )
+  {
+    return gift_cofb::open(key, nonce, data, dlen, in, inlen, txt);
+  }
+
+  size_t gift_cofb_seal_framed(
+    const uint8_t* const __restrict key,   // 128 -bit secret key
+    const uint8_t* const __restrict nonce, // 128 -bit nonce
+    const uint8_t* const __restrict data,  // N -bytes associated data
+    const size_t dlen,        // byte length of associated data = N | >= 0
+    const uint8_t* const txt, // M -bytes plain text
+    const size_t ctlen,       // byte length of plain text = M | >= 0
+    uint8_t* const out        // (M + 20) -bytes header || encrypted text || tag
+  )
+  {
+    using namespace gift_cofb;
+    return seal_framed(key, nonce, data, dlen, txt, ctlen, out);
+  }
+
+  bool gift_cofb_open_framed(
+    const uint8_t* const __restrict key,   // 128 -bit secret key
+    const uint8_t* const __restrict nonce, // 128 -bit nonce
+    const uint8_t* const __restrict data,  // N -bytes associated data
+    const size_t dlen,       // byte length of associated data = N | >= 0
+    const uint8_t* const in, // (M + 20) -bytes header || encrypted text || tag
+    const size_t inlen,      // byte length of frame = M + 20
+    uint8_t* const txt,      // M -bytes decrypted text
+    size_t* const ctlen      // byte length of decrypted text = M, on success
+  )
+  {
+    using namespace gift_cofb;
+    return open_framed(key, nonce, data, dlen, in, inlen, txt, ctlen);
+  }
+
+  void gift_ecb_encrypt(
+    const uint8_t* const __restrict key, // 128 -bit secret key
+    const uint8_t* const __restrict txt, // N x 128 -bit plain text
+    uint8_t* const __restrict enc,       // N x 128 -bit encrypted text
+    const size_t blk_cnt // number of 128 -bit blocks = N | >= 0
+  )
+  {
+    gift_modes::ecb_encrypt(key, txt, enc, blk_cnt);
+  }
+
+  void gift_ecb_decrypt(
+    const uint8_t* const __restrict key, // 128 -bit secret key
+    const uint8_t* const __restrict enc, // N x 128 -bit encrypted text
+    uint8_t* const __restrict txt,       // N x 128 -bit decrypted text
+    const size_t blk_cnt // number of 128 -bit blocks = N | >= 0
+  )
+  {
+    gift_modes::ecb_decrypt(key, enc, txt, blk_cnt);
+  }
+
+  void gift_cbc_encrypt(
+    const uint8_t* const __restrict key, // 128 -bit secret key
+    const uint8_t* const __restrict iv,  // 128 -bit initialization vector
+    const uint8_t* const __restrict txt, // N x 128 -bit plain text
+    uint8_t* const __restrict enc,       // N x 128 -bit encrypted text
+    const size_t blk_cnt // number of 128 -bit blocks = N | >= 0
+  )
+  {
+    gift_modes::cbc_encrypt(key, iv, txt, enc, blk_cnt);
+  }
+
+  void gift_cbc_decrypt(
+    const uint8_t* const __restrict key, // 128 -bit secret key
+    const uint8_t* const __restrict iv,  // 128 -bit initialization vector
+    const uint8_t* const __restrict enc, // N x 128 -bit encrypted text
+    uint8_t* const __restrict txt,       // N x 128 -bit decrypted text
+    const size_t blk_cnt // number of 128 -bit blocks = N | >= 0
+  )
+  {
+    gift_modes::cbc_decrypt(key, iv, enc, txt, blk_cnt);
+  }
+
+  size_t gift_cofb_stats_words()
+  {
+    return gift_cofb_instrument::STATS_WORDS;
+  }
+
+  bool gift_cofb_stats_snapshot(
+    uint64_t* const stats // snapshot of instrumentation data
+  )
+  {
+    using namespace gift_cofb_instrument;
+    return snapshot(reinterpret_cast<stats_t*>(stats));
+  }
+
+  void gift_cofb_stats_reset()
+  {
+    gift_cofb_instrument::reset();
+  }
 }
@@ -11,8 +11,8 @@
   Project: https://github.com/itzmeanjan/gift-cofb
 """
 
-from typing import Tuple
-from ctypes import c_size_t, CDLL, c_bool
+from typing import Dict, Tuple
+from ctypes import c_size_t, CDLL, c_bool, byref, POINTER
 import numpy as np
 from posixpath import exists, abspath
 
@@ -94,5 +94,239 @@ def decrypt(
     return f, dec_
 
 
+def seal(key: bytes, nonce: bytes, data: bytes, text: bytes, framed=False) -> bytes:
+    """
+    Encrypts M ( >=0 ) -bytes plain text, with GIFT-COFB AEAD, while using
+    16 -bytes secret key, 16 -bytes public message nonce & N ( >=0 ) -bytes
+    associated data, producing single buffer holding M -bytes cipher text,
+    immediately followed by 16 -bytes authentication tag; when `framed` is set,
+    it's prefixed with 4 -bytes big-endian header, holding M + 16
+    """
+    assert len(key) == 16, "GIFT-COFB takes 16 -bytes secret key !"
+    assert len(nonce) == 16, "GIFT-COFB takes 16 -bytes nonce !"
+
+    ad_len = len(data)
+    ct_len = len(text)
+
+    key_ = np.frombuffer(key, dtype=u8)
+    nonce_ = np.frombuffer(nonce, dtype=u8)
+    data_ = np.frombuffer(data, dtype=u8)
+    text_ = np.frombuffer(text, dtype=u8)
+    out = np.empty(ct_len + 16 + (4 if framed else 0), dtype=u8)
+
+    args = [uint8_tp, uint8_tp, uint8_tp, len_t, uint8_tp, len_t, uint8_tp]
+
+    if framed:
+        SO_LIB.gift_cofb_seal_framed.argtypes = args
+        SO_LIB.gift_cofb_seal_framed.restype = len_t
+
+        SO_LIB.gift_cofb_seal_framed(key_, nonce_, data_, ad_len, text_, ct_len, out)
+    else:
+        SO_LIB.gift_cofb_seal.argtypes = args
+
+        SO_LIB.gift_cofb_seal(key_, nonce_, data_, ad_len, text_, ct_len, out)
+
+    return out.tobytes()
+
+
+def open(
+    key: bytes, nonce: bytes, data: bytes, sealed: bytes, framed=False
+) -> Tuple[bool, bytes]:
+    """
+    Decrypts cipher text, with GIFT-COFB AEAD, from single buffer holding
+    M ( >=0 ) -bytes cipher text || 16 -bytes authentication tag ( prefixed with
+    4 -bytes header, when `framed` is set ), while using 16 -bytes secret key,
+    16 -bytes public message nonce & N ( >=0 ) -bytes associated data, producing
+    boolean verification flag & M -bytes plain text ( in order ); malformed input
+    fails verification, returning empty plain text
+    """
+    assert len(key) == 16, "GIFT-COFB takes 16 -bytes secret key !"
+    assert len(nonce) == 16, "GIFT-COFB takes 16 -bytes nonce !"
+
+    ad_len = len(data)
+    in_len = len(sealed)
+    ct_len = max(in_len - 16 - (4 if framed else 0), 0)
+
+    key_ = np.frombuffer(key, dtype=u8)
+    nonce_ = np.frombuffer(nonce, dtype=u8)
+    data_ = np.frombuffer(data, dtype=u8)
+    sealed_ = np.frombuffer(sealed, dtype=u8)
+    dec = np.zeros(ct_len, dtype=u8)
+
+    args = [uint8_tp, uint8_tp, uint8_tp, len_t, uint8_tp, len_t, uint8_tp]
+
+    if framed:
+        dec_len = len_t(0)
+
+        SO_LIB.gift_cofb_open_framed.argtypes = args + [POINTER(len_t)]
+        SO_LIB.gift_cofb_open_framed.restype = bool_t
+
+        f = SO_LIB.gift_cofb_open_framed(
+            key_, nonce_, data_, ad_len, sealed_, in_len, dec, byref(dec_len)
+        )
+        dec = dec[: dec_len.value]
+    else:
+        SO_LIB.gift_cofb_open.argtypes = args
+        SO_LIB.gift_cofb_open.restype = bool_t
+
+        f = SO_LIB.gift_cofb_open(key_, nonce_, data_, ad_len, sealed_, in_len, dec)
+
+    return f, dec.tobytes()
+
+
+def ecb_encrypt(key: bytes, text: bytes) -> bytes:
+    """
+    Encrypts N ( >=0 ) -many 16 -bytes plain text blocks, with GIFT-128 block
+    cipher in ECB mode, while using 16 -bytes secret key, producing N -many
+    16 -bytes cipher text blocks
+    """
+    assert len(key) == 16, "GIFT-128 takes 16 -bytes secret key !"
+    assert len(text) % 16 == 0, "GIFT-128 works on 16 -bytes blocks !"
+
+    blk_cnt = len(text) >> 4
+
+    key_ = np.frombuffer(key, dtype=u8)
+    text_ = np.frombuffer(text, dtype=u8)
+    enc = np.empty(len(text), dtype=u8)
+
+    args = [uint8_tp, uint8_tp, uint8_tp, len_t]
+    SO_LIB.gift_ecb_encrypt.argtypes = args
+
+    SO_LIB.gift_ecb_encrypt(key_, text_, enc, blk_cnt)
+
+    return enc.tobytes()
+
+
+def ecb_decrypt(key: bytes, enc: bytes) -> bytes:
+    """
+    Decrypts N ( >=0 ) -many 16 -bytes cipher text blocks, with inverse GIFT-128
+    block cipher in ECB mode, while using 16 -bytes secret key, producing N -many
+    16 -bytes plain text blocks
+    """
+    assert len(key) == 16, "GIFT-128 takes 16 -bytes secret key !"
+    assert len(enc) % 16 == 0, "GIFT-128 works on 16 -bytes blocks !"
+
+    blk_cnt = len(enc) >> 4
+
+    key_ = np.frombuffer(key, dtype=u8)
+    enc_ = np.frombuffer(enc, dtype=u8)
+    dec = np.empty(len(enc), dtype=u8)
+
+    args = [uint8_tp, uint8_tp, uint8_tp, len_t]
+    SO_LIB.gift_ecb_decrypt.argtypes = args
+
+    SO_LIB.gift_ecb_decrypt(key_, enc_, dec, blk_cnt)
+
+    return dec.tobytes()
+
+
+def cbc_encrypt(key: bytes, iv: bytes, text: bytes) -> bytes:
+    """
+    Encrypts N ( >=0 ) -many 16 -bytes plain text blocks, with GIFT-128 block
+    cipher in CBC mode, while using 16 -bytes secret key & 16 -bytes
+    initialization vector, producing N -many 16 -bytes cipher text blocks
+    """
+    assert len(key) == 16, "GIFT-128 takes 16 -bytes secret key !"
+    assert len(iv) == 16, "CBC mode takes 16 -bytes initialization vector !"
+    assert len(text) % 16 == 0, "GIFT-128 works on 16 -bytes blocks !"
+
+    blk_cnt = len(text) >> 4
+
+    key_ = np.frombuffer(key, dtype=u8)
+    iv_ = np.frombuffer(iv, dtype=u8)
+    text_ = np.frombuffer(text, dtype=u8)
+    enc = np.empty(len(text), dtype=u8)
+
+    args = [uint8_tp, uint8_tp, uint8_tp, uint8_tp, len_t]
+    SO_LIB.gift_cbc_encrypt.argtypes = args
+
+    SO_LIB.gift_cbc_encrypt(key_, iv_, text_, enc, blk_cnt)
+
+    return enc.tobytes()
+
+
+def cbc_decrypt(key: bytes, iv: bytes, enc: bytes) -> bytes:
+    """
+    Decrypts N ( >=0 ) -many 16 -bytes cipher text blocks, with inverse GIFT-128
+    block cipher in CBC mode, while using 16 -bytes secret key & 16 -bytes
+    initialization vector, producing N -many 16 -bytes plain text blocks
+    """
+    assert len(key) == 16, "GIFT-128 takes 16 -bytes secret key !"
+    assert len(iv) == 16, "CBC mode takes 16 -bytes initialization vector !"
+    assert len(enc) % 16 == 0, "GIFT-128 works on 16 -bytes blocks !"
+
+    blk_cnt = len(enc) >> 4
+
+    key_ = np.frombuffer(key, dtype=u8)
+    iv_ = np.frombuffer(iv, dtype=u8)
+    enc_ = np.frombuffer(enc, dtype=u8)
+    dec = np.empty(len(enc), dtype=u8)
+
+    args = [uint8_tp, uint8_tp, uint8_tp, uint8_tp, len_t]
+    SO_LIB.gift_cbc_decrypt.argtypes = args
+
+    SO_LIB.gift_cbc_decrypt(key_, iv_, enc_, dec, blk_cnt)
+
+    return dec.tobytes()
+
+
+# Names of counters and phases, in order, as found in `instrument.hpp`
+STATS_COUNTERS = [
+    "encrypt_calls",
+    "decrypt_calls",
+    "permute_calls",
+    "ad_bytes",
+    "msg_bytes",
+    "verify_failures",
+    "sampled_calls",
+]
+STATS_PHASES = ["init", "ad", "msg", "tail", "tag"]
+STATS_BUCKETS = 64
+
+
+def stats() -> Tuple[bool, Dict]:
+    """
+    Takes snapshot of GIFT-COFB instrumentation data, aggregated over all threads,
+    returning boolean flag denoting whether instrumentation is compiled in ( see
+    `make lib DFLAGS=-DGIFT_COFB_INSTRUMENT` ) & dictionary holding event counters,
+    per phase processed block counts, per phase sampled ticks and per phase
+    histogram of sampled ticks ( where i -th bucket counts samples taking
+    [2^(i-1), 2^i) ticks ), in order
+    """
+    SO_LIB.gift_cofb_stats_words.restype = len_t
+    words = SO_LIB.gift_cofb_stats_words()
+
+    snap = np.zeros(words, dtype=np.uint64)
+    uint64_tp = np.ctypeslib.ndpointer(dtype=np.uint64, ndim=1, flags="CONTIGUOUS")
+
+    SO_LIB.gift_cofb_stats_snapshot.argtypes = [uint64_tp]
+    SO_LIB.gift_cofb_stats_snapshot.restype = bool_t
+
+    f = SO_LIB.gift_cofb_stats_snapshot(snap)
+
+    cnt = len(STATS_COUNTERS)
+    phs = len(STATS_PHASES)
+    snap = [int(w) for w in snap]
+
+    counters = dict(zip(STATS_COUNTERS, snap[:cnt]))
+    blocks = dict(zip(STATS_PHASES, snap[cnt : cnt + phs]))
+    ticks = dict(zip(STATS_PHASES, snap[cnt + phs : cnt + 2 * phs]))
+
+    off = cnt + 2 * phs
+    hist = {
+        ph: snap[off + i * STATS_BUCKETS : off + (i + 1) * STATS_BUCKETS]
+        for i, ph in enumerate(STATS_PHASES)
+    }
+
+    return f, {"counters": counters, "blocks": blocks, "ticks": ticks, "hist": hist}
+
+
+def reset_stats():
+    """
+    Resets GIFT-COFB instrumentation data of all threads
+    """
+    SO_LIB.gift_cofb_stats_reset()
+
+
 if __name__ == "__main__":
     print("Use `gift_cofb` as library module")
@@ -141,5 +141,120 @@ def test_gift_cofb_auth_fail():
     assert bytes(CTLEN) == dec, "Unverified plain text must not be released !"
 
 
+def test_gift_cofb_seal_open():
+    """
+    Test that attached tag format ( cipher text || tag, optionally prefixed with
+    4 -bytes length header ) carries same bytes as detached cipher text and tag,
+    that it opens back to plain text and that tampered or malformed input is
+    rejected.
+    """
+    rng = Random()
+
+    for ct_len in (0, 1, 15, 16, 17, 64, 100):
+        key = rng.randbytes(16)
+        nonce = rng.randbytes(16)
+        data = rng.randbytes(rng.randint(0, 40))
+        txt = rng.randbytes(ct_len)
+
+        enc, tag = gift_cofb.encrypt(key, nonce, data, txt)
+
+        sealed = gift_cofb.seal(key, nonce, data, txt)
+        framed = gift_cofb.seal(key, nonce, data, txt, framed=True)
+
+        assert sealed == enc + tag, "Sealed buffer must be cipher text || tag !"
+        assert framed == (ct_len + 16).to_bytes(4, "big") + sealed
+
+        flg, dec = gift_cofb.open(key, nonce, data, sealed)
+        assert flg and dec == txt, "Sealed buffer must open to plain text !"
+
+        flg, dec = gift_cofb.open(key, nonce, data, framed, framed=True)
+        assert flg and dec == txt, "Frame must open to plain text !"
+
+        flg, dec = gift_cofb.open(key, nonce, data, flip_bit(sealed))
+        assert not flg and dec == bytes(ct_len), "Tampered input must fail !"
+
+        flg, _ = gift_cofb.open(key, nonce, data, framed[:-1], framed=True)
+        assert not flg, "Truncated frame must be rejected !"
+
+    flg, dec = gift_cofb.open(key, nonce, data, bytes(15))
+    assert not flg and dec == b"", "Input shorter than tag must be rejected !"
+
+
+def test_gift_ecb_cbc_round_trip():
+    """
+    Test that inverse GIFT-128 block cipher ( which decrypts LANES -many blocks
+    in parallel ) undoes forward GIFT-128, both in ECB and CBC mode, for block
+    counts which are and aren't multiple of number of lanes. Also ensures that
+    parallel forward cipher ( used in ECB mode ) agrees with sequential one
+    ( used in CBC mode ), when IV is zeroed.
+    """
+    rng = Random()
+
+    for blk_cnt in range(0, 34):
+        key = rng.randbytes(16)
+        iv = rng.randbytes(16)
+        txt = rng.randbytes(blk_cnt << 4)
+
+        enc = gift_cofb.ecb_encrypt(key, txt)
+        dec = gift_cofb.ecb_decrypt(key, enc)
+
+        assert txt == dec, "GIFT-128 ECB decryption must undo encryption !"
+
+        enc = gift_cofb.cbc_encrypt(key, iv, txt)
+        dec = gift_cofb.cbc_decrypt(key, iv, enc)
+
+        assert txt == dec, "GIFT-128 CBC decryption must undo encryption !"
+
+        for i in range(blk_cnt):
+            blk = txt[i << 4 : (i + 1) << 4]
+
+            ecb_enc = gift_cofb.ecb_encrypt(key, blk)
+            cbc_enc = gift_cofb.cbc_encrypt(key, bytes(16), blk)
+
+            assert ecb_enc == cbc_enc, "GIFT-128 ECB/ CBC encryption must agree !"
+
+
+def test_gift_cofb_stats():
+    """
+    Test that GIFT-COFB instrumentation counts permutation calls, processed blocks
+    of each phase, processed bytes and verification failures, when it's compiled
+    in; otherwise snapshot must be all zeroed.
+    """
+    rng = Random()
+
+    DLEN = 32
+    CTLEN = 72
+
+    key = rng.randbytes(16)
+    nonce = rng.randbytes(16)
+    data = rng.randbytes(DLEN)
+    txt = rng.randbytes(CTLEN)
+
+    gift_cofb.reset_stats()
+
+    enc, tag = gift_cofb.encrypt(key, nonce, data, txt)
+    flg, _ = gift_cofb.decrypt(key, nonce, tag, data, flip_bit(enc))
+
+    assert not flg, "GIFT-COFB authentication must fail !"
+
+    enabled, snap = gift_cofb.stats()
+
+    if not enabled:
+        assert not any(snap["counters"].values()), "Counters must be zeroed !"
+        assert not any(snap["blocks"].values()), "Block counts must be zeroed !"
+        return
+
+    assert snap["counters"]["encrypt_calls"] == 1
+    assert snap["counters"]["decrypt_calls"] == 1
+    assert snap["counters"]["permute_calls"] == 2 * (1 + 2 + 4 + 1)
+    assert snap["counters"]["ad_bytes"] == 2 * DLEN
+    assert snap["counters"]["msg_bytes"] == 2 * CTLEN
+    assert snap["counters"]["verify_failures"] == 1
+    assert snap["blocks"] == {"init": 2, "ad": 4, "msg": 8, "tail": 2, "tag": 0}
+
+    sampled = snap["counters"]["sampled_calls"]
+    assert all(sum(h) == sampled for h in snap["hist"].values())
+
+
 if __name__ == "__main__":
     print("Execute test cases using `pytest`")